@@ -0,0 +1,2138 @@
+/*
+ * The named character references of HTML5, sorted by name for bsearch, with
+ * the code points each one stands for. The legacy ones are also read
+ * without their ';'.
+ */
+typedef struct {
+  const gchar *name;
+  gunichar    codepoints[2];  // the second one 0 unless there are two
+  gboolean    legacy;
+} CharacterReference;
+
+static const CharacterReference character_references[] = {
+  { "AElig", { 0xC6, 0 }, TRUE },
+  { "AMP", { 0x26, 0 }, TRUE },
+  { "Aacute", { 0xC1, 0 }, TRUE },
+  { "Abreve", { 0x102, 0 }, FALSE },
+  { "Acirc", { 0xC2, 0 }, TRUE },
+  { "Acy", { 0x410, 0 }, FALSE },
+  { "Afr", { 0x1D504, 0 }, FALSE },
+  { "Agrave", { 0xC0, 0 }, TRUE },
+  { "Alpha", { 0x391, 0 }, FALSE },
+  { "Amacr", { 0x100, 0 }, FALSE },
+  { "And", { 0x2A53, 0 }, FALSE },
+  { "Aogon", { 0x104, 0 }, FALSE },
+  { "Aopf", { 0x1D538, 0 }, FALSE },
+  { "ApplyFunction", { 0x2061, 0 }, FALSE },
+  { "Aring", { 0xC5, 0 }, TRUE },
+  { "Ascr", { 0x1D49C, 0 }, FALSE },
+  { "Assign", { 0x2254, 0 }, FALSE },
+  { "Atilde", { 0xC3, 0 }, TRUE },
+  { "Auml", { 0xC4, 0 }, TRUE },
+  { "Backslash", { 0x2216, 0 }, FALSE },
+  { "Barv", { 0x2AE7, 0 }, FALSE },
+  { "Barwed", { 0x2306, 0 }, FALSE },
+  { "Bcy", { 0x411, 0 }, FALSE },
+  { "Because", { 0x2235, 0 }, FALSE },
+  { "Bernoullis", { 0x212C, 0 }, FALSE },
+  { "Beta", { 0x392, 0 }, FALSE },
+  { "Bfr", { 0x1D505, 0 }, FALSE },
+  { "Bopf", { 0x1D539, 0 }, FALSE },
+  { "Breve", { 0x2D8, 0 }, FALSE },
+  { "Bscr", { 0x212C, 0 }, FALSE },
+  { "Bumpeq", { 0x224E, 0 }, FALSE },
+  { "CHcy", { 0x427, 0 }, FALSE },
+  { "COPY", { 0xA9, 0 }, TRUE },
+  { "Cacute", { 0x106, 0 }, FALSE },
+  { "Cap", { 0x22D2, 0 }, FALSE },
+  { "CapitalDifferentialD", { 0x2145, 0 }, FALSE },
+  { "Cayleys", { 0x212D, 0 }, FALSE },
+  { "Ccaron", { 0x10C, 0 }, FALSE },
+  { "Ccedil", { 0xC7, 0 }, TRUE },
+  { "Ccirc", { 0x108, 0 }, FALSE },
+  { "Cconint", { 0x2230, 0 }, FALSE },
+  { "Cdot", { 0x10A, 0 }, FALSE },
+  { "Cedilla", { 0xB8, 0 }, FALSE },
+  { "CenterDot", { 0xB7, 0 }, FALSE },
+  { "Cfr", { 0x212D, 0 }, FALSE },
+  { "Chi", { 0x3A7, 0 }, FALSE },
+  { "CircleDot", { 0x2299, 0 }, FALSE },
+  { "CircleMinus", { 0x2296, 0 }, FALSE },
+  { "CirclePlus", { 0x2295, 0 }, FALSE },
+  { "CircleTimes", { 0x2297, 0 }, FALSE },
+  { "ClockwiseContourIntegral", { 0x2232, 0 }, FALSE },
+  { "CloseCurlyDoubleQuote", { 0x201D, 0 }, FALSE },
+  { "CloseCurlyQuote", { 0x2019, 0 }, FALSE },
+  { "Colon", { 0x2237, 0 }, FALSE },
+  { "Colone", { 0x2A74, 0 }, FALSE },
+  { "Congruent", { 0x2261, 0 }, FALSE },
+  { "Conint", { 0x222F, 0 }, FALSE },
+  { "ContourIntegral", { 0x222E, 0 }, FALSE },
+  { "Copf", { 0x2102, 0 }, FALSE },
+  { "Coproduct", { 0x2210, 0 }, FALSE },
+  { "CounterClockwiseContourIntegral", { 0x2233, 0 }, FALSE },
+  { "Cross", { 0x2A2F, 0 }, FALSE },
+  { "Cscr", { 0x1D49E, 0 }, FALSE },
+  { "Cup", { 0x22D3, 0 }, FALSE },
+  { "CupCap", { 0x224D, 0 }, FALSE },
+  { "DD", { 0x2145, 0 }, FALSE },
+  { "DDotrahd", { 0x2911, 0 }, FALSE },
+  { "DJcy", { 0x402, 0 }, FALSE },
+  { "DScy", { 0x405, 0 }, FALSE },
+  { "DZcy", { 0x40F, 0 }, FALSE },
+  { "Dagger", { 0x2021, 0 }, FALSE },
+  { "Darr", { 0x21A1, 0 }, FALSE },
+  { "Dashv", { 0x2AE4, 0 }, FALSE },
+  { "Dcaron", { 0x10E, 0 }, FALSE },
+  { "Dcy", { 0x414, 0 }, FALSE },
+  { "Del", { 0x2207, 0 }, FALSE },
+  { "Delta", { 0x394, 0 }, FALSE },
+  { "Dfr", { 0x1D507, 0 }, FALSE },
+  { "DiacriticalAcute", { 0xB4, 0 }, FALSE },
+  { "DiacriticalDot", { 0x2D9, 0 }, FALSE },
+  { "DiacriticalDoubleAcute", { 0x2DD, 0 }, FALSE },
+  { "DiacriticalGrave", { 0x60, 0 }, FALSE },
+  { "DiacriticalTilde", { 0x2DC, 0 }, FALSE },
+  { "Diamond", { 0x22C4, 0 }, FALSE },
+  { "DifferentialD", { 0x2146, 0 }, FALSE },
+  { "Dopf", { 0x1D53B, 0 }, FALSE },
+  { "Dot", { 0xA8, 0 }, FALSE },
+  { "DotDot", { 0x20DC, 0 }, FALSE },
+  { "DotEqual", { 0x2250, 0 }, FALSE },
+  { "DoubleContourIntegral", { 0x222F, 0 }, FALSE },
+  { "DoubleDot", { 0xA8, 0 }, FALSE },
+  { "DoubleDownArrow", { 0x21D3, 0 }, FALSE },
+  { "DoubleLeftArrow", { 0x21D0, 0 }, FALSE },
+  { "DoubleLeftRightArrow", { 0x21D4, 0 }, FALSE },
+  { "DoubleLeftTee", { 0x2AE4, 0 }, FALSE },
+  { "DoubleLongLeftArrow", { 0x27F8, 0 }, FALSE },
+  { "DoubleLongLeftRightArrow", { 0x27FA, 0 }, FALSE },
+  { "DoubleLongRightArrow", { 0x27F9, 0 }, FALSE },
+  { "DoubleRightArrow", { 0x21D2, 0 }, FALSE },
+  { "DoubleRightTee", { 0x22A8, 0 }, FALSE },
+  { "DoubleUpArrow", { 0x21D1, 0 }, FALSE },
+  { "DoubleUpDownArrow", { 0x21D5, 0 }, FALSE },
+  { "DoubleVerticalBar", { 0x2225, 0 }, FALSE },
+  { "DownArrow", { 0x2193, 0 }, FALSE },
+  { "DownArrowBar", { 0x2913, 0 }, FALSE },
+  { "DownArrowUpArrow", { 0x21F5, 0 }, FALSE },
+  { "DownBreve", { 0x311, 0 }, FALSE },
+  { "DownLeftRightVector", { 0x2950, 0 }, FALSE },
+  { "DownLeftTeeVector", { 0x295E, 0 }, FALSE },
+  { "DownLeftVector", { 0x21BD, 0 }, FALSE },
+  { "DownLeftVectorBar", { 0x2956, 0 }, FALSE },
+  { "DownRightTeeVector", { 0x295F, 0 }, FALSE },
+  { "DownRightVector", { 0x21C1, 0 }, FALSE },
+  { "DownRightVectorBar", { 0x2957, 0 }, FALSE },
+  { "DownTee", { 0x22A4, 0 }, FALSE },
+  { "DownTeeArrow", { 0x21A7, 0 }, FALSE },
+  { "Downarrow", { 0x21D3, 0 }, FALSE },
+  { "Dscr", { 0x1D49F, 0 }, FALSE },
+  { "Dstrok", { 0x110, 0 }, FALSE },
+  { "ENG", { 0x14A, 0 }, FALSE },
+  { "ETH", { 0xD0, 0 }, TRUE },
+  { "Eacute", { 0xC9, 0 }, TRUE },
+  { "Ecaron", { 0x11A, 0 }, FALSE },
+  { "Ecirc", { 0xCA, 0 }, TRUE },
+  { "Ecy", { 0x42D, 0 }, FALSE },
+  { "Edot", { 0x116, 0 }, FALSE },
+  { "Efr", { 0x1D508, 0 }, FALSE },
+  { "Egrave", { 0xC8, 0 }, TRUE },
+  { "Element", { 0x2208, 0 }, FALSE },
+  { "Emacr", { 0x112, 0 }, FALSE },
+  { "EmptySmallSquare", { 0x25FB, 0 }, FALSE },
+  { "EmptyVerySmallSquare", { 0x25AB, 0 }, FALSE },
+  { "Eogon", { 0x118, 0 }, FALSE },
+  { "Eopf", { 0x1D53C, 0 }, FALSE },
+  { "Epsilon", { 0x395, 0 }, FALSE },
+  { "Equal", { 0x2A75, 0 }, FALSE },
+  { "EqualTilde", { 0x2242, 0 }, FALSE },
+  { "Equilibrium", { 0x21CC, 0 }, FALSE },
+  { "Escr", { 0x2130, 0 }, FALSE },
+  { "Esim", { 0x2A73, 0 }, FALSE },
+  { "Eta", { 0x397, 0 }, FALSE },
+  { "Euml", { 0xCB, 0 }, TRUE },
+  { "Exists", { 0x2203, 0 }, FALSE },
+  { "ExponentialE", { 0x2147, 0 }, FALSE },
+  { "Fcy", { 0x424, 0 }, FALSE },
+  { "Ffr", { 0x1D509, 0 }, FALSE },
+  { "FilledSmallSquare", { 0x25FC, 0 }, FALSE },
+  { "FilledVerySmallSquare", { 0x25AA, 0 }, FALSE },
+  { "Fopf", { 0x1D53D, 0 }, FALSE },
+  { "ForAll", { 0x2200, 0 }, FALSE },
+  { "Fouriertrf", { 0x2131, 0 }, FALSE },
+  { "Fscr", { 0x2131, 0 }, FALSE },
+  { "GJcy", { 0x403, 0 }, FALSE },
+  { "GT", { 0x3E, 0 }, TRUE },
+  { "Gamma", { 0x393, 0 }, FALSE },
+  { "Gammad", { 0x3DC, 0 }, FALSE },
+  { "Gbreve", { 0x11E, 0 }, FALSE },
+  { "Gcedil", { 0x122, 0 }, FALSE },
+  { "Gcirc", { 0x11C, 0 }, FALSE },
+  { "Gcy", { 0x413, 0 }, FALSE },
+  { "Gdot", { 0x120, 0 }, FALSE },
+  { "Gfr", { 0x1D50A, 0 }, FALSE },
+  { "Gg", { 0x22D9, 0 }, FALSE },
+  { "Gopf", { 0x1D53E, 0 }, FALSE },
+  { "GreaterEqual", { 0x2265, 0 }, FALSE },
+  { "GreaterEqualLess", { 0x22DB, 0 }, FALSE },
+  { "GreaterFullEqual", { 0x2267, 0 }, FALSE },
+  { "GreaterGreater", { 0x2AA2, 0 }, FALSE },
+  { "GreaterLess", { 0x2277, 0 }, FALSE },
+  { "GreaterSlantEqual", { 0x2A7E, 0 }, FALSE },
+  { "GreaterTilde", { 0x2273, 0 }, FALSE },
+  { "Gscr", { 0x1D4A2, 0 }, FALSE },
+  { "Gt", { 0x226B, 0 }, FALSE },
+  { "HARDcy", { 0x42A, 0 }, FALSE },
+  { "Hacek", { 0x2C7, 0 }, FALSE },
+  { "Hat", { 0x5E, 0 }, FALSE },
+  { "Hcirc", { 0x124, 0 }, FALSE },
+  { "Hfr", { 0x210C, 0 }, FALSE },
+  { "HilbertSpace", { 0x210B, 0 }, FALSE },
+  { "Hopf", { 0x210D, 0 }, FALSE },
+  { "HorizontalLine", { 0x2500, 0 }, FALSE },
+  { "Hscr", { 0x210B, 0 }, FALSE },
+  { "Hstrok", { 0x126, 0 }, FALSE },
+  { "HumpDownHump", { 0x224E, 0 }, FALSE },
+  { "HumpEqual", { 0x224F, 0 }, FALSE },
+  { "IEcy", { 0x415, 0 }, FALSE },
+  { "IJlig", { 0x132, 0 }, FALSE },
+  { "IOcy", { 0x401, 0 }, FALSE },
+  { "Iacute", { 0xCD, 0 }, TRUE },
+  { "Icirc", { 0xCE, 0 }, TRUE },
+  { "Icy", { 0x418, 0 }, FALSE },
+  { "Idot", { 0x130, 0 }, FALSE },
+  { "Ifr", { 0x2111, 0 }, FALSE },
+  { "Igrave", { 0xCC, 0 }, TRUE },
+  { "Im", { 0x2111, 0 }, FALSE },
+  { "Imacr", { 0x12A, 0 }, FALSE },
+  { "ImaginaryI", { 0x2148, 0 }, FALSE },
+  { "Implies", { 0x21D2, 0 }, FALSE },
+  { "Int", { 0x222C, 0 }, FALSE },
+  { "Integral", { 0x222B, 0 }, FALSE },
+  { "Intersection", { 0x22C2, 0 }, FALSE },
+  { "InvisibleComma", { 0x2063, 0 }, FALSE },
+  { "InvisibleTimes", { 0x2062, 0 }, FALSE },
+  { "Iogon", { 0x12E, 0 }, FALSE },
+  { "Iopf", { 0x1D540, 0 }, FALSE },
+  { "Iota", { 0x399, 0 }, FALSE },
+  { "Iscr", { 0x2110, 0 }, FALSE },
+  { "Itilde", { 0x128, 0 }, FALSE },
+  { "Iukcy", { 0x406, 0 }, FALSE },
+  { "Iuml", { 0xCF, 0 }, TRUE },
+  { "Jcirc", { 0x134, 0 }, FALSE },
+  { "Jcy", { 0x419, 0 }, FALSE },
+  { "Jfr", { 0x1D50D, 0 }, FALSE },
+  { "Jopf", { 0x1D541, 0 }, FALSE },
+  { "Jscr", { 0x1D4A5, 0 }, FALSE },
+  { "Jsercy", { 0x408, 0 }, FALSE },
+  { "Jukcy", { 0x404, 0 }, FALSE },
+  { "KHcy", { 0x425, 0 }, FALSE },
+  { "KJcy", { 0x40C, 0 }, FALSE },
+  { "Kappa", { 0x39A, 0 }, FALSE },
+  { "Kcedil", { 0x136, 0 }, FALSE },
+  { "Kcy", { 0x41A, 0 }, FALSE },
+  { "Kfr", { 0x1D50E, 0 }, FALSE },
+  { "Kopf", { 0x1D542, 0 }, FALSE },
+  { "Kscr", { 0x1D4A6, 0 }, FALSE },
+  { "LJcy", { 0x409, 0 }, FALSE },
+  { "LT", { 0x3C, 0 }, TRUE },
+  { "Lacute", { 0x139, 0 }, FALSE },
+  { "Lambda", { 0x39B, 0 }, FALSE },
+  { "Lang", { 0x27EA, 0 }, FALSE },
+  { "Laplacetrf", { 0x2112, 0 }, FALSE },
+  { "Larr", { 0x219E, 0 }, FALSE },
+  { "Lcaron", { 0x13D, 0 }, FALSE },
+  { "Lcedil", { 0x13B, 0 }, FALSE },
+  { "Lcy", { 0x41B, 0 }, FALSE },
+  { "LeftAngleBracket", { 0x27E8, 0 }, FALSE },
+  { "LeftArrow", { 0x2190, 0 }, FALSE },
+  { "LeftArrowBar", { 0x21E4, 0 }, FALSE },
+  { "LeftArrowRightArrow", { 0x21C6, 0 }, FALSE },
+  { "LeftCeiling", { 0x2308, 0 }, FALSE },
+  { "LeftDoubleBracket", { 0x27E6, 0 }, FALSE },
+  { "LeftDownTeeVector", { 0x2961, 0 }, FALSE },
+  { "LeftDownVector", { 0x21C3, 0 }, FALSE },
+  { "LeftDownVectorBar", { 0x2959, 0 }, FALSE },
+  { "LeftFloor", { 0x230A, 0 }, FALSE },
+  { "LeftRightArrow", { 0x2194, 0 }, FALSE },
+  { "LeftRightVector", { 0x294E, 0 }, FALSE },
+  { "LeftTee", { 0x22A3, 0 }, FALSE },
+  { "LeftTeeArrow", { 0x21A4, 0 }, FALSE },
+  { "LeftTeeVector", { 0x295A, 0 }, FALSE },
+  { "LeftTriangle", { 0x22B2, 0 }, FALSE },
+  { "LeftTriangleBar", { 0x29CF, 0 }, FALSE },
+  { "LeftTriangleEqual", { 0x22B4, 0 }, FALSE },
+  { "LeftUpDownVector", { 0x2951, 0 }, FALSE },
+  { "LeftUpTeeVector", { 0x2960, 0 }, FALSE },
+  { "LeftUpVector", { 0x21BF, 0 }, FALSE },
+  { "LeftUpVectorBar", { 0x2958, 0 }, FALSE },
+  { "LeftVector", { 0x21BC, 0 }, FALSE },
+  { "LeftVectorBar", { 0x2952, 0 }, FALSE },
+  { "Leftarrow", { 0x21D0, 0 }, FALSE },
+  { "Leftrightarrow", { 0x21D4, 0 }, FALSE },
+  { "LessEqualGreater", { 0x22DA, 0 }, FALSE },
+  { "LessFullEqual", { 0x2266, 0 }, FALSE },
+  { "LessGreater", { 0x2276, 0 }, FALSE },
+  { "LessLess", { 0x2AA1, 0 }, FALSE },
+  { "LessSlantEqual", { 0x2A7D, 0 }, FALSE },
+  { "LessTilde", { 0x2272, 0 }, FALSE },
+  { "Lfr", { 0x1D50F, 0 }, FALSE },
+  { "Ll", { 0x22D8, 0 }, FALSE },
+  { "Lleftarrow", { 0x21DA, 0 }, FALSE },
+  { "Lmidot", { 0x13F, 0 }, FALSE },
+  { "LongLeftArrow", { 0x27F5, 0 }, FALSE },
+  { "LongLeftRightArrow", { 0x27F7, 0 }, FALSE },
+  { "LongRightArrow", { 0x27F6, 0 }, FALSE },
+  { "Longleftarrow", { 0x27F8, 0 }, FALSE },
+  { "Longleftrightarrow", { 0x27FA, 0 }, FALSE },
+  { "Longrightarrow", { 0x27F9, 0 }, FALSE },
+  { "Lopf", { 0x1D543, 0 }, FALSE },
+  { "LowerLeftArrow", { 0x2199, 0 }, FALSE },
+  { "LowerRightArrow", { 0x2198, 0 }, FALSE },
+  { "Lscr", { 0x2112, 0 }, FALSE },
+  { "Lsh", { 0x21B0, 0 }, FALSE },
+  { "Lstrok", { 0x141, 0 }, FALSE },
+  { "Lt", { 0x226A, 0 }, FALSE },
+  { "Map", { 0x2905, 0 }, FALSE },
+  { "Mcy", { 0x41C, 0 }, FALSE },
+  { "MediumSpace", { 0x205F, 0 }, FALSE },
+  { "Mellintrf", { 0x2133, 0 }, FALSE },
+  { "Mfr", { 0x1D510, 0 }, FALSE },
+  { "MinusPlus", { 0x2213, 0 }, FALSE },
+  { "Mopf", { 0x1D544, 0 }, FALSE },
+  { "Mscr", { 0x2133, 0 }, FALSE },
+  { "Mu", { 0x39C, 0 }, FALSE },
+  { "NJcy", { 0x40A, 0 }, FALSE },
+  { "Nacute", { 0x143, 0 }, FALSE },
+  { "Ncaron", { 0x147, 0 }, FALSE },
+  { "Ncedil", { 0x145, 0 }, FALSE },
+  { "Ncy", { 0x41D, 0 }, FALSE },
+  { "NegativeMediumSpace", { 0x200B, 0 }, FALSE },
+  { "NegativeThickSpace", { 0x200B, 0 }, FALSE },
+  { "NegativeThinSpace", { 0x200B, 0 }, FALSE },
+  { "NegativeVeryThinSpace", { 0x200B, 0 }, FALSE },
+  { "NestedGreaterGreater", { 0x226B, 0 }, FALSE },
+  { "NestedLessLess", { 0x226A, 0 }, FALSE },
+  { "NewLine", { 0xA, 0 }, FALSE },
+  { "Nfr", { 0x1D511, 0 }, FALSE },
+  { "NoBreak", { 0x2060, 0 }, FALSE },
+  { "NonBreakingSpace", { 0xA0, 0 }, FALSE },
+  { "Nopf", { 0x2115, 0 }, FALSE },
+  { "Not", { 0x2AEC, 0 }, FALSE },
+  { "NotCongruent", { 0x2262, 0 }, FALSE },
+  { "NotCupCap", { 0x226D, 0 }, FALSE },
+  { "NotDoubleVerticalBar", { 0x2226, 0 }, FALSE },
+  { "NotElement", { 0x2209, 0 }, FALSE },
+  { "NotEqual", { 0x2260, 0 }, FALSE },
+  { "NotEqualTilde", { 0x2242, 0x338 }, FALSE },
+  { "NotExists", { 0x2204, 0 }, FALSE },
+  { "NotGreater", { 0x226F, 0 }, FALSE },
+  { "NotGreaterEqual", { 0x2271, 0 }, FALSE },
+  { "NotGreaterFullEqual", { 0x2267, 0x338 }, FALSE },
+  { "NotGreaterGreater", { 0x226B, 0x338 }, FALSE },
+  { "NotGreaterLess", { 0x2279, 0 }, FALSE },
+  { "NotGreaterSlantEqual", { 0x2A7E, 0x338 }, FALSE },
+  { "NotGreaterTilde", { 0x2275, 0 }, FALSE },
+  { "NotHumpDownHump", { 0x224E, 0x338 }, FALSE },
+  { "NotHumpEqual", { 0x224F, 0x338 }, FALSE },
+  { "NotLeftTriangle", { 0x22EA, 0 }, FALSE },
+  { "NotLeftTriangleBar", { 0x29CF, 0x338 }, FALSE },
+  { "NotLeftTriangleEqual", { 0x22EC, 0 }, FALSE },
+  { "NotLess", { 0x226E, 0 }, FALSE },
+  { "NotLessEqual", { 0x2270, 0 }, FALSE },
+  { "NotLessGreater", { 0x2278, 0 }, FALSE },
+  { "NotLessLess", { 0x226A, 0x338 }, FALSE },
+  { "NotLessSlantEqual", { 0x2A7D, 0x338 }, FALSE },
+  { "NotLessTilde", { 0x2274, 0 }, FALSE },
+  { "NotNestedGreaterGreater", { 0x2AA2, 0x338 }, FALSE },
+  { "NotNestedLessLess", { 0x2AA1, 0x338 }, FALSE },
+  { "NotPrecedes", { 0x2280, 0 }, FALSE },
+  { "NotPrecedesEqual", { 0x2AAF, 0x338 }, FALSE },
+  { "NotPrecedesSlantEqual", { 0x22E0, 0 }, FALSE },
+  { "NotReverseElement", { 0x220C, 0 }, FALSE },
+  { "NotRightTriangle", { 0x22EB, 0 }, FALSE },
+  { "NotRightTriangleBar", { 0x29D0, 0x338 }, FALSE },
+  { "NotRightTriangleEqual", { 0x22ED, 0 }, FALSE },
+  { "NotSquareSubset", { 0x228F, 0x338 }, FALSE },
+  { "NotSquareSubsetEqual", { 0x22E2, 0 }, FALSE },
+  { "NotSquareSuperset", { 0x2290, 0x338 }, FALSE },
+  { "NotSquareSupersetEqual", { 0x22E3, 0 }, FALSE },
+  { "NotSubset", { 0x2282, 0x20D2 }, FALSE },
+  { "NotSubsetEqual", { 0x2288, 0 }, FALSE },
+  { "NotSucceeds", { 0x2281, 0 }, FALSE },
+  { "NotSucceedsEqual", { 0x2AB0, 0x338 }, FALSE },
+  { "NotSucceedsSlantEqual", { 0x22E1, 0 }, FALSE },
+  { "NotSucceedsTilde", { 0x227F, 0x338 }, FALSE },
+  { "NotSuperset", { 0x2283, 0x20D2 }, FALSE },
+  { "NotSupersetEqual", { 0x2289, 0 }, FALSE },
+  { "NotTilde", { 0x2241, 0 }, FALSE },
+  { "NotTildeEqual", { 0x2244, 0 }, FALSE },
+  { "NotTildeFullEqual", { 0x2247, 0 }, FALSE },
+  { "NotTildeTilde", { 0x2249, 0 }, FALSE },
+  { "NotVerticalBar", { 0x2224, 0 }, FALSE },
+  { "Nscr", { 0x1D4A9, 0 }, FALSE },
+  { "Ntilde", { 0xD1, 0 }, TRUE },
+  { "Nu", { 0x39D, 0 }, FALSE },
+  { "OElig", { 0x152, 0 }, FALSE },
+  { "Oacute", { 0xD3, 0 }, TRUE },
+  { "Ocirc", { 0xD4, 0 }, TRUE },
+  { "Ocy", { 0x41E, 0 }, FALSE },
+  { "Odblac", { 0x150, 0 }, FALSE },
+  { "Ofr", { 0x1D512, 0 }, FALSE },
+  { "Ograve", { 0xD2, 0 }, TRUE },
+  { "Omacr", { 0x14C, 0 }, FALSE },
+  { "Omega", { 0x3A9, 0 }, FALSE },
+  { "Omicron", { 0x39F, 0 }, FALSE },
+  { "Oopf", { 0x1D546, 0 }, FALSE },
+  { "OpenCurlyDoubleQuote", { 0x201C, 0 }, FALSE },
+  { "OpenCurlyQuote", { 0x2018, 0 }, FALSE },
+  { "Or", { 0x2A54, 0 }, FALSE },
+  { "Oscr", { 0x1D4AA, 0 }, FALSE },
+  { "Oslash", { 0xD8, 0 }, TRUE },
+  { "Otilde", { 0xD5, 0 }, TRUE },
+  { "Otimes", { 0x2A37, 0 }, FALSE },
+  { "Ouml", { 0xD6, 0 }, TRUE },
+  { "OverBar", { 0x203E, 0 }, FALSE },
+  { "OverBrace", { 0x23DE, 0 }, FALSE },
+  { "OverBracket", { 0x23B4, 0 }, FALSE },
+  { "OverParenthesis", { 0x23DC, 0 }, FALSE },
+  { "PartialD", { 0x2202, 0 }, FALSE },
+  { "Pcy", { 0x41F, 0 }, FALSE },
+  { "Pfr", { 0x1D513, 0 }, FALSE },
+  { "Phi", { 0x3A6, 0 }, FALSE },
+  { "Pi", { 0x3A0, 0 }, FALSE },
+  { "PlusMinus", { 0xB1, 0 }, FALSE },
+  { "Poincareplane", { 0x210C, 0 }, FALSE },
+  { "Popf", { 0x2119, 0 }, FALSE },
+  { "Pr", { 0x2ABB, 0 }, FALSE },
+  { "Precedes", { 0x227A, 0 }, FALSE },
+  { "PrecedesEqual", { 0x2AAF, 0 }, FALSE },
+  { "PrecedesSlantEqual", { 0x227C, 0 }, FALSE },
+  { "PrecedesTilde", { 0x227E, 0 }, FALSE },
+  { "Prime", { 0x2033, 0 }, FALSE },
+  { "Product", { 0x220F, 0 }, FALSE },
+  { "Proportion", { 0x2237, 0 }, FALSE },
+  { "Proportional", { 0x221D, 0 }, FALSE },
+  { "Pscr", { 0x1D4AB, 0 }, FALSE },
+  { "Psi", { 0x3A8, 0 }, FALSE },
+  { "QUOT", { 0x22, 0 }, TRUE },
+  { "Qfr", { 0x1D514, 0 }, FALSE },
+  { "Qopf", { 0x211A, 0 }, FALSE },
+  { "Qscr", { 0x1D4AC, 0 }, FALSE },
+  { "RBarr", { 0x2910, 0 }, FALSE },
+  { "REG", { 0xAE, 0 }, TRUE },
+  { "Racute", { 0x154, 0 }, FALSE },
+  { "Rang", { 0x27EB, 0 }, FALSE },
+  { "Rarr", { 0x21A0, 0 }, FALSE },
+  { "Rarrtl", { 0x2916, 0 }, FALSE },
+  { "Rcaron", { 0x158, 0 }, FALSE },
+  { "Rcedil", { 0x156, 0 }, FALSE },
+  { "Rcy", { 0x420, 0 }, FALSE },
+  { "Re", { 0x211C, 0 }, FALSE },
+  { "ReverseElement", { 0x220B, 0 }, FALSE },
+  { "ReverseEquilibrium", { 0x21CB, 0 }, FALSE },
+  { "ReverseUpEquilibrium", { 0x296F, 0 }, FALSE },
+  { "Rfr", { 0x211C, 0 }, FALSE },
+  { "Rho", { 0x3A1, 0 }, FALSE },
+  { "RightAngleBracket", { 0x27E9, 0 }, FALSE },
+  { "RightArrow", { 0x2192, 0 }, FALSE },
+  { "RightArrowBar", { 0x21E5, 0 }, FALSE },
+  { "RightArrowLeftArrow", { 0x21C4, 0 }, FALSE },
+  { "RightCeiling", { 0x2309, 0 }, FALSE },
+  { "RightDoubleBracket", { 0x27E7, 0 }, FALSE },
+  { "RightDownTeeVector", { 0x295D, 0 }, FALSE },
+  { "RightDownVector", { 0x21C2, 0 }, FALSE },
+  { "RightDownVectorBar", { 0x2955, 0 }, FALSE },
+  { "RightFloor", { 0x230B, 0 }, FALSE },
+  { "RightTee", { 0x22A2, 0 }, FALSE },
+  { "RightTeeArrow", { 0x21A6, 0 }, FALSE },
+  { "RightTeeVector", { 0x295B, 0 }, FALSE },
+  { "RightTriangle", { 0x22B3, 0 }, FALSE },
+  { "RightTriangleBar", { 0x29D0, 0 }, FALSE },
+  { "RightTriangleEqual", { 0x22B5, 0 }, FALSE },
+  { "RightUpDownVector", { 0x294F, 0 }, FALSE },
+  { "RightUpTeeVector", { 0x295C, 0 }, FALSE },
+  { "RightUpVector", { 0x21BE, 0 }, FALSE },
+  { "RightUpVectorBar", { 0x2954, 0 }, FALSE },
+  { "RightVector", { 0x21C0, 0 }, FALSE },
+  { "RightVectorBar", { 0x2953, 0 }, FALSE },
+  { "Rightarrow", { 0x21D2, 0 }, FALSE },
+  { "Ropf", { 0x211D, 0 }, FALSE },
+  { "RoundImplies", { 0x2970, 0 }, FALSE },
+  { "Rrightarrow", { 0x21DB, 0 }, FALSE },
+  { "Rscr", { 0x211B, 0 }, FALSE },
+  { "Rsh", { 0x21B1, 0 }, FALSE },
+  { "RuleDelayed", { 0x29F4, 0 }, FALSE },
+  { "SHCHcy", { 0x429, 0 }, FALSE },
+  { "SHcy", { 0x428, 0 }, FALSE },
+  { "SOFTcy", { 0x42C, 0 }, FALSE },
+  { "Sacute", { 0x15A, 0 }, FALSE },
+  { "Sc", { 0x2ABC, 0 }, FALSE },
+  { "Scaron", { 0x160, 0 }, FALSE },
+  { "Scedil", { 0x15E, 0 }, FALSE },
+  { "Scirc", { 0x15C, 0 }, FALSE },
+  { "Scy", { 0x421, 0 }, FALSE },
+  { "Sfr", { 0x1D516, 0 }, FALSE },
+  { "ShortDownArrow", { 0x2193, 0 }, FALSE },
+  { "ShortLeftArrow", { 0x2190, 0 }, FALSE },
+  { "ShortRightArrow", { 0x2192, 0 }, FALSE },
+  { "ShortUpArrow", { 0x2191, 0 }, FALSE },
+  { "Sigma", { 0x3A3, 0 }, FALSE },
+  { "SmallCircle", { 0x2218, 0 }, FALSE },
+  { "Sopf", { 0x1D54A, 0 }, FALSE },
+  { "Sqrt", { 0x221A, 0 }, FALSE },
+  { "Square", { 0x25A1, 0 }, FALSE },
+  { "SquareIntersection", { 0x2293, 0 }, FALSE },
+  { "SquareSubset", { 0x228F, 0 }, FALSE },
+  { "SquareSubsetEqual", { 0x2291, 0 }, FALSE },
+  { "SquareSuperset", { 0x2290, 0 }, FALSE },
+  { "SquareSupersetEqual", { 0x2292, 0 }, FALSE },
+  { "SquareUnion", { 0x2294, 0 }, FALSE },
+  { "Sscr", { 0x1D4AE, 0 }, FALSE },
+  { "Star", { 0x22C6, 0 }, FALSE },
+  { "Sub", { 0x22D0, 0 }, FALSE },
+  { "Subset", { 0x22D0, 0 }, FALSE },
+  { "SubsetEqual", { 0x2286, 0 }, FALSE },
+  { "Succeeds", { 0x227B, 0 }, FALSE },
+  { "SucceedsEqual", { 0x2AB0, 0 }, FALSE },
+  { "SucceedsSlantEqual", { 0x227D, 0 }, FALSE },
+  { "SucceedsTilde", { 0x227F, 0 }, FALSE },
+  { "SuchThat", { 0x220B, 0 }, FALSE },
+  { "Sum", { 0x2211, 0 }, FALSE },
+  { "Sup", { 0x22D1, 0 }, FALSE },
+  { "Superset", { 0x2283, 0 }, FALSE },
+  { "SupersetEqual", { 0x2287, 0 }, FALSE },
+  { "Supset", { 0x22D1, 0 }, FALSE },
+  { "THORN", { 0xDE, 0 }, TRUE },
+  { "TRADE", { 0x2122, 0 }, FALSE },
+  { "TSHcy", { 0x40B, 0 }, FALSE },
+  { "TScy", { 0x426, 0 }, FALSE },
+  { "Tab", { 0x9, 0 }, FALSE },
+  { "Tau", { 0x3A4, 0 }, FALSE },
+  { "Tcaron", { 0x164, 0 }, FALSE },
+  { "Tcedil", { 0x162, 0 }, FALSE },
+  { "Tcy", { 0x422, 0 }, FALSE },
+  { "Tfr", { 0x1D517, 0 }, FALSE },
+  { "Therefore", { 0x2234, 0 }, FALSE },
+  { "Theta", { 0x398, 0 }, FALSE },
+  { "ThickSpace", { 0x205F, 0x200A }, FALSE },
+  { "ThinSpace", { 0x2009, 0 }, FALSE },
+  { "Tilde", { 0x223C, 0 }, FALSE },
+  { "TildeEqual", { 0x2243, 0 }, FALSE },
+  { "TildeFullEqual", { 0x2245, 0 }, FALSE },
+  { "TildeTilde", { 0x2248, 0 }, FALSE },
+  { "Topf", { 0x1D54B, 0 }, FALSE },
+  { "TripleDot", { 0x20DB, 0 }, FALSE },
+  { "Tscr", { 0x1D4AF, 0 }, FALSE },
+  { "Tstrok", { 0x166, 0 }, FALSE },
+  { "Uacute", { 0xDA, 0 }, TRUE },
+  { "Uarr", { 0x219F, 0 }, FALSE },
+  { "Uarrocir", { 0x2949, 0 }, FALSE },
+  { "Ubrcy", { 0x40E, 0 }, FALSE },
+  { "Ubreve", { 0x16C, 0 }, FALSE },
+  { "Ucirc", { 0xDB, 0 }, TRUE },
+  { "Ucy", { 0x423, 0 }, FALSE },
+  { "Udblac", { 0x170, 0 }, FALSE },
+  { "Ufr", { 0x1D518, 0 }, FALSE },
+  { "Ugrave", { 0xD9, 0 }, TRUE },
+  { "Umacr", { 0x16A, 0 }, FALSE },
+  { "UnderBar", { 0x5F, 0 }, FALSE },
+  { "UnderBrace", { 0x23DF, 0 }, FALSE },
+  { "UnderBracket", { 0x23B5, 0 }, FALSE },
+  { "UnderParenthesis", { 0x23DD, 0 }, FALSE },
+  { "Union", { 0x22C3, 0 }, FALSE },
+  { "UnionPlus", { 0x228E, 0 }, FALSE },
+  { "Uogon", { 0x172, 0 }, FALSE },
+  { "Uopf", { 0x1D54C, 0 }, FALSE },
+  { "UpArrow", { 0x2191, 0 }, FALSE },
+  { "UpArrowBar", { 0x2912, 0 }, FALSE },
+  { "UpArrowDownArrow", { 0x21C5, 0 }, FALSE },
+  { "UpDownArrow", { 0x2195, 0 }, FALSE },
+  { "UpEquilibrium", { 0x296E, 0 }, FALSE },
+  { "UpTee", { 0x22A5, 0 }, FALSE },
+  { "UpTeeArrow", { 0x21A5, 0 }, FALSE },
+  { "Uparrow", { 0x21D1, 0 }, FALSE },
+  { "Updownarrow", { 0x21D5, 0 }, FALSE },
+  { "UpperLeftArrow", { 0x2196, 0 }, FALSE },
+  { "UpperRightArrow", { 0x2197, 0 }, FALSE },
+  { "Upsi", { 0x3D2, 0 }, FALSE },
+  { "Upsilon", { 0x3A5, 0 }, FALSE },
+  { "Uring", { 0x16E, 0 }, FALSE },
+  { "Uscr", { 0x1D4B0, 0 }, FALSE },
+  { "Utilde", { 0x168, 0 }, FALSE },
+  { "Uuml", { 0xDC, 0 }, TRUE },
+  { "VDash", { 0x22AB, 0 }, FALSE },
+  { "Vbar", { 0x2AEB, 0 }, FALSE },
+  { "Vcy", { 0x412, 0 }, FALSE },
+  { "Vdash", { 0x22A9, 0 }, FALSE },
+  { "Vdashl", { 0x2AE6, 0 }, FALSE },
+  { "Vee", { 0x22C1, 0 }, FALSE },
+  { "Verbar", { 0x2016, 0 }, FALSE },
+  { "Vert", { 0x2016, 0 }, FALSE },
+  { "VerticalBar", { 0x2223, 0 }, FALSE },
+  { "VerticalLine", { 0x7C, 0 }, FALSE },
+  { "VerticalSeparator", { 0x2758, 0 }, FALSE },
+  { "VerticalTilde", { 0x2240, 0 }, FALSE },
+  { "VeryThinSpace", { 0x200A, 0 }, FALSE },
+  { "Vfr", { 0x1D519, 0 }, FALSE },
+  { "Vopf", { 0x1D54D, 0 }, FALSE },
+  { "Vscr", { 0x1D4B1, 0 }, FALSE },
+  { "Vvdash", { 0x22AA, 0 }, FALSE },
+  { "Wcirc", { 0x174, 0 }, FALSE },
+  { "Wedge", { 0x22C0, 0 }, FALSE },
+  { "Wfr", { 0x1D51A, 0 }, FALSE },
+  { "Wopf", { 0x1D54E, 0 }, FALSE },
+  { "Wscr", { 0x1D4B2, 0 }, FALSE },
+  { "Xfr", { 0x1D51B, 0 }, FALSE },
+  { "Xi", { 0x39E, 0 }, FALSE },
+  { "Xopf", { 0x1D54F, 0 }, FALSE },
+  { "Xscr", { 0x1D4B3, 0 }, FALSE },
+  { "YAcy", { 0x42F, 0 }, FALSE },
+  { "YIcy", { 0x407, 0 }, FALSE },
+  { "YUcy", { 0x42E, 0 }, FALSE },
+  { "Yacute", { 0xDD, 0 }, TRUE },
+  { "Ycirc", { 0x176, 0 }, FALSE },
+  { "Ycy", { 0x42B, 0 }, FALSE },
+  { "Yfr", { 0x1D51C, 0 }, FALSE },
+  { "Yopf", { 0x1D550, 0 }, FALSE },
+  { "Yscr", { 0x1D4B4, 0 }, FALSE },
+  { "Yuml", { 0x178, 0 }, FALSE },
+  { "ZHcy", { 0x416, 0 }, FALSE },
+  { "Zacute", { 0x179, 0 }, FALSE },
+  { "Zcaron", { 0x17D, 0 }, FALSE },
+  { "Zcy", { 0x417, 0 }, FALSE },
+  { "Zdot", { 0x17B, 0 }, FALSE },
+  { "ZeroWidthSpace", { 0x200B, 0 }, FALSE },
+  { "Zeta", { 0x396, 0 }, FALSE },
+  { "Zfr", { 0x2128, 0 }, FALSE },
+  { "Zopf", { 0x2124, 0 }, FALSE },
+  { "Zscr", { 0x1D4B5, 0 }, FALSE },
+  { "aacute", { 0xE1, 0 }, TRUE },
+  { "abreve", { 0x103, 0 }, FALSE },
+  { "ac", { 0x223E, 0 }, FALSE },
+  { "acE", { 0x223E, 0x333 }, FALSE },
+  { "acd", { 0x223F, 0 }, FALSE },
+  { "acirc", { 0xE2, 0 }, TRUE },
+  { "acute", { 0xB4, 0 }, TRUE },
+  { "acy", { 0x430, 0 }, FALSE },
+  { "aelig", { 0xE6, 0 }, TRUE },
+  { "af", { 0x2061, 0 }, FALSE },
+  { "afr", { 0x1D51E, 0 }, FALSE },
+  { "agrave", { 0xE0, 0 }, TRUE },
+  { "alefsym", { 0x2135, 0 }, FALSE },
+  { "aleph", { 0x2135, 0 }, FALSE },
+  { "alpha", { 0x3B1, 0 }, FALSE },
+  { "amacr", { 0x101, 0 }, FALSE },
+  { "amalg", { 0x2A3F, 0 }, FALSE },
+  { "amp", { 0x26, 0 }, TRUE },
+  { "and", { 0x2227, 0 }, FALSE },
+  { "andand", { 0x2A55, 0 }, FALSE },
+  { "andd", { 0x2A5C, 0 }, FALSE },
+  { "andslope", { 0x2A58, 0 }, FALSE },
+  { "andv", { 0x2A5A, 0 }, FALSE },
+  { "ang", { 0x2220, 0 }, FALSE },
+  { "ange", { 0x29A4, 0 }, FALSE },
+  { "angle", { 0x2220, 0 }, FALSE },
+  { "angmsd", { 0x2221, 0 }, FALSE },
+  { "angmsdaa", { 0x29A8, 0 }, FALSE },
+  { "angmsdab", { 0x29A9, 0 }, FALSE },
+  { "angmsdac", { 0x29AA, 0 }, FALSE },
+  { "angmsdad", { 0x29AB, 0 }, FALSE },
+  { "angmsdae", { 0x29AC, 0 }, FALSE },
+  { "angmsdaf", { 0x29AD, 0 }, FALSE },
+  { "angmsdag", { 0x29AE, 0 }, FALSE },
+  { "angmsdah", { 0x29AF, 0 }, FALSE },
+  { "angrt", { 0x221F, 0 }, FALSE },
+  { "angrtvb", { 0x22BE, 0 }, FALSE },
+  { "angrtvbd", { 0x299D, 0 }, FALSE },
+  { "angsph", { 0x2222, 0 }, FALSE },
+  { "angst", { 0xC5, 0 }, FALSE },
+  { "angzarr", { 0x237C, 0 }, FALSE },
+  { "aogon", { 0x105, 0 }, FALSE },
+  { "aopf", { 0x1D552, 0 }, FALSE },
+  { "ap", { 0x2248, 0 }, FALSE },
+  { "apE", { 0x2A70, 0 }, FALSE },
+  { "apacir", { 0x2A6F, 0 }, FALSE },
+  { "ape", { 0x224A, 0 }, FALSE },
+  { "apid", { 0x224B, 0 }, FALSE },
+  { "apos", { 0x27, 0 }, FALSE },
+  { "approx", { 0x2248, 0 }, FALSE },
+  { "approxeq", { 0x224A, 0 }, FALSE },
+  { "aring", { 0xE5, 0 }, TRUE },
+  { "ascr", { 0x1D4B6, 0 }, FALSE },
+  { "ast", { 0x2A, 0 }, FALSE },
+  { "asymp", { 0x2248, 0 }, FALSE },
+  { "asympeq", { 0x224D, 0 }, FALSE },
+  { "atilde", { 0xE3, 0 }, TRUE },
+  { "auml", { 0xE4, 0 }, TRUE },
+  { "awconint", { 0x2233, 0 }, FALSE },
+  { "awint", { 0x2A11, 0 }, FALSE },
+  { "bNot", { 0x2AED, 0 }, FALSE },
+  { "backcong", { 0x224C, 0 }, FALSE },
+  { "backepsilon", { 0x3F6, 0 }, FALSE },
+  { "backprime", { 0x2035, 0 }, FALSE },
+  { "backsim", { 0x223D, 0 }, FALSE },
+  { "backsimeq", { 0x22CD, 0 }, FALSE },
+  { "barvee", { 0x22BD, 0 }, FALSE },
+  { "barwed", { 0x2305, 0 }, FALSE },
+  { "barwedge", { 0x2305, 0 }, FALSE },
+  { "bbrk", { 0x23B5, 0 }, FALSE },
+  { "bbrktbrk", { 0x23B6, 0 }, FALSE },
+  { "bcong", { 0x224C, 0 }, FALSE },
+  { "bcy", { 0x431, 0 }, FALSE },
+  { "bdquo", { 0x201E, 0 }, FALSE },
+  { "becaus", { 0x2235, 0 }, FALSE },
+  { "because", { 0x2235, 0 }, FALSE },
+  { "bemptyv", { 0x29B0, 0 }, FALSE },
+  { "bepsi", { 0x3F6, 0 }, FALSE },
+  { "bernou", { 0x212C, 0 }, FALSE },
+  { "beta", { 0x3B2, 0 }, FALSE },
+  { "beth", { 0x2136, 0 }, FALSE },
+  { "between", { 0x226C, 0 }, FALSE },
+  { "bfr", { 0x1D51F, 0 }, FALSE },
+  { "bigcap", { 0x22C2, 0 }, FALSE },
+  { "bigcirc", { 0x25EF, 0 }, FALSE },
+  { "bigcup", { 0x22C3, 0 }, FALSE },
+  { "bigodot", { 0x2A00, 0 }, FALSE },
+  { "bigoplus", { 0x2A01, 0 }, FALSE },
+  { "bigotimes", { 0x2A02, 0 }, FALSE },
+  { "bigsqcup", { 0x2A06, 0 }, FALSE },
+  { "bigstar", { 0x2605, 0 }, FALSE },
+  { "bigtriangledown", { 0x25BD, 0 }, FALSE },
+  { "bigtriangleup", { 0x25B3, 0 }, FALSE },
+  { "biguplus", { 0x2A04, 0 }, FALSE },
+  { "bigvee", { 0x22C1, 0 }, FALSE },
+  { "bigwedge", { 0x22C0, 0 }, FALSE },
+  { "bkarow", { 0x290D, 0 }, FALSE },
+  { "blacklozenge", { 0x29EB, 0 }, FALSE },
+  { "blacksquare", { 0x25AA, 0 }, FALSE },
+  { "blacktriangle", { 0x25B4, 0 }, FALSE },
+  { "blacktriangledown", { 0x25BE, 0 }, FALSE },
+  { "blacktriangleleft", { 0x25C2, 0 }, FALSE },
+  { "blacktriangleright", { 0x25B8, 0 }, FALSE },
+  { "blank", { 0x2423, 0 }, FALSE },
+  { "blk12", { 0x2592, 0 }, FALSE },
+  { "blk14", { 0x2591, 0 }, FALSE },
+  { "blk34", { 0x2593, 0 }, FALSE },
+  { "block", { 0x2588, 0 }, FALSE },
+  { "bne", { 0x3D, 0x20E5 }, FALSE },
+  { "bnequiv", { 0x2261, 0x20E5 }, FALSE },
+  { "bnot", { 0x2310, 0 }, FALSE },
+  { "bopf", { 0x1D553, 0 }, FALSE },
+  { "bot", { 0x22A5, 0 }, FALSE },
+  { "bottom", { 0x22A5, 0 }, FALSE },
+  { "bowtie", { 0x22C8, 0 }, FALSE },
+  { "boxDL", { 0x2557, 0 }, FALSE },
+  { "boxDR", { 0x2554, 0 }, FALSE },
+  { "boxDl", { 0x2556, 0 }, FALSE },
+  { "boxDr", { 0x2553, 0 }, FALSE },
+  { "boxH", { 0x2550, 0 }, FALSE },
+  { "boxHD", { 0x2566, 0 }, FALSE },
+  { "boxHU", { 0x2569, 0 }, FALSE },
+  { "boxHd", { 0x2564, 0 }, FALSE },
+  { "boxHu", { 0x2567, 0 }, FALSE },
+  { "boxUL", { 0x255D, 0 }, FALSE },
+  { "boxUR", { 0x255A, 0 }, FALSE },
+  { "boxUl", { 0x255C, 0 }, FALSE },
+  { "boxUr", { 0x2559, 0 }, FALSE },
+  { "boxV", { 0x2551, 0 }, FALSE },
+  { "boxVH", { 0x256C, 0 }, FALSE },
+  { "boxVL", { 0x2563, 0 }, FALSE },
+  { "boxVR", { 0x2560, 0 }, FALSE },
+  { "boxVh", { 0x256B, 0 }, FALSE },
+  { "boxVl", { 0x2562, 0 }, FALSE },
+  { "boxVr", { 0x255F, 0 }, FALSE },
+  { "boxbox", { 0x29C9, 0 }, FALSE },
+  { "boxdL", { 0x2555, 0 }, FALSE },
+  { "boxdR", { 0x2552, 0 }, FALSE },
+  { "boxdl", { 0x2510, 0 }, FALSE },
+  { "boxdr", { 0x250C, 0 }, FALSE },
+  { "boxh", { 0x2500, 0 }, FALSE },
+  { "boxhD", { 0x2565, 0 }, FALSE },
+  { "boxhU", { 0x2568, 0 }, FALSE },
+  { "boxhd", { 0x252C, 0 }, FALSE },
+  { "boxhu", { 0x2534, 0 }, FALSE },
+  { "boxminus", { 0x229F, 0 }, FALSE },
+  { "boxplus", { 0x229E, 0 }, FALSE },
+  { "boxtimes", { 0x22A0, 0 }, FALSE },
+  { "boxuL", { 0x255B, 0 }, FALSE },
+  { "boxuR", { 0x2558, 0 }, FALSE },
+  { "boxul", { 0x2518, 0 }, FALSE },
+  { "boxur", { 0x2514, 0 }, FALSE },
+  { "boxv", { 0x2502, 0 }, FALSE },
+  { "boxvH", { 0x256A, 0 }, FALSE },
+  { "boxvL", { 0x2561, 0 }, FALSE },
+  { "boxvR", { 0x255E, 0 }, FALSE },
+  { "boxvh", { 0x253C, 0 }, FALSE },
+  { "boxvl", { 0x2524, 0 }, FALSE },
+  { "boxvr", { 0x251C, 0 }, FALSE },
+  { "bprime", { 0x2035, 0 }, FALSE },
+  { "breve", { 0x2D8, 0 }, FALSE },
+  { "brvbar", { 0xA6, 0 }, TRUE },
+  { "bscr", { 0x1D4B7, 0 }, FALSE },
+  { "bsemi", { 0x204F, 0 }, FALSE },
+  { "bsim", { 0x223D, 0 }, FALSE },
+  { "bsime", { 0x22CD, 0 }, FALSE },
+  { "bsol", { 0x5C, 0 }, FALSE },
+  { "bsolb", { 0x29C5, 0 }, FALSE },
+  { "bsolhsub", { 0x27C8, 0 }, FALSE },
+  { "bull", { 0x2022, 0 }, FALSE },
+  { "bullet", { 0x2022, 0 }, FALSE },
+  { "bump", { 0x224E, 0 }, FALSE },
+  { "bumpE", { 0x2AAE, 0 }, FALSE },
+  { "bumpe", { 0x224F, 0 }, FALSE },
+  { "bumpeq", { 0x224F, 0 }, FALSE },
+  { "cacute", { 0x107, 0 }, FALSE },
+  { "cap", { 0x2229, 0 }, FALSE },
+  { "capand", { 0x2A44, 0 }, FALSE },
+  { "capbrcup", { 0x2A49, 0 }, FALSE },
+  { "capcap", { 0x2A4B, 0 }, FALSE },
+  { "capcup", { 0x2A47, 0 }, FALSE },
+  { "capdot", { 0x2A40, 0 }, FALSE },
+  { "caps", { 0x2229, 0xFE00 }, FALSE },
+  { "caret", { 0x2041, 0 }, FALSE },
+  { "caron", { 0x2C7, 0 }, FALSE },
+  { "ccaps", { 0x2A4D, 0 }, FALSE },
+  { "ccaron", { 0x10D, 0 }, FALSE },
+  { "ccedil", { 0xE7, 0 }, TRUE },
+  { "ccirc", { 0x109, 0 }, FALSE },
+  { "ccups", { 0x2A4C, 0 }, FALSE },
+  { "ccupssm", { 0x2A50, 0 }, FALSE },
+  { "cdot", { 0x10B, 0 }, FALSE },
+  { "cedil", { 0xB8, 0 }, TRUE },
+  { "cemptyv", { 0x29B2, 0 }, FALSE },
+  { "cent", { 0xA2, 0 }, TRUE },
+  { "centerdot", { 0xB7, 0 }, FALSE },
+  { "cfr", { 0x1D520, 0 }, FALSE },
+  { "chcy", { 0x447, 0 }, FALSE },
+  { "check", { 0x2713, 0 }, FALSE },
+  { "checkmark", { 0x2713, 0 }, FALSE },
+  { "chi", { 0x3C7, 0 }, FALSE },
+  { "cir", { 0x25CB, 0 }, FALSE },
+  { "cirE", { 0x29C3, 0 }, FALSE },
+  { "circ", { 0x2C6, 0 }, FALSE },
+  { "circeq", { 0x2257, 0 }, FALSE },
+  { "circlearrowleft", { 0x21BA, 0 }, FALSE },
+  { "circlearrowright", { 0x21BB, 0 }, FALSE },
+  { "circledR", { 0xAE, 0 }, FALSE },
+  { "circledS", { 0x24C8, 0 }, FALSE },
+  { "circledast", { 0x229B, 0 }, FALSE },
+  { "circledcirc", { 0x229A, 0 }, FALSE },
+  { "circleddash", { 0x229D, 0 }, FALSE },
+  { "cire", { 0x2257, 0 }, FALSE },
+  { "cirfnint", { 0x2A10, 0 }, FALSE },
+  { "cirmid", { 0x2AEF, 0 }, FALSE },
+  { "cirscir", { 0x29C2, 0 }, FALSE },
+  { "clubs", { 0x2663, 0 }, FALSE },
+  { "clubsuit", { 0x2663, 0 }, FALSE },
+  { "colon", { 0x3A, 0 }, FALSE },
+  { "colone", { 0x2254, 0 }, FALSE },
+  { "coloneq", { 0x2254, 0 }, FALSE },
+  { "comma", { 0x2C, 0 }, FALSE },
+  { "commat", { 0x40, 0 }, FALSE },
+  { "comp", { 0x2201, 0 }, FALSE },
+  { "compfn", { 0x2218, 0 }, FALSE },
+  { "complement", { 0x2201, 0 }, FALSE },
+  { "complexes", { 0x2102, 0 }, FALSE },
+  { "cong", { 0x2245, 0 }, FALSE },
+  { "congdot", { 0x2A6D, 0 }, FALSE },
+  { "conint", { 0x222E, 0 }, FALSE },
+  { "copf", { 0x1D554, 0 }, FALSE },
+  { "coprod", { 0x2210, 0 }, FALSE },
+  { "copy", { 0xA9, 0 }, TRUE },
+  { "copysr", { 0x2117, 0 }, FALSE },
+  { "crarr", { 0x21B5, 0 }, FALSE },
+  { "cross", { 0x2717, 0 }, FALSE },
+  { "cscr", { 0x1D4B8, 0 }, FALSE },
+  { "csub", { 0x2ACF, 0 }, FALSE },
+  { "csube", { 0x2AD1, 0 }, FALSE },
+  { "csup", { 0x2AD0, 0 }, FALSE },
+  { "csupe", { 0x2AD2, 0 }, FALSE },
+  { "ctdot", { 0x22EF, 0 }, FALSE },
+  { "cudarrl", { 0x2938, 0 }, FALSE },
+  { "cudarrr", { 0x2935, 0 }, FALSE },
+  { "cuepr", { 0x22DE, 0 }, FALSE },
+  { "cuesc", { 0x22DF, 0 }, FALSE },
+  { "cularr", { 0x21B6, 0 }, FALSE },
+  { "cularrp", { 0x293D, 0 }, FALSE },
+  { "cup", { 0x222A, 0 }, FALSE },
+  { "cupbrcap", { 0x2A48, 0 }, FALSE },
+  { "cupcap", { 0x2A46, 0 }, FALSE },
+  { "cupcup", { 0x2A4A, 0 }, FALSE },
+  { "cupdot", { 0x228D, 0 }, FALSE },
+  { "cupor", { 0x2A45, 0 }, FALSE },
+  { "cups", { 0x222A, 0xFE00 }, FALSE },
+  { "curarr", { 0x21B7, 0 }, FALSE },
+  { "curarrm", { 0x293C, 0 }, FALSE },
+  { "curlyeqprec", { 0x22DE, 0 }, FALSE },
+  { "curlyeqsucc", { 0x22DF, 0 }, FALSE },
+  { "curlyvee", { 0x22CE, 0 }, FALSE },
+  { "curlywedge", { 0x22CF, 0 }, FALSE },
+  { "curren", { 0xA4, 0 }, TRUE },
+  { "curvearrowleft", { 0x21B6, 0 }, FALSE },
+  { "curvearrowright", { 0x21B7, 0 }, FALSE },
+  { "cuvee", { 0x22CE, 0 }, FALSE },
+  { "cuwed", { 0x22CF, 0 }, FALSE },
+  { "cwconint", { 0x2232, 0 }, FALSE },
+  { "cwint", { 0x2231, 0 }, FALSE },
+  { "cylcty", { 0x232D, 0 }, FALSE },
+  { "dArr", { 0x21D3, 0 }, FALSE },
+  { "dHar", { 0x2965, 0 }, FALSE },
+  { "dagger", { 0x2020, 0 }, FALSE },
+  { "daleth", { 0x2138, 0 }, FALSE },
+  { "darr", { 0x2193, 0 }, FALSE },
+  { "dash", { 0x2010, 0 }, FALSE },
+  { "dashv", { 0x22A3, 0 }, FALSE },
+  { "dbkarow", { 0x290F, 0 }, FALSE },
+  { "dblac", { 0x2DD, 0 }, FALSE },
+  { "dcaron", { 0x10F, 0 }, FALSE },
+  { "dcy", { 0x434, 0 }, FALSE },
+  { "dd", { 0x2146, 0 }, FALSE },
+  { "ddagger", { 0x2021, 0 }, FALSE },
+  { "ddarr", { 0x21CA, 0 }, FALSE },
+  { "ddotseq", { 0x2A77, 0 }, FALSE },
+  { "deg", { 0xB0, 0 }, TRUE },
+  { "delta", { 0x3B4, 0 }, FALSE },
+  { "demptyv", { 0x29B1, 0 }, FALSE },
+  { "dfisht", { 0x297F, 0 }, FALSE },
+  { "dfr", { 0x1D521, 0 }, FALSE },
+  { "dharl", { 0x21C3, 0 }, FALSE },
+  { "dharr", { 0x21C2, 0 }, FALSE },
+  { "diam", { 0x22C4, 0 }, FALSE },
+  { "diamond", { 0x22C4, 0 }, FALSE },
+  { "diamondsuit", { 0x2666, 0 }, FALSE },
+  { "diams", { 0x2666, 0 }, FALSE },
+  { "die", { 0xA8, 0 }, FALSE },
+  { "digamma", { 0x3DD, 0 }, FALSE },
+  { "disin", { 0x22F2, 0 }, FALSE },
+  { "div", { 0xF7, 0 }, FALSE },
+  { "divide", { 0xF7, 0 }, TRUE },
+  { "divideontimes", { 0x22C7, 0 }, FALSE },
+  { "divonx", { 0x22C7, 0 }, FALSE },
+  { "djcy", { 0x452, 0 }, FALSE },
+  { "dlcorn", { 0x231E, 0 }, FALSE },
+  { "dlcrop", { 0x230D, 0 }, FALSE },
+  { "dollar", { 0x24, 0 }, FALSE },
+  { "dopf", { 0x1D555, 0 }, FALSE },
+  { "dot", { 0x2D9, 0 }, FALSE },
+  { "doteq", { 0x2250, 0 }, FALSE },
+  { "doteqdot", { 0x2251, 0 }, FALSE },
+  { "dotminus", { 0x2238, 0 }, FALSE },
+  { "dotplus", { 0x2214, 0 }, FALSE },
+  { "dotsquare", { 0x22A1, 0 }, FALSE },
+  { "doublebarwedge", { 0x2306, 0 }, FALSE },
+  { "downarrow", { 0x2193, 0 }, FALSE },
+  { "downdownarrows", { 0x21CA, 0 }, FALSE },
+  { "downharpoonleft", { 0x21C3, 0 }, FALSE },
+  { "downharpoonright", { 0x21C2, 0 }, FALSE },
+  { "drbkarow", { 0x2910, 0 }, FALSE },
+  { "drcorn", { 0x231F, 0 }, FALSE },
+  { "drcrop", { 0x230C, 0 }, FALSE },
+  { "dscr", { 0x1D4B9, 0 }, FALSE },
+  { "dscy", { 0x455, 0 }, FALSE },
+  { "dsol", { 0x29F6, 0 }, FALSE },
+  { "dstrok", { 0x111, 0 }, FALSE },
+  { "dtdot", { 0x22F1, 0 }, FALSE },
+  { "dtri", { 0x25BF, 0 }, FALSE },
+  { "dtrif", { 0x25BE, 0 }, FALSE },
+  { "duarr", { 0x21F5, 0 }, FALSE },
+  { "duhar", { 0x296F, 0 }, FALSE },
+  { "dwangle", { 0x29A6, 0 }, FALSE },
+  { "dzcy", { 0x45F, 0 }, FALSE },
+  { "dzigrarr", { 0x27FF, 0 }, FALSE },
+  { "eDDot", { 0x2A77, 0 }, FALSE },
+  { "eDot", { 0x2251, 0 }, FALSE },
+  { "eacute", { 0xE9, 0 }, TRUE },
+  { "easter", { 0x2A6E, 0 }, FALSE },
+  { "ecaron", { 0x11B, 0 }, FALSE },
+  { "ecir", { 0x2256, 0 }, FALSE },
+  { "ecirc", { 0xEA, 0 }, TRUE },
+  { "ecolon", { 0x2255, 0 }, FALSE },
+  { "ecy", { 0x44D, 0 }, FALSE },
+  { "edot", { 0x117, 0 }, FALSE },
+  { "ee", { 0x2147, 0 }, FALSE },
+  { "efDot", { 0x2252, 0 }, FALSE },
+  { "efr", { 0x1D522, 0 }, FALSE },
+  { "eg", { 0x2A9A, 0 }, FALSE },
+  { "egrave", { 0xE8, 0 }, TRUE },
+  { "egs", { 0x2A96, 0 }, FALSE },
+  { "egsdot", { 0x2A98, 0 }, FALSE },
+  { "el", { 0x2A99, 0 }, FALSE },
+  { "elinters", { 0x23E7, 0 }, FALSE },
+  { "ell", { 0x2113, 0 }, FALSE },
+  { "els", { 0x2A95, 0 }, FALSE },
+  { "elsdot", { 0x2A97, 0 }, FALSE },
+  { "emacr", { 0x113, 0 }, FALSE },
+  { "empty", { 0x2205, 0 }, FALSE },
+  { "emptyset", { 0x2205, 0 }, FALSE },
+  { "emptyv", { 0x2205, 0 }, FALSE },
+  { "emsp", { 0x2003, 0 }, FALSE },
+  { "emsp13", { 0x2004, 0 }, FALSE },
+  { "emsp14", { 0x2005, 0 }, FALSE },
+  { "eng", { 0x14B, 0 }, FALSE },
+  { "ensp", { 0x2002, 0 }, FALSE },
+  { "eogon", { 0x119, 0 }, FALSE },
+  { "eopf", { 0x1D556, 0 }, FALSE },
+  { "epar", { 0x22D5, 0 }, FALSE },
+  { "eparsl", { 0x29E3, 0 }, FALSE },
+  { "eplus", { 0x2A71, 0 }, FALSE },
+  { "epsi", { 0x3B5, 0 }, FALSE },
+  { "epsilon", { 0x3B5, 0 }, FALSE },
+  { "epsiv", { 0x3F5, 0 }, FALSE },
+  { "eqcirc", { 0x2256, 0 }, FALSE },
+  { "eqcolon", { 0x2255, 0 }, FALSE },
+  { "eqsim", { 0x2242, 0 }, FALSE },
+  { "eqslantgtr", { 0x2A96, 0 }, FALSE },
+  { "eqslantless", { 0x2A95, 0 }, FALSE },
+  { "equals", { 0x3D, 0 }, FALSE },
+  { "equest", { 0x225F, 0 }, FALSE },
+  { "equiv", { 0x2261, 0 }, FALSE },
+  { "equivDD", { 0x2A78, 0 }, FALSE },
+  { "eqvparsl", { 0x29E5, 0 }, FALSE },
+  { "erDot", { 0x2253, 0 }, FALSE },
+  { "erarr", { 0x2971, 0 }, FALSE },
+  { "escr", { 0x212F, 0 }, FALSE },
+  { "esdot", { 0x2250, 0 }, FALSE },
+  { "esim", { 0x2242, 0 }, FALSE },
+  { "eta", { 0x3B7, 0 }, FALSE },
+  { "eth", { 0xF0, 0 }, TRUE },
+  { "euml", { 0xEB, 0 }, TRUE },
+  { "euro", { 0x20AC, 0 }, FALSE },
+  { "excl", { 0x21, 0 }, FALSE },
+  { "exist", { 0x2203, 0 }, FALSE },
+  { "expectation", { 0x2130, 0 }, FALSE },
+  { "exponentiale", { 0x2147, 0 }, FALSE },
+  { "fallingdotseq", { 0x2252, 0 }, FALSE },
+  { "fcy", { 0x444, 0 }, FALSE },
+  { "female", { 0x2640, 0 }, FALSE },
+  { "ffilig", { 0xFB03, 0 }, FALSE },
+  { "fflig", { 0xFB00, 0 }, FALSE },
+  { "ffllig", { 0xFB04, 0 }, FALSE },
+  { "ffr", { 0x1D523, 0 }, FALSE },
+  { "filig", { 0xFB01, 0 }, FALSE },
+  { "fjlig", { 0x66, 0x6A }, FALSE },
+  { "flat", { 0x266D, 0 }, FALSE },
+  { "fllig", { 0xFB02, 0 }, FALSE },
+  { "fltns", { 0x25B1, 0 }, FALSE },
+  { "fnof", { 0x192, 0 }, FALSE },
+  { "fopf", { 0x1D557, 0 }, FALSE },
+  { "forall", { 0x2200, 0 }, FALSE },
+  { "fork", { 0x22D4, 0 }, FALSE },
+  { "forkv", { 0x2AD9, 0 }, FALSE },
+  { "fpartint", { 0x2A0D, 0 }, FALSE },
+  { "frac12", { 0xBD, 0 }, TRUE },
+  { "frac13", { 0x2153, 0 }, FALSE },
+  { "frac14", { 0xBC, 0 }, TRUE },
+  { "frac15", { 0x2155, 0 }, FALSE },
+  { "frac16", { 0x2159, 0 }, FALSE },
+  { "frac18", { 0x215B, 0 }, FALSE },
+  { "frac23", { 0x2154, 0 }, FALSE },
+  { "frac25", { 0x2156, 0 }, FALSE },
+  { "frac34", { 0xBE, 0 }, TRUE },
+  { "frac35", { 0x2157, 0 }, FALSE },
+  { "frac38", { 0x215C, 0 }, FALSE },
+  { "frac45", { 0x2158, 0 }, FALSE },
+  { "frac56", { 0x215A, 0 }, FALSE },
+  { "frac58", { 0x215D, 0 }, FALSE },
+  { "frac78", { 0x215E, 0 }, FALSE },
+  { "frasl", { 0x2044, 0 }, FALSE },
+  { "frown", { 0x2322, 0 }, FALSE },
+  { "fscr", { 0x1D4BB, 0 }, FALSE },
+  { "gE", { 0x2267, 0 }, FALSE },
+  { "gEl", { 0x2A8C, 0 }, FALSE },
+  { "gacute", { 0x1F5, 0 }, FALSE },
+  { "gamma", { 0x3B3, 0 }, FALSE },
+  { "gammad", { 0x3DD, 0 }, FALSE },
+  { "gap", { 0x2A86, 0 }, FALSE },
+  { "gbreve", { 0x11F, 0 }, FALSE },
+  { "gcirc", { 0x11D, 0 }, FALSE },
+  { "gcy", { 0x433, 0 }, FALSE },
+  { "gdot", { 0x121, 0 }, FALSE },
+  { "ge", { 0x2265, 0 }, FALSE },
+  { "gel", { 0x22DB, 0 }, FALSE },
+  { "geq", { 0x2265, 0 }, FALSE },
+  { "geqq", { 0x2267, 0 }, FALSE },
+  { "geqslant", { 0x2A7E, 0 }, FALSE },
+  { "ges", { 0x2A7E, 0 }, FALSE },
+  { "gescc", { 0x2AA9, 0 }, FALSE },
+  { "gesdot", { 0x2A80, 0 }, FALSE },
+  { "gesdoto", { 0x2A82, 0 }, FALSE },
+  { "gesdotol", { 0x2A84, 0 }, FALSE },
+  { "gesl", { 0x22DB, 0xFE00 }, FALSE },
+  { "gesles", { 0x2A94, 0 }, FALSE },
+  { "gfr", { 0x1D524, 0 }, FALSE },
+  { "gg", { 0x226B, 0 }, FALSE },
+  { "ggg", { 0x22D9, 0 }, FALSE },
+  { "gimel", { 0x2137, 0 }, FALSE },
+  { "gjcy", { 0x453, 0 }, FALSE },
+  { "gl", { 0x2277, 0 }, FALSE },
+  { "glE", { 0x2A92, 0 }, FALSE },
+  { "gla", { 0x2AA5, 0 }, FALSE },
+  { "glj", { 0x2AA4, 0 }, FALSE },
+  { "gnE", { 0x2269, 0 }, FALSE },
+  { "gnap", { 0x2A8A, 0 }, FALSE },
+  { "gnapprox", { 0x2A8A, 0 }, FALSE },
+  { "gne", { 0x2A88, 0 }, FALSE },
+  { "gneq", { 0x2A88, 0 }, FALSE },
+  { "gneqq", { 0x2269, 0 }, FALSE },
+  { "gnsim", { 0x22E7, 0 }, FALSE },
+  { "gopf", { 0x1D558, 0 }, FALSE },
+  { "grave", { 0x60, 0 }, FALSE },
+  { "gscr", { 0x210A, 0 }, FALSE },
+  { "gsim", { 0x2273, 0 }, FALSE },
+  { "gsime", { 0x2A8E, 0 }, FALSE },
+  { "gsiml", { 0x2A90, 0 }, FALSE },
+  { "gt", { 0x3E, 0 }, TRUE },
+  { "gtcc", { 0x2AA7, 0 }, FALSE },
+  { "gtcir", { 0x2A7A, 0 }, FALSE },
+  { "gtdot", { 0x22D7, 0 }, FALSE },
+  { "gtlPar", { 0x2995, 0 }, FALSE },
+  { "gtquest", { 0x2A7C, 0 }, FALSE },
+  { "gtrapprox", { 0x2A86, 0 }, FALSE },
+  { "gtrarr", { 0x2978, 0 }, FALSE },
+  { "gtrdot", { 0x22D7, 0 }, FALSE },
+  { "gtreqless", { 0x22DB, 0 }, FALSE },
+  { "gtreqqless", { 0x2A8C, 0 }, FALSE },
+  { "gtrless", { 0x2277, 0 }, FALSE },
+  { "gtrsim", { 0x2273, 0 }, FALSE },
+  { "gvertneqq", { 0x2269, 0xFE00 }, FALSE },
+  { "gvnE", { 0x2269, 0xFE00 }, FALSE },
+  { "hArr", { 0x21D4, 0 }, FALSE },
+  { "hairsp", { 0x200A, 0 }, FALSE },
+  { "half", { 0xBD, 0 }, FALSE },
+  { "hamilt", { 0x210B, 0 }, FALSE },
+  { "hardcy", { 0x44A, 0 }, FALSE },
+  { "harr", { 0x2194, 0 }, FALSE },
+  { "harrcir", { 0x2948, 0 }, FALSE },
+  { "harrw", { 0x21AD, 0 }, FALSE },
+  { "hbar", { 0x210F, 0 }, FALSE },
+  { "hcirc", { 0x125, 0 }, FALSE },
+  { "hearts", { 0x2665, 0 }, FALSE },
+  { "heartsuit", { 0x2665, 0 }, FALSE },
+  { "hellip", { 0x2026, 0 }, FALSE },
+  { "hercon", { 0x22B9, 0 }, FALSE },
+  { "hfr", { 0x1D525, 0 }, FALSE },
+  { "hksearow", { 0x2925, 0 }, FALSE },
+  { "hkswarow", { 0x2926, 0 }, FALSE },
+  { "hoarr", { 0x21FF, 0 }, FALSE },
+  { "homtht", { 0x223B, 0 }, FALSE },
+  { "hookleftarrow", { 0x21A9, 0 }, FALSE },
+  { "hookrightarrow", { 0x21AA, 0 }, FALSE },
+  { "hopf", { 0x1D559, 0 }, FALSE },
+  { "horbar", { 0x2015, 0 }, FALSE },
+  { "hscr", { 0x1D4BD, 0 }, FALSE },
+  { "hslash", { 0x210F, 0 }, FALSE },
+  { "hstrok", { 0x127, 0 }, FALSE },
+  { "hybull", { 0x2043, 0 }, FALSE },
+  { "hyphen", { 0x2010, 0 }, FALSE },
+  { "iacute", { 0xED, 0 }, TRUE },
+  { "ic", { 0x2063, 0 }, FALSE },
+  { "icirc", { 0xEE, 0 }, TRUE },
+  { "icy", { 0x438, 0 }, FALSE },
+  { "iecy", { 0x435, 0 }, FALSE },
+  { "iexcl", { 0xA1, 0 }, TRUE },
+  { "iff", { 0x21D4, 0 }, FALSE },
+  { "ifr", { 0x1D526, 0 }, FALSE },
+  { "igrave", { 0xEC, 0 }, TRUE },
+  { "ii", { 0x2148, 0 }, FALSE },
+  { "iiiint", { 0x2A0C, 0 }, FALSE },
+  { "iiint", { 0x222D, 0 }, FALSE },
+  { "iinfin", { 0x29DC, 0 }, FALSE },
+  { "iiota", { 0x2129, 0 }, FALSE },
+  { "ijlig", { 0x133, 0 }, FALSE },
+  { "imacr", { 0x12B, 0 }, FALSE },
+  { "image", { 0x2111, 0 }, FALSE },
+  { "imagline", { 0x2110, 0 }, FALSE },
+  { "imagpart", { 0x2111, 0 }, FALSE },
+  { "imath", { 0x131, 0 }, FALSE },
+  { "imof", { 0x22B7, 0 }, FALSE },
+  { "imped", { 0x1B5, 0 }, FALSE },
+  { "in", { 0x2208, 0 }, FALSE },
+  { "incare", { 0x2105, 0 }, FALSE },
+  { "infin", { 0x221E, 0 }, FALSE },
+  { "infintie", { 0x29DD, 0 }, FALSE },
+  { "inodot", { 0x131, 0 }, FALSE },
+  { "int", { 0x222B, 0 }, FALSE },
+  { "intcal", { 0x22BA, 0 }, FALSE },
+  { "integers", { 0x2124, 0 }, FALSE },
+  { "intercal", { 0x22BA, 0 }, FALSE },
+  { "intlarhk", { 0x2A17, 0 }, FALSE },
+  { "intprod", { 0x2A3C, 0 }, FALSE },
+  { "iocy", { 0x451, 0 }, FALSE },
+  { "iogon", { 0x12F, 0 }, FALSE },
+  { "iopf", { 0x1D55A, 0 }, FALSE },
+  { "iota", { 0x3B9, 0 }, FALSE },
+  { "iprod", { 0x2A3C, 0 }, FALSE },
+  { "iquest", { 0xBF, 0 }, TRUE },
+  { "iscr", { 0x1D4BE, 0 }, FALSE },
+  { "isin", { 0x2208, 0 }, FALSE },
+  { "isinE", { 0x22F9, 0 }, FALSE },
+  { "isindot", { 0x22F5, 0 }, FALSE },
+  { "isins", { 0x22F4, 0 }, FALSE },
+  { "isinsv", { 0x22F3, 0 }, FALSE },
+  { "isinv", { 0x2208, 0 }, FALSE },
+  { "it", { 0x2062, 0 }, FALSE },
+  { "itilde", { 0x129, 0 }, FALSE },
+  { "iukcy", { 0x456, 0 }, FALSE },
+  { "iuml", { 0xEF, 0 }, TRUE },
+  { "jcirc", { 0x135, 0 }, FALSE },
+  { "jcy", { 0x439, 0 }, FALSE },
+  { "jfr", { 0x1D527, 0 }, FALSE },
+  { "jmath", { 0x237, 0 }, FALSE },
+  { "jopf", { 0x1D55B, 0 }, FALSE },
+  { "jscr", { 0x1D4BF, 0 }, FALSE },
+  { "jsercy", { 0x458, 0 }, FALSE },
+  { "jukcy", { 0x454, 0 }, FALSE },
+  { "kappa", { 0x3BA, 0 }, FALSE },
+  { "kappav", { 0x3F0, 0 }, FALSE },
+  { "kcedil", { 0x137, 0 }, FALSE },
+  { "kcy", { 0x43A, 0 }, FALSE },
+  { "kfr", { 0x1D528, 0 }, FALSE },
+  { "kgreen", { 0x138, 0 }, FALSE },
+  { "khcy", { 0x445, 0 }, FALSE },
+  { "kjcy", { 0x45C, 0 }, FALSE },
+  { "kopf", { 0x1D55C, 0 }, FALSE },
+  { "kscr", { 0x1D4C0, 0 }, FALSE },
+  { "lAarr", { 0x21DA, 0 }, FALSE },
+  { "lArr", { 0x21D0, 0 }, FALSE },
+  { "lAtail", { 0x291B, 0 }, FALSE },
+  { "lBarr", { 0x290E, 0 }, FALSE },
+  { "lE", { 0x2266, 0 }, FALSE },
+  { "lEg", { 0x2A8B, 0 }, FALSE },
+  { "lHar", { 0x2962, 0 }, FALSE },
+  { "lacute", { 0x13A, 0 }, FALSE },
+  { "laemptyv", { 0x29B4, 0 }, FALSE },
+  { "lagran", { 0x2112, 0 }, FALSE },
+  { "lambda", { 0x3BB, 0 }, FALSE },
+  { "lang", { 0x27E8, 0 }, FALSE },
+  { "langd", { 0x2991, 0 }, FALSE },
+  { "langle", { 0x27E8, 0 }, FALSE },
+  { "lap", { 0x2A85, 0 }, FALSE },
+  { "laquo", { 0xAB, 0 }, TRUE },
+  { "larr", { 0x2190, 0 }, FALSE },
+  { "larrb", { 0x21E4, 0 }, FALSE },
+  { "larrbfs", { 0x291F, 0 }, FALSE },
+  { "larrfs", { 0x291D, 0 }, FALSE },
+  { "larrhk", { 0x21A9, 0 }, FALSE },
+  { "larrlp", { 0x21AB, 0 }, FALSE },
+  { "larrpl", { 0x2939, 0 }, FALSE },
+  { "larrsim", { 0x2973, 0 }, FALSE },
+  { "larrtl", { 0x21A2, 0 }, FALSE },
+  { "lat", { 0x2AAB, 0 }, FALSE },
+  { "latail", { 0x2919, 0 }, FALSE },
+  { "late", { 0x2AAD, 0 }, FALSE },
+  { "lates", { 0x2AAD, 0xFE00 }, FALSE },
+  { "lbarr", { 0x290C, 0 }, FALSE },
+  { "lbbrk", { 0x2772, 0 }, FALSE },
+  { "lbrace", { 0x7B, 0 }, FALSE },
+  { "lbrack", { 0x5B, 0 }, FALSE },
+  { "lbrke", { 0x298B, 0 }, FALSE },
+  { "lbrksld", { 0x298F, 0 }, FALSE },
+  { "lbrkslu", { 0x298D, 0 }, FALSE },
+  { "lcaron", { 0x13E, 0 }, FALSE },
+  { "lcedil", { 0x13C, 0 }, FALSE },
+  { "lceil", { 0x2308, 0 }, FALSE },
+  { "lcub", { 0x7B, 0 }, FALSE },
+  { "lcy", { 0x43B, 0 }, FALSE },
+  { "ldca", { 0x2936, 0 }, FALSE },
+  { "ldquo", { 0x201C, 0 }, FALSE },
+  { "ldquor", { 0x201E, 0 }, FALSE },
+  { "ldrdhar", { 0x2967, 0 }, FALSE },
+  { "ldrushar", { 0x294B, 0 }, FALSE },
+  { "ldsh", { 0x21B2, 0 }, FALSE },
+  { "le", { 0x2264, 0 }, FALSE },
+  { "leftarrow", { 0x2190, 0 }, FALSE },
+  { "leftarrowtail", { 0x21A2, 0 }, FALSE },
+  { "leftharpoondown", { 0x21BD, 0 }, FALSE },
+  { "leftharpoonup", { 0x21BC, 0 }, FALSE },
+  { "leftleftarrows", { 0x21C7, 0 }, FALSE },
+  { "leftrightarrow", { 0x2194, 0 }, FALSE },
+  { "leftrightarrows", { 0x21C6, 0 }, FALSE },
+  { "leftrightharpoons", { 0x21CB, 0 }, FALSE },
+  { "leftrightsquigarrow", { 0x21AD, 0 }, FALSE },
+  { "leftthreetimes", { 0x22CB, 0 }, FALSE },
+  { "leg", { 0x22DA, 0 }, FALSE },
+  { "leq", { 0x2264, 0 }, FALSE },
+  { "leqq", { 0x2266, 0 }, FALSE },
+  { "leqslant", { 0x2A7D, 0 }, FALSE },
+  { "les", { 0x2A7D, 0 }, FALSE },
+  { "lescc", { 0x2AA8, 0 }, FALSE },
+  { "lesdot", { 0x2A7F, 0 }, FALSE },
+  { "lesdoto", { 0x2A81, 0 }, FALSE },
+  { "lesdotor", { 0x2A83, 0 }, FALSE },
+  { "lesg", { 0x22DA, 0xFE00 }, FALSE },
+  { "lesges", { 0x2A93, 0 }, FALSE },
+  { "lessapprox", { 0x2A85, 0 }, FALSE },
+  { "lessdot", { 0x22D6, 0 }, FALSE },
+  { "lesseqgtr", { 0x22DA, 0 }, FALSE },
+  { "lesseqqgtr", { 0x2A8B, 0 }, FALSE },
+  { "lessgtr", { 0x2276, 0 }, FALSE },
+  { "lesssim", { 0x2272, 0 }, FALSE },
+  { "lfisht", { 0x297C, 0 }, FALSE },
+  { "lfloor", { 0x230A, 0 }, FALSE },
+  { "lfr", { 0x1D529, 0 }, FALSE },
+  { "lg", { 0x2276, 0 }, FALSE },
+  { "lgE", { 0x2A91, 0 }, FALSE },
+  { "lhard", { 0x21BD, 0 }, FALSE },
+  { "lharu", { 0x21BC, 0 }, FALSE },
+  { "lharul", { 0x296A, 0 }, FALSE },
+  { "lhblk", { 0x2584, 0 }, FALSE },
+  { "ljcy", { 0x459, 0 }, FALSE },
+  { "ll", { 0x226A, 0 }, FALSE },
+  { "llarr", { 0x21C7, 0 }, FALSE },
+  { "llcorner", { 0x231E, 0 }, FALSE },
+  { "llhard", { 0x296B, 0 }, FALSE },
+  { "lltri", { 0x25FA, 0 }, FALSE },
+  { "lmidot", { 0x140, 0 }, FALSE },
+  { "lmoust", { 0x23B0, 0 }, FALSE },
+  { "lmoustache", { 0x23B0, 0 }, FALSE },
+  { "lnE", { 0x2268, 0 }, FALSE },
+  { "lnap", { 0x2A89, 0 }, FALSE },
+  { "lnapprox", { 0x2A89, 0 }, FALSE },
+  { "lne", { 0x2A87, 0 }, FALSE },
+  { "lneq", { 0x2A87, 0 }, FALSE },
+  { "lneqq", { 0x2268, 0 }, FALSE },
+  { "lnsim", { 0x22E6, 0 }, FALSE },
+  { "loang", { 0x27EC, 0 }, FALSE },
+  { "loarr", { 0x21FD, 0 }, FALSE },
+  { "lobrk", { 0x27E6, 0 }, FALSE },
+  { "longleftarrow", { 0x27F5, 0 }, FALSE },
+  { "longleftrightarrow", { 0x27F7, 0 }, FALSE },
+  { "longmapsto", { 0x27FC, 0 }, FALSE },
+  { "longrightarrow", { 0x27F6, 0 }, FALSE },
+  { "looparrowleft", { 0x21AB, 0 }, FALSE },
+  { "looparrowright", { 0x21AC, 0 }, FALSE },
+  { "lopar", { 0x2985, 0 }, FALSE },
+  { "lopf", { 0x1D55D, 0 }, FALSE },
+  { "loplus", { 0x2A2D, 0 }, FALSE },
+  { "lotimes", { 0x2A34, 0 }, FALSE },
+  { "lowast", { 0x2217, 0 }, FALSE },
+  { "lowbar", { 0x5F, 0 }, FALSE },
+  { "loz", { 0x25CA, 0 }, FALSE },
+  { "lozenge", { 0x25CA, 0 }, FALSE },
+  { "lozf", { 0x29EB, 0 }, FALSE },
+  { "lpar", { 0x28, 0 }, FALSE },
+  { "lparlt", { 0x2993, 0 }, FALSE },
+  { "lrarr", { 0x21C6, 0 }, FALSE },
+  { "lrcorner", { 0x231F, 0 }, FALSE },
+  { "lrhar", { 0x21CB, 0 }, FALSE },
+  { "lrhard", { 0x296D, 0 }, FALSE },
+  { "lrm", { 0x200E, 0 }, FALSE },
+  { "lrtri", { 0x22BF, 0 }, FALSE },
+  { "lsaquo", { 0x2039, 0 }, FALSE },
+  { "lscr", { 0x1D4C1, 0 }, FALSE },
+  { "lsh", { 0x21B0, 0 }, FALSE },
+  { "lsim", { 0x2272, 0 }, FALSE },
+  { "lsime", { 0x2A8D, 0 }, FALSE },
+  { "lsimg", { 0x2A8F, 0 }, FALSE },
+  { "lsqb", { 0x5B, 0 }, FALSE },
+  { "lsquo", { 0x2018, 0 }, FALSE },
+  { "lsquor", { 0x201A, 0 }, FALSE },
+  { "lstrok", { 0x142, 0 }, FALSE },
+  { "lt", { 0x3C, 0 }, TRUE },
+  { "ltcc", { 0x2AA6, 0 }, FALSE },
+  { "ltcir", { 0x2A79, 0 }, FALSE },
+  { "ltdot", { 0x22D6, 0 }, FALSE },
+  { "lthree", { 0x22CB, 0 }, FALSE },
+  { "ltimes", { 0x22C9, 0 }, FALSE },
+  { "ltlarr", { 0x2976, 0 }, FALSE },
+  { "ltquest", { 0x2A7B, 0 }, FALSE },
+  { "ltrPar", { 0x2996, 0 }, FALSE },
+  { "ltri", { 0x25C3, 0 }, FALSE },
+  { "ltrie", { 0x22B4, 0 }, FALSE },
+  { "ltrif", { 0x25C2, 0 }, FALSE },
+  { "lurdshar", { 0x294A, 0 }, FALSE },
+  { "luruhar", { 0x2966, 0 }, FALSE },
+  { "lvertneqq", { 0x2268, 0xFE00 }, FALSE },
+  { "lvnE", { 0x2268, 0xFE00 }, FALSE },
+  { "mDDot", { 0x223A, 0 }, FALSE },
+  { "macr", { 0xAF, 0 }, TRUE },
+  { "male", { 0x2642, 0 }, FALSE },
+  { "malt", { 0x2720, 0 }, FALSE },
+  { "maltese", { 0x2720, 0 }, FALSE },
+  { "map", { 0x21A6, 0 }, FALSE },
+  { "mapsto", { 0x21A6, 0 }, FALSE },
+  { "mapstodown", { 0x21A7, 0 }, FALSE },
+  { "mapstoleft", { 0x21A4, 0 }, FALSE },
+  { "mapstoup", { 0x21A5, 0 }, FALSE },
+  { "marker", { 0x25AE, 0 }, FALSE },
+  { "mcomma", { 0x2A29, 0 }, FALSE },
+  { "mcy", { 0x43C, 0 }, FALSE },
+  { "mdash", { 0x2014, 0 }, FALSE },
+  { "measuredangle", { 0x2221, 0 }, FALSE },
+  { "mfr", { 0x1D52A, 0 }, FALSE },
+  { "mho", { 0x2127, 0 }, FALSE },
+  { "micro", { 0xB5, 0 }, TRUE },
+  { "mid", { 0x2223, 0 }, FALSE },
+  { "midast", { 0x2A, 0 }, FALSE },
+  { "midcir", { 0x2AF0, 0 }, FALSE },
+  { "middot", { 0xB7, 0 }, TRUE },
+  { "minus", { 0x2212, 0 }, FALSE },
+  { "minusb", { 0x229F, 0 }, FALSE },
+  { "minusd", { 0x2238, 0 }, FALSE },
+  { "minusdu", { 0x2A2A, 0 }, FALSE },
+  { "mlcp", { 0x2ADB, 0 }, FALSE },
+  { "mldr", { 0x2026, 0 }, FALSE },
+  { "mnplus", { 0x2213, 0 }, FALSE },
+  { "models", { 0x22A7, 0 }, FALSE },
+  { "mopf", { 0x1D55E, 0 }, FALSE },
+  { "mp", { 0x2213, 0 }, FALSE },
+  { "mscr", { 0x1D4C2, 0 }, FALSE },
+  { "mstpos", { 0x223E, 0 }, FALSE },
+  { "mu", { 0x3BC, 0 }, FALSE },
+  { "multimap", { 0x22B8, 0 }, FALSE },
+  { "mumap", { 0x22B8, 0 }, FALSE },
+  { "nGg", { 0x22D9, 0x338 }, FALSE },
+  { "nGt", { 0x226B, 0x20D2 }, FALSE },
+  { "nGtv", { 0x226B, 0x338 }, FALSE },
+  { "nLeftarrow", { 0x21CD, 0 }, FALSE },
+  { "nLeftrightarrow", { 0x21CE, 0 }, FALSE },
+  { "nLl", { 0x22D8, 0x338 }, FALSE },
+  { "nLt", { 0x226A, 0x20D2 }, FALSE },
+  { "nLtv", { 0x226A, 0x338 }, FALSE },
+  { "nRightarrow", { 0x21CF, 0 }, FALSE },
+  { "nVDash", { 0x22AF, 0 }, FALSE },
+  { "nVdash", { 0x22AE, 0 }, FALSE },
+  { "nabla", { 0x2207, 0 }, FALSE },
+  { "nacute", { 0x144, 0 }, FALSE },
+  { "nang", { 0x2220, 0x20D2 }, FALSE },
+  { "nap", { 0x2249, 0 }, FALSE },
+  { "napE", { 0x2A70, 0x338 }, FALSE },
+  { "napid", { 0x224B, 0x338 }, FALSE },
+  { "napos", { 0x149, 0 }, FALSE },
+  { "napprox", { 0x2249, 0 }, FALSE },
+  { "natur", { 0x266E, 0 }, FALSE },
+  { "natural", { 0x266E, 0 }, FALSE },
+  { "naturals", { 0x2115, 0 }, FALSE },
+  { "nbsp", { 0xA0, 0 }, TRUE },
+  { "nbump", { 0x224E, 0x338 }, FALSE },
+  { "nbumpe", { 0x224F, 0x338 }, FALSE },
+  { "ncap", { 0x2A43, 0 }, FALSE },
+  { "ncaron", { 0x148, 0 }, FALSE },
+  { "ncedil", { 0x146, 0 }, FALSE },
+  { "ncong", { 0x2247, 0 }, FALSE },
+  { "ncongdot", { 0x2A6D, 0x338 }, FALSE },
+  { "ncup", { 0x2A42, 0 }, FALSE },
+  { "ncy", { 0x43D, 0 }, FALSE },
+  { "ndash", { 0x2013, 0 }, FALSE },
+  { "ne", { 0x2260, 0 }, FALSE },
+  { "neArr", { 0x21D7, 0 }, FALSE },
+  { "nearhk", { 0x2924, 0 }, FALSE },
+  { "nearr", { 0x2197, 0 }, FALSE },
+  { "nearrow", { 0x2197, 0 }, FALSE },
+  { "nedot", { 0x2250, 0x338 }, FALSE },
+  { "nequiv", { 0x2262, 0 }, FALSE },
+  { "nesear", { 0x2928, 0 }, FALSE },
+  { "nesim", { 0x2242, 0x338 }, FALSE },
+  { "nexist", { 0x2204, 0 }, FALSE },
+  { "nexists", { 0x2204, 0 }, FALSE },
+  { "nfr", { 0x1D52B, 0 }, FALSE },
+  { "ngE", { 0x2267, 0x338 }, FALSE },
+  { "nge", { 0x2271, 0 }, FALSE },
+  { "ngeq", { 0x2271, 0 }, FALSE },
+  { "ngeqq", { 0x2267, 0x338 }, FALSE },
+  { "ngeqslant", { 0x2A7E, 0x338 }, FALSE },
+  { "nges", { 0x2A7E, 0x338 }, FALSE },
+  { "ngsim", { 0x2275, 0 }, FALSE },
+  { "ngt", { 0x226F, 0 }, FALSE },
+  { "ngtr", { 0x226F, 0 }, FALSE },
+  { "nhArr", { 0x21CE, 0 }, FALSE },
+  { "nharr", { 0x21AE, 0 }, FALSE },
+  { "nhpar", { 0x2AF2, 0 }, FALSE },
+  { "ni", { 0x220B, 0 }, FALSE },
+  { "nis", { 0x22FC, 0 }, FALSE },
+  { "nisd", { 0x22FA, 0 }, FALSE },
+  { "niv", { 0x220B, 0 }, FALSE },
+  { "njcy", { 0x45A, 0 }, FALSE },
+  { "nlArr", { 0x21CD, 0 }, FALSE },
+  { "nlE", { 0x2266, 0x338 }, FALSE },
+  { "nlarr", { 0x219A, 0 }, FALSE },
+  { "nldr", { 0x2025, 0 }, FALSE },
+  { "nle", { 0x2270, 0 }, FALSE },
+  { "nleftarrow", { 0x219A, 0 }, FALSE },
+  { "nleftrightarrow", { 0x21AE, 0 }, FALSE },
+  { "nleq", { 0x2270, 0 }, FALSE },
+  { "nleqq", { 0x2266, 0x338 }, FALSE },
+  { "nleqslant", { 0x2A7D, 0x338 }, FALSE },
+  { "nles", { 0x2A7D, 0x338 }, FALSE },
+  { "nless", { 0x226E, 0 }, FALSE },
+  { "nlsim", { 0x2274, 0 }, FALSE },
+  { "nlt", { 0x226E, 0 }, FALSE },
+  { "nltri", { 0x22EA, 0 }, FALSE },
+  { "nltrie", { 0x22EC, 0 }, FALSE },
+  { "nmid", { 0x2224, 0 }, FALSE },
+  { "nopf", { 0x1D55F, 0 }, FALSE },
+  { "not", { 0xAC, 0 }, TRUE },
+  { "notin", { 0x2209, 0 }, FALSE },
+  { "notinE", { 0x22F9, 0x338 }, FALSE },
+  { "notindot", { 0x22F5, 0x338 }, FALSE },
+  { "notinva", { 0x2209, 0 }, FALSE },
+  { "notinvb", { 0x22F7, 0 }, FALSE },
+  { "notinvc", { 0x22F6, 0 }, FALSE },
+  { "notni", { 0x220C, 0 }, FALSE },
+  { "notniva", { 0x220C, 0 }, FALSE },
+  { "notnivb", { 0x22FE, 0 }, FALSE },
+  { "notnivc", { 0x22FD, 0 }, FALSE },
+  { "npar", { 0x2226, 0 }, FALSE },
+  { "nparallel", { 0x2226, 0 }, FALSE },
+  { "nparsl", { 0x2AFD, 0x20E5 }, FALSE },
+  { "npart", { 0x2202, 0x338 }, FALSE },
+  { "npolint", { 0x2A14, 0 }, FALSE },
+  { "npr", { 0x2280, 0 }, FALSE },
+  { "nprcue", { 0x22E0, 0 }, FALSE },
+  { "npre", { 0x2AAF, 0x338 }, FALSE },
+  { "nprec", { 0x2280, 0 }, FALSE },
+  { "npreceq", { 0x2AAF, 0x338 }, FALSE },
+  { "nrArr", { 0x21CF, 0 }, FALSE },
+  { "nrarr", { 0x219B, 0 }, FALSE },
+  { "nrarrc", { 0x2933, 0x338 }, FALSE },
+  { "nrarrw", { 0x219D, 0x338 }, FALSE },
+  { "nrightarrow", { 0x219B, 0 }, FALSE },
+  { "nrtri", { 0x22EB, 0 }, FALSE },
+  { "nrtrie", { 0x22ED, 0 }, FALSE },
+  { "nsc", { 0x2281, 0 }, FALSE },
+  { "nsccue", { 0x22E1, 0 }, FALSE },
+  { "nsce", { 0x2AB0, 0x338 }, FALSE },
+  { "nscr", { 0x1D4C3, 0 }, FALSE },
+  { "nshortmid", { 0x2224, 0 }, FALSE },
+  { "nshortparallel", { 0x2226, 0 }, FALSE },
+  { "nsim", { 0x2241, 0 }, FALSE },
+  { "nsime", { 0x2244, 0 }, FALSE },
+  { "nsimeq", { 0x2244, 0 }, FALSE },
+  { "nsmid", { 0x2224, 0 }, FALSE },
+  { "nspar", { 0x2226, 0 }, FALSE },
+  { "nsqsube", { 0x22E2, 0 }, FALSE },
+  { "nsqsupe", { 0x22E3, 0 }, FALSE },
+  { "nsub", { 0x2284, 0 }, FALSE },
+  { "nsubE", { 0x2AC5, 0x338 }, FALSE },
+  { "nsube", { 0x2288, 0 }, FALSE },
+  { "nsubset", { 0x2282, 0x20D2 }, FALSE },
+  { "nsubseteq", { 0x2288, 0 }, FALSE },
+  { "nsubseteqq", { 0x2AC5, 0x338 }, FALSE },
+  { "nsucc", { 0x2281, 0 }, FALSE },
+  { "nsucceq", { 0x2AB0, 0x338 }, FALSE },
+  { "nsup", { 0x2285, 0 }, FALSE },
+  { "nsupE", { 0x2AC6, 0x338 }, FALSE },
+  { "nsupe", { 0x2289, 0 }, FALSE },
+  { "nsupset", { 0x2283, 0x20D2 }, FALSE },
+  { "nsupseteq", { 0x2289, 0 }, FALSE },
+  { "nsupseteqq", { 0x2AC6, 0x338 }, FALSE },
+  { "ntgl", { 0x2279, 0 }, FALSE },
+  { "ntilde", { 0xF1, 0 }, TRUE },
+  { "ntlg", { 0x2278, 0 }, FALSE },
+  { "ntriangleleft", { 0x22EA, 0 }, FALSE },
+  { "ntrianglelefteq", { 0x22EC, 0 }, FALSE },
+  { "ntriangleright", { 0x22EB, 0 }, FALSE },
+  { "ntrianglerighteq", { 0x22ED, 0 }, FALSE },
+  { "nu", { 0x3BD, 0 }, FALSE },
+  { "num", { 0x23, 0 }, FALSE },
+  { "numero", { 0x2116, 0 }, FALSE },
+  { "numsp", { 0x2007, 0 }, FALSE },
+  { "nvDash", { 0x22AD, 0 }, FALSE },
+  { "nvHarr", { 0x2904, 0 }, FALSE },
+  { "nvap", { 0x224D, 0x20D2 }, FALSE },
+  { "nvdash", { 0x22AC, 0 }, FALSE },
+  { "nvge", { 0x2265, 0x20D2 }, FALSE },
+  { "nvgt", { 0x3E, 0x20D2 }, FALSE },
+  { "nvinfin", { 0x29DE, 0 }, FALSE },
+  { "nvlArr", { 0x2902, 0 }, FALSE },
+  { "nvle", { 0x2264, 0x20D2 }, FALSE },
+  { "nvlt", { 0x3C, 0x20D2 }, FALSE },
+  { "nvltrie", { 0x22B4, 0x20D2 }, FALSE },
+  { "nvrArr", { 0x2903, 0 }, FALSE },
+  { "nvrtrie", { 0x22B5, 0x20D2 }, FALSE },
+  { "nvsim", { 0x223C, 0x20D2 }, FALSE },
+  { "nwArr", { 0x21D6, 0 }, FALSE },
+  { "nwarhk", { 0x2923, 0 }, FALSE },
+  { "nwarr", { 0x2196, 0 }, FALSE },
+  { "nwarrow", { 0x2196, 0 }, FALSE },
+  { "nwnear", { 0x2927, 0 }, FALSE },
+  { "oS", { 0x24C8, 0 }, FALSE },
+  { "oacute", { 0xF3, 0 }, TRUE },
+  { "oast", { 0x229B, 0 }, FALSE },
+  { "ocir", { 0x229A, 0 }, FALSE },
+  { "ocirc", { 0xF4, 0 }, TRUE },
+  { "ocy", { 0x43E, 0 }, FALSE },
+  { "odash", { 0x229D, 0 }, FALSE },
+  { "odblac", { 0x151, 0 }, FALSE },
+  { "odiv", { 0x2A38, 0 }, FALSE },
+  { "odot", { 0x2299, 0 }, FALSE },
+  { "odsold", { 0x29BC, 0 }, FALSE },
+  { "oelig", { 0x153, 0 }, FALSE },
+  { "ofcir", { 0x29BF, 0 }, FALSE },
+  { "ofr", { 0x1D52C, 0 }, FALSE },
+  { "ogon", { 0x2DB, 0 }, FALSE },
+  { "ograve", { 0xF2, 0 }, TRUE },
+  { "ogt", { 0x29C1, 0 }, FALSE },
+  { "ohbar", { 0x29B5, 0 }, FALSE },
+  { "ohm", { 0x3A9, 0 }, FALSE },
+  { "oint", { 0x222E, 0 }, FALSE },
+  { "olarr", { 0x21BA, 0 }, FALSE },
+  { "olcir", { 0x29BE, 0 }, FALSE },
+  { "olcross", { 0x29BB, 0 }, FALSE },
+  { "oline", { 0x203E, 0 }, FALSE },
+  { "olt", { 0x29C0, 0 }, FALSE },
+  { "omacr", { 0x14D, 0 }, FALSE },
+  { "omega", { 0x3C9, 0 }, FALSE },
+  { "omicron", { 0x3BF, 0 }, FALSE },
+  { "omid", { 0x29B6, 0 }, FALSE },
+  { "ominus", { 0x2296, 0 }, FALSE },
+  { "oopf", { 0x1D560, 0 }, FALSE },
+  { "opar", { 0x29B7, 0 }, FALSE },
+  { "operp", { 0x29B9, 0 }, FALSE },
+  { "oplus", { 0x2295, 0 }, FALSE },
+  { "or", { 0x2228, 0 }, FALSE },
+  { "orarr", { 0x21BB, 0 }, FALSE },
+  { "ord", { 0x2A5D, 0 }, FALSE },
+  { "order", { 0x2134, 0 }, FALSE },
+  { "orderof", { 0x2134, 0 }, FALSE },
+  { "ordf", { 0xAA, 0 }, TRUE },
+  { "ordm", { 0xBA, 0 }, TRUE },
+  { "origof", { 0x22B6, 0 }, FALSE },
+  { "oror", { 0x2A56, 0 }, FALSE },
+  { "orslope", { 0x2A57, 0 }, FALSE },
+  { "orv", { 0x2A5B, 0 }, FALSE },
+  { "oscr", { 0x2134, 0 }, FALSE },
+  { "oslash", { 0xF8, 0 }, TRUE },
+  { "osol", { 0x2298, 0 }, FALSE },
+  { "otilde", { 0xF5, 0 }, TRUE },
+  { "otimes", { 0x2297, 0 }, FALSE },
+  { "otimesas", { 0x2A36, 0 }, FALSE },
+  { "ouml", { 0xF6, 0 }, TRUE },
+  { "ovbar", { 0x233D, 0 }, FALSE },
+  { "par", { 0x2225, 0 }, FALSE },
+  { "para", { 0xB6, 0 }, TRUE },
+  { "parallel", { 0x2225, 0 }, FALSE },
+  { "parsim", { 0x2AF3, 0 }, FALSE },
+  { "parsl", { 0x2AFD, 0 }, FALSE },
+  { "part", { 0x2202, 0 }, FALSE },
+  { "pcy", { 0x43F, 0 }, FALSE },
+  { "percnt", { 0x25, 0 }, FALSE },
+  { "period", { 0x2E, 0 }, FALSE },
+  { "permil", { 0x2030, 0 }, FALSE },
+  { "perp", { 0x22A5, 0 }, FALSE },
+  { "pertenk", { 0x2031, 0 }, FALSE },
+  { "pfr", { 0x1D52D, 0 }, FALSE },
+  { "phi", { 0x3C6, 0 }, FALSE },
+  { "phiv", { 0x3D5, 0 }, FALSE },
+  { "phmmat", { 0x2133, 0 }, FALSE },
+  { "phone", { 0x260E, 0 }, FALSE },
+  { "pi", { 0x3C0, 0 }, FALSE },
+  { "pitchfork", { 0x22D4, 0 }, FALSE },
+  { "piv", { 0x3D6, 0 }, FALSE },
+  { "planck", { 0x210F, 0 }, FALSE },
+  { "planckh", { 0x210E, 0 }, FALSE },
+  { "plankv", { 0x210F, 0 }, FALSE },
+  { "plus", { 0x2B, 0 }, FALSE },
+  { "plusacir", { 0x2A23, 0 }, FALSE },
+  { "plusb", { 0x229E, 0 }, FALSE },
+  { "pluscir", { 0x2A22, 0 }, FALSE },
+  { "plusdo", { 0x2214, 0 }, FALSE },
+  { "plusdu", { 0x2A25, 0 }, FALSE },
+  { "pluse", { 0x2A72, 0 }, FALSE },
+  { "plusmn", { 0xB1, 0 }, TRUE },
+  { "plussim", { 0x2A26, 0 }, FALSE },
+  { "plustwo", { 0x2A27, 0 }, FALSE },
+  { "pm", { 0xB1, 0 }, FALSE },
+  { "pointint", { 0x2A15, 0 }, FALSE },
+  { "popf", { 0x1D561, 0 }, FALSE },
+  { "pound", { 0xA3, 0 }, TRUE },
+  { "pr", { 0x227A, 0 }, FALSE },
+  { "prE", { 0x2AB3, 0 }, FALSE },
+  { "prap", { 0x2AB7, 0 }, FALSE },
+  { "prcue", { 0x227C, 0 }, FALSE },
+  { "pre", { 0x2AAF, 0 }, FALSE },
+  { "prec", { 0x227A, 0 }, FALSE },
+  { "precapprox", { 0x2AB7, 0 }, FALSE },
+  { "preccurlyeq", { 0x227C, 0 }, FALSE },
+  { "preceq", { 0x2AAF, 0 }, FALSE },
+  { "precnapprox", { 0x2AB9, 0 }, FALSE },
+  { "precneqq", { 0x2AB5, 0 }, FALSE },
+  { "precnsim", { 0x22E8, 0 }, FALSE },
+  { "precsim", { 0x227E, 0 }, FALSE },
+  { "prime", { 0x2032, 0 }, FALSE },
+  { "primes", { 0x2119, 0 }, FALSE },
+  { "prnE", { 0x2AB5, 0 }, FALSE },
+  { "prnap", { 0x2AB9, 0 }, FALSE },
+  { "prnsim", { 0x22E8, 0 }, FALSE },
+  { "prod", { 0x220F, 0 }, FALSE },
+  { "profalar", { 0x232E, 0 }, FALSE },
+  { "profline", { 0x2312, 0 }, FALSE },
+  { "profsurf", { 0x2313, 0 }, FALSE },
+  { "prop", { 0x221D, 0 }, FALSE },
+  { "propto", { 0x221D, 0 }, FALSE },
+  { "prsim", { 0x227E, 0 }, FALSE },
+  { "prurel", { 0x22B0, 0 }, FALSE },
+  { "pscr", { 0x1D4C5, 0 }, FALSE },
+  { "psi", { 0x3C8, 0 }, FALSE },
+  { "puncsp", { 0x2008, 0 }, FALSE },
+  { "qfr", { 0x1D52E, 0 }, FALSE },
+  { "qint", { 0x2A0C, 0 }, FALSE },
+  { "qopf", { 0x1D562, 0 }, FALSE },
+  { "qprime", { 0x2057, 0 }, FALSE },
+  { "qscr", { 0x1D4C6, 0 }, FALSE },
+  { "quaternions", { 0x210D, 0 }, FALSE },
+  { "quatint", { 0x2A16, 0 }, FALSE },
+  { "quest", { 0x3F, 0 }, FALSE },
+  { "questeq", { 0x225F, 0 }, FALSE },
+  { "quot", { 0x22, 0 }, TRUE },
+  { "rAarr", { 0x21DB, 0 }, FALSE },
+  { "rArr", { 0x21D2, 0 }, FALSE },
+  { "rAtail", { 0x291C, 0 }, FALSE },
+  { "rBarr", { 0x290F, 0 }, FALSE },
+  { "rHar", { 0x2964, 0 }, FALSE },
+  { "race", { 0x223D, 0x331 }, FALSE },
+  { "racute", { 0x155, 0 }, FALSE },
+  { "radic", { 0x221A, 0 }, FALSE },
+  { "raemptyv", { 0x29B3, 0 }, FALSE },
+  { "rang", { 0x27E9, 0 }, FALSE },
+  { "rangd", { 0x2992, 0 }, FALSE },
+  { "range", { 0x29A5, 0 }, FALSE },
+  { "rangle", { 0x27E9, 0 }, FALSE },
+  { "raquo", { 0xBB, 0 }, TRUE },
+  { "rarr", { 0x2192, 0 }, FALSE },
+  { "rarrap", { 0x2975, 0 }, FALSE },
+  { "rarrb", { 0x21E5, 0 }, FALSE },
+  { "rarrbfs", { 0x2920, 0 }, FALSE },
+  { "rarrc", { 0x2933, 0 }, FALSE },
+  { "rarrfs", { 0x291E, 0 }, FALSE },
+  { "rarrhk", { 0x21AA, 0 }, FALSE },
+  { "rarrlp", { 0x21AC, 0 }, FALSE },
+  { "rarrpl", { 0x2945, 0 }, FALSE },
+  { "rarrsim", { 0x2974, 0 }, FALSE },
+  { "rarrtl", { 0x21A3, 0 }, FALSE },
+  { "rarrw", { 0x219D, 0 }, FALSE },
+  { "ratail", { 0x291A, 0 }, FALSE },
+  { "ratio", { 0x2236, 0 }, FALSE },
+  { "rationals", { 0x211A, 0 }, FALSE },
+  { "rbarr", { 0x290D, 0 }, FALSE },
+  { "rbbrk", { 0x2773, 0 }, FALSE },
+  { "rbrace", { 0x7D, 0 }, FALSE },
+  { "rbrack", { 0x5D, 0 }, FALSE },
+  { "rbrke", { 0x298C, 0 }, FALSE },
+  { "rbrksld", { 0x298E, 0 }, FALSE },
+  { "rbrkslu", { 0x2990, 0 }, FALSE },
+  { "rcaron", { 0x159, 0 }, FALSE },
+  { "rcedil", { 0x157, 0 }, FALSE },
+  { "rceil", { 0x2309, 0 }, FALSE },
+  { "rcub", { 0x7D, 0 }, FALSE },
+  { "rcy", { 0x440, 0 }, FALSE },
+  { "rdca", { 0x2937, 0 }, FALSE },
+  { "rdldhar", { 0x2969, 0 }, FALSE },
+  { "rdquo", { 0x201D, 0 }, FALSE },
+  { "rdquor", { 0x201D, 0 }, FALSE },
+  { "rdsh", { 0x21B3, 0 }, FALSE },
+  { "real", { 0x211C, 0 }, FALSE },
+  { "realine", { 0x211B, 0 }, FALSE },
+  { "realpart", { 0x211C, 0 }, FALSE },
+  { "reals", { 0x211D, 0 }, FALSE },
+  { "rect", { 0x25AD, 0 }, FALSE },
+  { "reg", { 0xAE, 0 }, TRUE },
+  { "rfisht", { 0x297D, 0 }, FALSE },
+  { "rfloor", { 0x230B, 0 }, FALSE },
+  { "rfr", { 0x1D52F, 0 }, FALSE },
+  { "rhard", { 0x21C1, 0 }, FALSE },
+  { "rharu", { 0x21C0, 0 }, FALSE },
+  { "rharul", { 0x296C, 0 }, FALSE },
+  { "rho", { 0x3C1, 0 }, FALSE },
+  { "rhov", { 0x3F1, 0 }, FALSE },
+  { "rightarrow", { 0x2192, 0 }, FALSE },
+  { "rightarrowtail", { 0x21A3, 0 }, FALSE },
+  { "rightharpoondown", { 0x21C1, 0 }, FALSE },
+  { "rightharpoonup", { 0x21C0, 0 }, FALSE },
+  { "rightleftarrows", { 0x21C4, 0 }, FALSE },
+  { "rightleftharpoons", { 0x21CC, 0 }, FALSE },
+  { "rightrightarrows", { 0x21C9, 0 }, FALSE },
+  { "rightsquigarrow", { 0x219D, 0 }, FALSE },
+  { "rightthreetimes", { 0x22CC, 0 }, FALSE },
+  { "ring", { 0x2DA, 0 }, FALSE },
+  { "risingdotseq", { 0x2253, 0 }, FALSE },
+  { "rlarr", { 0x21C4, 0 }, FALSE },
+  { "rlhar", { 0x21CC, 0 }, FALSE },
+  { "rlm", { 0x200F, 0 }, FALSE },
+  { "rmoust", { 0x23B1, 0 }, FALSE },
+  { "rmoustache", { 0x23B1, 0 }, FALSE },
+  { "rnmid", { 0x2AEE, 0 }, FALSE },
+  { "roang", { 0x27ED, 0 }, FALSE },
+  { "roarr", { 0x21FE, 0 }, FALSE },
+  { "robrk", { 0x27E7, 0 }, FALSE },
+  { "ropar", { 0x2986, 0 }, FALSE },
+  { "ropf", { 0x1D563, 0 }, FALSE },
+  { "roplus", { 0x2A2E, 0 }, FALSE },
+  { "rotimes", { 0x2A35, 0 }, FALSE },
+  { "rpar", { 0x29, 0 }, FALSE },
+  { "rpargt", { 0x2994, 0 }, FALSE },
+  { "rppolint", { 0x2A12, 0 }, FALSE },
+  { "rrarr", { 0x21C9, 0 }, FALSE },
+  { "rsaquo", { 0x203A, 0 }, FALSE },
+  { "rscr", { 0x1D4C7, 0 }, FALSE },
+  { "rsh", { 0x21B1, 0 }, FALSE },
+  { "rsqb", { 0x5D, 0 }, FALSE },
+  { "rsquo", { 0x2019, 0 }, FALSE },
+  { "rsquor", { 0x2019, 0 }, FALSE },
+  { "rthree", { 0x22CC, 0 }, FALSE },
+  { "rtimes", { 0x22CA, 0 }, FALSE },
+  { "rtri", { 0x25B9, 0 }, FALSE },
+  { "rtrie", { 0x22B5, 0 }, FALSE },
+  { "rtrif", { 0x25B8, 0 }, FALSE },
+  { "rtriltri", { 0x29CE, 0 }, FALSE },
+  { "ruluhar", { 0x2968, 0 }, FALSE },
+  { "rx", { 0x211E, 0 }, FALSE },
+  { "sacute", { 0x15B, 0 }, FALSE },
+  { "sbquo", { 0x201A, 0 }, FALSE },
+  { "sc", { 0x227B, 0 }, FALSE },
+  { "scE", { 0x2AB4, 0 }, FALSE },
+  { "scap", { 0x2AB8, 0 }, FALSE },
+  { "scaron", { 0x161, 0 }, FALSE },
+  { "sccue", { 0x227D, 0 }, FALSE },
+  { "sce", { 0x2AB0, 0 }, FALSE },
+  { "scedil", { 0x15F, 0 }, FALSE },
+  { "scirc", { 0x15D, 0 }, FALSE },
+  { "scnE", { 0x2AB6, 0 }, FALSE },
+  { "scnap", { 0x2ABA, 0 }, FALSE },
+  { "scnsim", { 0x22E9, 0 }, FALSE },
+  { "scpolint", { 0x2A13, 0 }, FALSE },
+  { "scsim", { 0x227F, 0 }, FALSE },
+  { "scy", { 0x441, 0 }, FALSE },
+  { "sdot", { 0x22C5, 0 }, FALSE },
+  { "sdotb", { 0x22A1, 0 }, FALSE },
+  { "sdote", { 0x2A66, 0 }, FALSE },
+  { "seArr", { 0x21D8, 0 }, FALSE },
+  { "searhk", { 0x2925, 0 }, FALSE },
+  { "searr", { 0x2198, 0 }, FALSE },
+  { "searrow", { 0x2198, 0 }, FALSE },
+  { "sect", { 0xA7, 0 }, TRUE },
+  { "semi", { 0x3B, 0 }, FALSE },
+  { "seswar", { 0x2929, 0 }, FALSE },
+  { "setminus", { 0x2216, 0 }, FALSE },
+  { "setmn", { 0x2216, 0 }, FALSE },
+  { "sext", { 0x2736, 0 }, FALSE },
+  { "sfr", { 0x1D530, 0 }, FALSE },
+  { "sfrown", { 0x2322, 0 }, FALSE },
+  { "sharp", { 0x266F, 0 }, FALSE },
+  { "shchcy", { 0x449, 0 }, FALSE },
+  { "shcy", { 0x448, 0 }, FALSE },
+  { "shortmid", { 0x2223, 0 }, FALSE },
+  { "shortparallel", { 0x2225, 0 }, FALSE },
+  { "shy", { 0xAD, 0 }, TRUE },
+  { "sigma", { 0x3C3, 0 }, FALSE },
+  { "sigmaf", { 0x3C2, 0 }, FALSE },
+  { "sigmav", { 0x3C2, 0 }, FALSE },
+  { "sim", { 0x223C, 0 }, FALSE },
+  { "simdot", { 0x2A6A, 0 }, FALSE },
+  { "sime", { 0x2243, 0 }, FALSE },
+  { "simeq", { 0x2243, 0 }, FALSE },
+  { "simg", { 0x2A9E, 0 }, FALSE },
+  { "simgE", { 0x2AA0, 0 }, FALSE },
+  { "siml", { 0x2A9D, 0 }, FALSE },
+  { "simlE", { 0x2A9F, 0 }, FALSE },
+  { "simne", { 0x2246, 0 }, FALSE },
+  { "simplus", { 0x2A24, 0 }, FALSE },
+  { "simrarr", { 0x2972, 0 }, FALSE },
+  { "slarr", { 0x2190, 0 }, FALSE },
+  { "smallsetminus", { 0x2216, 0 }, FALSE },
+  { "smashp", { 0x2A33, 0 }, FALSE },
+  { "smeparsl", { 0x29E4, 0 }, FALSE },
+  { "smid", { 0x2223, 0 }, FALSE },
+  { "smile", { 0x2323, 0 }, FALSE },
+  { "smt", { 0x2AAA, 0 }, FALSE },
+  { "smte", { 0x2AAC, 0 }, FALSE },
+  { "smtes", { 0x2AAC, 0xFE00 }, FALSE },
+  { "softcy", { 0x44C, 0 }, FALSE },
+  { "sol", { 0x2F, 0 }, FALSE },
+  { "solb", { 0x29C4, 0 }, FALSE },
+  { "solbar", { 0x233F, 0 }, FALSE },
+  { "sopf", { 0x1D564, 0 }, FALSE },
+  { "spades", { 0x2660, 0 }, FALSE },
+  { "spadesuit", { 0x2660, 0 }, FALSE },
+  { "spar", { 0x2225, 0 }, FALSE },
+  { "sqcap", { 0x2293, 0 }, FALSE },
+  { "sqcaps", { 0x2293, 0xFE00 }, FALSE },
+  { "sqcup", { 0x2294, 0 }, FALSE },
+  { "sqcups", { 0x2294, 0xFE00 }, FALSE },
+  { "sqsub", { 0x228F, 0 }, FALSE },
+  { "sqsube", { 0x2291, 0 }, FALSE },
+  { "sqsubset", { 0x228F, 0 }, FALSE },
+  { "sqsubseteq", { 0x2291, 0 }, FALSE },
+  { "sqsup", { 0x2290, 0 }, FALSE },
+  { "sqsupe", { 0x2292, 0 }, FALSE },
+  { "sqsupset", { 0x2290, 0 }, FALSE },
+  { "sqsupseteq", { 0x2292, 0 }, FALSE },
+  { "squ", { 0x25A1, 0 }, FALSE },
+  { "square", { 0x25A1, 0 }, FALSE },
+  { "squarf", { 0x25AA, 0 }, FALSE },
+  { "squf", { 0x25AA, 0 }, FALSE },
+  { "srarr", { 0x2192, 0 }, FALSE },
+  { "sscr", { 0x1D4C8, 0 }, FALSE },
+  { "ssetmn", { 0x2216, 0 }, FALSE },
+  { "ssmile", { 0x2323, 0 }, FALSE },
+  { "sstarf", { 0x22C6, 0 }, FALSE },
+  { "star", { 0x2606, 0 }, FALSE },
+  { "starf", { 0x2605, 0 }, FALSE },
+  { "straightepsilon", { 0x3F5, 0 }, FALSE },
+  { "straightphi", { 0x3D5, 0 }, FALSE },
+  { "strns", { 0xAF, 0 }, FALSE },
+  { "sub", { 0x2282, 0 }, FALSE },
+  { "subE", { 0x2AC5, 0 }, FALSE },
+  { "subdot", { 0x2ABD, 0 }, FALSE },
+  { "sube", { 0x2286, 0 }, FALSE },
+  { "subedot", { 0x2AC3, 0 }, FALSE },
+  { "submult", { 0x2AC1, 0 }, FALSE },
+  { "subnE", { 0x2ACB, 0 }, FALSE },
+  { "subne", { 0x228A, 0 }, FALSE },
+  { "subplus", { 0x2ABF, 0 }, FALSE },
+  { "subrarr", { 0x2979, 0 }, FALSE },
+  { "subset", { 0x2282, 0 }, FALSE },
+  { "subseteq", { 0x2286, 0 }, FALSE },
+  { "subseteqq", { 0x2AC5, 0 }, FALSE },
+  { "subsetneq", { 0x228A, 0 }, FALSE },
+  { "subsetneqq", { 0x2ACB, 0 }, FALSE },
+  { "subsim", { 0x2AC7, 0 }, FALSE },
+  { "subsub", { 0x2AD5, 0 }, FALSE },
+  { "subsup", { 0x2AD3, 0 }, FALSE },
+  { "succ", { 0x227B, 0 }, FALSE },
+  { "succapprox", { 0x2AB8, 0 }, FALSE },
+  { "succcurlyeq", { 0x227D, 0 }, FALSE },
+  { "succeq", { 0x2AB0, 0 }, FALSE },
+  { "succnapprox", { 0x2ABA, 0 }, FALSE },
+  { "succneqq", { 0x2AB6, 0 }, FALSE },
+  { "succnsim", { 0x22E9, 0 }, FALSE },
+  { "succsim", { 0x227F, 0 }, FALSE },
+  { "sum", { 0x2211, 0 }, FALSE },
+  { "sung", { 0x266A, 0 }, FALSE },
+  { "sup", { 0x2283, 0 }, FALSE },
+  { "sup1", { 0xB9, 0 }, TRUE },
+  { "sup2", { 0xB2, 0 }, TRUE },
+  { "sup3", { 0xB3, 0 }, TRUE },
+  { "supE", { 0x2AC6, 0 }, FALSE },
+  { "supdot", { 0x2ABE, 0 }, FALSE },
+  { "supdsub", { 0x2AD8, 0 }, FALSE },
+  { "supe", { 0x2287, 0 }, FALSE },
+  { "supedot", { 0x2AC4, 0 }, FALSE },
+  { "suphsol", { 0x27C9, 0 }, FALSE },
+  { "suphsub", { 0x2AD7, 0 }, FALSE },
+  { "suplarr", { 0x297B, 0 }, FALSE },
+  { "supmult", { 0x2AC2, 0 }, FALSE },
+  { "supnE", { 0x2ACC, 0 }, FALSE },
+  { "supne", { 0x228B, 0 }, FALSE },
+  { "supplus", { 0x2AC0, 0 }, FALSE },
+  { "supset", { 0x2283, 0 }, FALSE },
+  { "supseteq", { 0x2287, 0 }, FALSE },
+  { "supseteqq", { 0x2AC6, 0 }, FALSE },
+  { "supsetneq", { 0x228B, 0 }, FALSE },
+  { "supsetneqq", { 0x2ACC, 0 }, FALSE },
+  { "supsim", { 0x2AC8, 0 }, FALSE },
+  { "supsub", { 0x2AD4, 0 }, FALSE },
+  { "supsup", { 0x2AD6, 0 }, FALSE },
+  { "swArr", { 0x21D9, 0 }, FALSE },
+  { "swarhk", { 0x2926, 0 }, FALSE },
+  { "swarr", { 0x2199, 0 }, FALSE },
+  { "swarrow", { 0x2199, 0 }, FALSE },
+  { "swnwar", { 0x292A, 0 }, FALSE },
+  { "szlig", { 0xDF, 0 }, TRUE },
+  { "target", { 0x2316, 0 }, FALSE },
+  { "tau", { 0x3C4, 0 }, FALSE },
+  { "tbrk", { 0x23B4, 0 }, FALSE },
+  { "tcaron", { 0x165, 0 }, FALSE },
+  { "tcedil", { 0x163, 0 }, FALSE },
+  { "tcy", { 0x442, 0 }, FALSE },
+  { "tdot", { 0x20DB, 0 }, FALSE },
+  { "telrec", { 0x2315, 0 }, FALSE },
+  { "tfr", { 0x1D531, 0 }, FALSE },
+  { "there4", { 0x2234, 0 }, FALSE },
+  { "therefore", { 0x2234, 0 }, FALSE },
+  { "theta", { 0x3B8, 0 }, FALSE },
+  { "thetasym", { 0x3D1, 0 }, FALSE },
+  { "thetav", { 0x3D1, 0 }, FALSE },
+  { "thickapprox", { 0x2248, 0 }, FALSE },
+  { "thicksim", { 0x223C, 0 }, FALSE },
+  { "thinsp", { 0x2009, 0 }, FALSE },
+  { "thkap", { 0x2248, 0 }, FALSE },
+  { "thksim", { 0x223C, 0 }, FALSE },
+  { "thorn", { 0xFE, 0 }, TRUE },
+  { "tilde", { 0x2DC, 0 }, FALSE },
+  { "times", { 0xD7, 0 }, TRUE },
+  { "timesb", { 0x22A0, 0 }, FALSE },
+  { "timesbar", { 0x2A31, 0 }, FALSE },
+  { "timesd", { 0x2A30, 0 }, FALSE },
+  { "tint", { 0x222D, 0 }, FALSE },
+  { "toea", { 0x2928, 0 }, FALSE },
+  { "top", { 0x22A4, 0 }, FALSE },
+  { "topbot", { 0x2336, 0 }, FALSE },
+  { "topcir", { 0x2AF1, 0 }, FALSE },
+  { "topf", { 0x1D565, 0 }, FALSE },
+  { "topfork", { 0x2ADA, 0 }, FALSE },
+  { "tosa", { 0x2929, 0 }, FALSE },
+  { "tprime", { 0x2034, 0 }, FALSE },
+  { "trade", { 0x2122, 0 }, FALSE },
+  { "triangle", { 0x25B5, 0 }, FALSE },
+  { "triangledown", { 0x25BF, 0 }, FALSE },
+  { "triangleleft", { 0x25C3, 0 }, FALSE },
+  { "trianglelefteq", { 0x22B4, 0 }, FALSE },
+  { "triangleq", { 0x225C, 0 }, FALSE },
+  { "triangleright", { 0x25B9, 0 }, FALSE },
+  { "trianglerighteq", { 0x22B5, 0 }, FALSE },
+  { "tridot", { 0x25EC, 0 }, FALSE },
+  { "trie", { 0x225C, 0 }, FALSE },
+  { "triminus", { 0x2A3A, 0 }, FALSE },
+  { "triplus", { 0x2A39, 0 }, FALSE },
+  { "trisb", { 0x29CD, 0 }, FALSE },
+  { "tritime", { 0x2A3B, 0 }, FALSE },
+  { "trpezium", { 0x23E2, 0 }, FALSE },
+  { "tscr", { 0x1D4C9, 0 }, FALSE },
+  { "tscy", { 0x446, 0 }, FALSE },
+  { "tshcy", { 0x45B, 0 }, FALSE },
+  { "tstrok", { 0x167, 0 }, FALSE },
+  { "twixt", { 0x226C, 0 }, FALSE },
+  { "twoheadleftarrow", { 0x219E, 0 }, FALSE },
+  { "twoheadrightarrow", { 0x21A0, 0 }, FALSE },
+  { "uArr", { 0x21D1, 0 }, FALSE },
+  { "uHar", { 0x2963, 0 }, FALSE },
+  { "uacute", { 0xFA, 0 }, TRUE },
+  { "uarr", { 0x2191, 0 }, FALSE },
+  { "ubrcy", { 0x45E, 0 }, FALSE },
+  { "ubreve", { 0x16D, 0 }, FALSE },
+  { "ucirc", { 0xFB, 0 }, TRUE },
+  { "ucy", { 0x443, 0 }, FALSE },
+  { "udarr", { 0x21C5, 0 }, FALSE },
+  { "udblac", { 0x171, 0 }, FALSE },
+  { "udhar", { 0x296E, 0 }, FALSE },
+  { "ufisht", { 0x297E, 0 }, FALSE },
+  { "ufr", { 0x1D532, 0 }, FALSE },
+  { "ugrave", { 0xF9, 0 }, TRUE },
+  { "uharl", { 0x21BF, 0 }, FALSE },
+  { "uharr", { 0x21BE, 0 }, FALSE },
+  { "uhblk", { 0x2580, 0 }, FALSE },
+  { "ulcorn", { 0x231C, 0 }, FALSE },
+  { "ulcorner", { 0x231C, 0 }, FALSE },
+  { "ulcrop", { 0x230F, 0 }, FALSE },
+  { "ultri", { 0x25F8, 0 }, FALSE },
+  { "umacr", { 0x16B, 0 }, FALSE },
+  { "uml", { 0xA8, 0 }, TRUE },
+  { "uogon", { 0x173, 0 }, FALSE },
+  { "uopf", { 0x1D566, 0 }, FALSE },
+  { "uparrow", { 0x2191, 0 }, FALSE },
+  { "updownarrow", { 0x2195, 0 }, FALSE },
+  { "upharpoonleft", { 0x21BF, 0 }, FALSE },
+  { "upharpoonright", { 0x21BE, 0 }, FALSE },
+  { "uplus", { 0x228E, 0 }, FALSE },
+  { "upsi", { 0x3C5, 0 }, FALSE },
+  { "upsih", { 0x3D2, 0 }, FALSE },
+  { "upsilon", { 0x3C5, 0 }, FALSE },
+  { "upuparrows", { 0x21C8, 0 }, FALSE },
+  { "urcorn", { 0x231D, 0 }, FALSE },
+  { "urcorner", { 0x231D, 0 }, FALSE },
+  { "urcrop", { 0x230E, 0 }, FALSE },
+  { "uring", { 0x16F, 0 }, FALSE },
+  { "urtri", { 0x25F9, 0 }, FALSE },
+  { "uscr", { 0x1D4CA, 0 }, FALSE },
+  { "utdot", { 0x22F0, 0 }, FALSE },
+  { "utilde", { 0x169, 0 }, FALSE },
+  { "utri", { 0x25B5, 0 }, FALSE },
+  { "utrif", { 0x25B4, 0 }, FALSE },
+  { "uuarr", { 0x21C8, 0 }, FALSE },
+  { "uuml", { 0xFC, 0 }, TRUE },
+  { "uwangle", { 0x29A7, 0 }, FALSE },
+  { "vArr", { 0x21D5, 0 }, FALSE },
+  { "vBar", { 0x2AE8, 0 }, FALSE },
+  { "vBarv", { 0x2AE9, 0 }, FALSE },
+  { "vDash", { 0x22A8, 0 }, FALSE },
+  { "vangrt", { 0x299C, 0 }, FALSE },
+  { "varepsilon", { 0x3F5, 0 }, FALSE },
+  { "varkappa", { 0x3F0, 0 }, FALSE },
+  { "varnothing", { 0x2205, 0 }, FALSE },
+  { "varphi", { 0x3D5, 0 }, FALSE },
+  { "varpi", { 0x3D6, 0 }, FALSE },
+  { "varpropto", { 0x221D, 0 }, FALSE },
+  { "varr", { 0x2195, 0 }, FALSE },
+  { "varrho", { 0x3F1, 0 }, FALSE },
+  { "varsigma", { 0x3C2, 0 }, FALSE },
+  { "varsubsetneq", { 0x228A, 0xFE00 }, FALSE },
+  { "varsubsetneqq", { 0x2ACB, 0xFE00 }, FALSE },
+  { "varsupsetneq", { 0x228B, 0xFE00 }, FALSE },
+  { "varsupsetneqq", { 0x2ACC, 0xFE00 }, FALSE },
+  { "vartheta", { 0x3D1, 0 }, FALSE },
+  { "vartriangleleft", { 0x22B2, 0 }, FALSE },
+  { "vartriangleright", { 0x22B3, 0 }, FALSE },
+  { "vcy", { 0x432, 0 }, FALSE },
+  { "vdash", { 0x22A2, 0 }, FALSE },
+  { "vee", { 0x2228, 0 }, FALSE },
+  { "veebar", { 0x22BB, 0 }, FALSE },
+  { "veeeq", { 0x225A, 0 }, FALSE },
+  { "vellip", { 0x22EE, 0 }, FALSE },
+  { "verbar", { 0x7C, 0 }, FALSE },
+  { "vert", { 0x7C, 0 }, FALSE },
+  { "vfr", { 0x1D533, 0 }, FALSE },
+  { "vltri", { 0x22B2, 0 }, FALSE },
+  { "vnsub", { 0x2282, 0x20D2 }, FALSE },
+  { "vnsup", { 0x2283, 0x20D2 }, FALSE },
+  { "vopf", { 0x1D567, 0 }, FALSE },
+  { "vprop", { 0x221D, 0 }, FALSE },
+  { "vrtri", { 0x22B3, 0 }, FALSE },
+  { "vscr", { 0x1D4CB, 0 }, FALSE },
+  { "vsubnE", { 0x2ACB, 0xFE00 }, FALSE },
+  { "vsubne", { 0x228A, 0xFE00 }, FALSE },
+  { "vsupnE", { 0x2ACC, 0xFE00 }, FALSE },
+  { "vsupne", { 0x228B, 0xFE00 }, FALSE },
+  { "vzigzag", { 0x299A, 0 }, FALSE },
+  { "wcirc", { 0x175, 0 }, FALSE },
+  { "wedbar", { 0x2A5F, 0 }, FALSE },
+  { "wedge", { 0x2227, 0 }, FALSE },
+  { "wedgeq", { 0x2259, 0 }, FALSE },
+  { "weierp", { 0x2118, 0 }, FALSE },
+  { "wfr", { 0x1D534, 0 }, FALSE },
+  { "wopf", { 0x1D568, 0 }, FALSE },
+  { "wp", { 0x2118, 0 }, FALSE },
+  { "wr", { 0x2240, 0 }, FALSE },
+  { "wreath", { 0x2240, 0 }, FALSE },
+  { "wscr", { 0x1D4CC, 0 }, FALSE },
+  { "xcap", { 0x22C2, 0 }, FALSE },
+  { "xcirc", { 0x25EF, 0 }, FALSE },
+  { "xcup", { 0x22C3, 0 }, FALSE },
+  { "xdtri", { 0x25BD, 0 }, FALSE },
+  { "xfr", { 0x1D535, 0 }, FALSE },
+  { "xhArr", { 0x27FA, 0 }, FALSE },
+  { "xharr", { 0x27F7, 0 }, FALSE },
+  { "xi", { 0x3BE, 0 }, FALSE },
+  { "xlArr", { 0x27F8, 0 }, FALSE },
+  { "xlarr", { 0x27F5, 0 }, FALSE },
+  { "xmap", { 0x27FC, 0 }, FALSE },
+  { "xnis", { 0x22FB, 0 }, FALSE },
+  { "xodot", { 0x2A00, 0 }, FALSE },
+  { "xopf", { 0x1D569, 0 }, FALSE },
+  { "xoplus", { 0x2A01, 0 }, FALSE },
+  { "xotime", { 0x2A02, 0 }, FALSE },
+  { "xrArr", { 0x27F9, 0 }, FALSE },
+  { "xrarr", { 0x27F6, 0 }, FALSE },
+  { "xscr", { 0x1D4CD, 0 }, FALSE },
+  { "xsqcup", { 0x2A06, 0 }, FALSE },
+  { "xuplus", { 0x2A04, 0 }, FALSE },
+  { "xutri", { 0x25B3, 0 }, FALSE },
+  { "xvee", { 0x22C1, 0 }, FALSE },
+  { "xwedge", { 0x22C0, 0 }, FALSE },
+  { "yacute", { 0xFD, 0 }, TRUE },
+  { "yacy", { 0x44F, 0 }, FALSE },
+  { "ycirc", { 0x177, 0 }, FALSE },
+  { "ycy", { 0x44B, 0 }, FALSE },
+  { "yen", { 0xA5, 0 }, TRUE },
+  { "yfr", { 0x1D536, 0 }, FALSE },
+  { "yicy", { 0x457, 0 }, FALSE },
+  { "yopf", { 0x1D56A, 0 }, FALSE },
+  { "yscr", { 0x1D4CE, 0 }, FALSE },
+  { "yucy", { 0x44E, 0 }, FALSE },
+  { "yuml", { 0xFF, 0 }, TRUE },
+  { "zacute", { 0x17A, 0 }, FALSE },
+  { "zcaron", { 0x17E, 0 }, FALSE },
+  { "zcy", { 0x437, 0 }, FALSE },
+  { "zdot", { 0x17C, 0 }, FALSE },
+  { "zeetrf", { 0x2128, 0 }, FALSE },
+  { "zeta", { 0x3B6, 0 }, FALSE },
+  { "zfr", { 0x1D537, 0 }, FALSE },
+  { "zhcy", { 0x436, 0 }, FALSE },
+  { "zigrarr", { 0x21DD, 0 }, FALSE },
+  { "zopf", { 0x1D56B, 0 }, FALSE },
+  { "zscr", { 0x1D4CF, 0 }, FALSE },
+  { "zwj", { 0x200D, 0 }, FALSE },
+  { "zwnj", { 0x200C, 0 }, FALSE }
+};
@@ -1,11 +1,24 @@
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <gmime/gmime.h>
 #include <gumbo.h>
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
 #include "parson.h"
 #include "gmimex.h"
+#include "character_references.h"
 
 #define UTF8_CHARSET "UTF-8"
 #define RECURSION_LIMIT 30
@@ -15,6 +28,14 @@
 
 #define COLLECT_RAW_CONTENT 2
 
+#define RANGE_BUFFER_SIZE 65536
+#define BASE64_PROBE_SIZE 1024
+#define MBOX_FROM_LINE_MAX 1024
+#define BATCH_READ_SIZE 65536
+#define BATCH_QUEUE_DEPTH 64
+#define HEADER_READ_SIZE 8192
+#define ATTACHMENT_HTML_SCAN_SIZE (1024 * 1024)
+
 
 /*
  * Address
@@ -46,9 +67,10 @@ typedef GPtrArray AddressesList;
  *
  */
 typedef struct MessageBody {
-  gchar   *content_type;
-  GString *content;
-  guint   size;
+  gchar    *content_type;
+  GString  *content;
+  guint    size;
+  gboolean truncated;  // content was cut short by the memory budget or the HTML limits
 } MessageBody;
 
 
@@ -99,6 +121,7 @@ typedef struct MessageData {
   MessageBody            *text;
   MessageBody            *html;
   MessageAttachmentsList *attachments;
+  gboolean               truncated;
 } MessageData;
 
 
@@ -114,72 +137,35 @@ static gboolean gc_contains_c(const gchar *str, const gchar c) {
 }
 
 // The stripping functions from glib do not remove tabs, newlines etc.,
-// so we define our owns that remove all whitespace.
-static gchar *gc_lstrip(const gchar* text) {
-  GRegex *regex = g_regex_new ("\\A\\s+", 0, 0, NULL);
-  gchar *stripped = g_regex_replace_literal(regex, text, -1, 0, "", 0, NULL);
-  g_regex_unref(regex);
-  return stripped;
-}
-
-
-static gchar *gc_rstrip(const gchar* text) {
-  GRegex *regex = g_regex_new ("\\s+$", 0, 0, NULL);
-  gchar *stripped = g_regex_replace_literal(regex, text, -1, 0, "", 0, NULL);
-  g_regex_unref(regex);
-  return stripped;
-}
-
-
-static gchar *gc_strip(const gchar *text) {
-  gchar *lstripped = gc_lstrip(text);
-  gchar *stripped = gc_rstrip(lstripped);
-  g_free(lstripped);
-  return stripped;
+// so we define our owns that remove all whitespace. They work on spans
+// of the text, trimming pointers instead of copying.
+static const gchar *gc_strip_span(const gchar *text, gsize *length) {
+  const gchar *start = text;
+  const gchar *end = text + *length;
+
+  while (start < end && g_ascii_isspace(*start))
+    start++;
+  while (end > start && g_ascii_isspace(end[-1]))
+    end--;
+
+  *length = end - start;
+  return start;
 }
 
 
-static GString *gstr_strip(GString *text) {
-  gchar *stripped_str = gc_strip(text->str);
-  g_string_assign(text, stripped_str);
-  g_free(stripped_str);
-  return text;
-}
-
+// Strips whitespace in place from the text starting at the given offset.
+static GString *gstr_strip_from(GString *text, gsize start) {
+  gsize length = text->len - start;
+  const gchar *stripped = gc_strip_span(text->str + start, &length);
+  gsize skipped = stripped - (text->str + start);
 
-static GString *gstr_replace_all(GString *text, const gchar* old_str, const gchar *new_str) {
-  gchar *escaped_s1 = g_regex_escape_string (old_str, -1);
-  GRegex *regex = g_regex_new (escaped_s1, 0, 0, NULL);
-  gchar *new_string =  g_regex_replace_literal(regex, text->str, -1, 0, new_str, 0, NULL);
-  g_regex_unref(regex);
-  g_free(escaped_s1);
-  g_string_assign(text, new_string);
-  g_free(new_string);
+  g_string_truncate(text, start + skipped + length);
+  if (skipped)
+    g_string_erase(text, start, skipped);
   return text;
 }
 
 
-static GString *gstr_substitute_xml_entities_into_text(const gchar *text) {
-  GString *result = g_string_new(text);
-  gstr_replace_all(result, "&", "&amp;"); // replacing of & must come first
-  gstr_replace_all(result, "<", "&lt;");
-  gstr_replace_all(result, ">", "&gt;");
-  return result;
-}
-
-
-static GString *gstr_substitute_xml_entities_into_attributes(const gchar quote, const gchar *text) {
-  GString *result = gstr_substitute_xml_entities_into_text(text);
-  if (quote == '"') {
-    gstr_replace_all(result, "\"", "&quot;");
-  } else if (quote == '\'') {
-    gstr_replace_all(result, "'", "&apos;");
-  }
-  return result;
-}
-
-
-
 static Address *new_address(const gchar *address, const gchar *name) {
   g_return_val_if_fail(address != NULL, NULL);
 
@@ -236,6 +222,7 @@ static MessageBody *new_message_body(void) {
   mb->content_type = NULL;
   mb->content = NULL;
   mb->size = 0;
+  mb->truncated = FALSE;
   return mb;
 }
 
@@ -311,6 +298,7 @@ static MessageData *new_message_data(void) {
   mdata->text = NULL;
   mdata->html = NULL;
   mdata->attachments = NULL;
+  mdata->truncated = FALSE;
   return mdata;
 }
 
@@ -362,13 +350,788 @@ static void free_message_data(MessageData *mdata) {
 
 
 
+/*
+ * MemoryBudget
+ *
+ * Every request is given a budget of bytes, against which each stage that
+ * materializes content (collecting parts, sanitizing bodies, building the
+ * JSON) charges its copies. Once the budget runs out the stages stop
+ * collecting and flag their results as truncated instead of growing further.
+ * A NULL budget or a limit of 0 means no limit.
+ */
+typedef struct MemoryBudget {
+  gsize    limit;
+  gsize    used;
+  gboolean exhausted;
+} MemoryBudget;
+
+
+static MemoryBudget *new_memory_budget(gsize limit) {
+  MemoryBudget *budget = g_malloc(sizeof(MemoryBudget));
+  budget->limit = limit;
+  budget->used = 0;
+  budget->exhausted = FALSE;
+  return budget;
+}
+
+
+static void free_memory_budget(MemoryBudget *budget) {
+  g_return_if_fail(budget != NULL);
+  g_free(budget);
+}
+
+
+static gsize memory_budget_available(MemoryBudget *budget) {
+  if (!budget || !budget->limit)
+    return G_MAXSIZE;
+  return budget->limit - MIN(budget->used, budget->limit);
+}
+
+
+// Charges as much of the given bytes as the budget allows, returning the
+// amount charged; anything less than asked for exhausts the budget.
+static gsize memory_budget_reserve(MemoryBudget *budget, gsize bytes) {
+  gsize reserved = MIN(bytes, memory_budget_available(budget));
+  if (!budget)
+    return reserved;
+
+  budget->used += reserved;
+  if (reserved < bytes)
+    budget->exhausted = TRUE;
+  return reserved;
+}
+
+
+static void memory_budget_release(MemoryBudget *budget, gsize bytes) {
+  if (budget)
+    budget->used -= MIN(bytes, budget->used);
+}
+
+
+// Cuts the content down to at most the given length without splitting a
+// UTF-8 sequence.
+static void truncate_utf8(GString *content, gsize length) {
+  if (content->len <= length)
+    return;
+
+  while (length && ((guchar) content->str[length] & 0xc0) == 0x80)
+    length--;
+  g_string_truncate(content, length);
+}
+
+
+/*
+ * Fast decoding
+ *
+ * Base64 and quoted-printable are decoded with our own filter instead of
+ * GMime's basic filter. Base64 is translated 16 (SSSE3) or 32 (AVX2)
+ * characters at a time where the CPU supports it, falling back to a table
+ * driven scalar loop around line breaks, padding and on other CPUs. The
+ * quoted-printable decoder copies the runs between escape sequences as a
+ * whole. Both follow the semantics of GMime's own decoders, so the output
+ * does not change.
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define HAVE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+static const guchar base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Value of each base64 character, with '=' counting as 0 like in GMime, and
+// 0xff for everything that is skipped.
+static guchar base64_rank[256];
+
+// Value of each hex digit, 0xff for other characters.
+static guchar hex_rank[256];
+
+static gboolean codec_has_ssse3 = FALSE;
+static gboolean codec_has_avx2  = FALSE;
+
+
+// Fills the tables and detects the CPU features once, for the first
+// decoder, encoder or validator used.
+static void codec_init(void) {
+  static gsize initialized = 0;
+  guint i;
+
+  if (!g_once_init_enter(&initialized))
+    return;
+
+  memset(base64_rank, 0xff, sizeof(base64_rank));
+  for (i = 0; i < 64; i++)
+    base64_rank[base64_alphabet[i]] = i;
+  base64_rank['='] = 0;
+
+  memset(hex_rank, 0xff, sizeof(hex_rank));
+  for (i = 0; i < 10; i++)
+    hex_rank['0' + i] = i;
+  for (i = 0; i < 6; i++)
+    hex_rank['a' + i] = hex_rank['A' + i] = 10 + i;
+
+#ifdef HAVE_X86_SIMD
+  __builtin_cpu_init();
+  codec_has_ssse3 = __builtin_cpu_supports("ssse3");
+  codec_has_avx2  = __builtin_cpu_supports("avx2");
+#endif
+
+  g_once_init_leave(&initialized, 1);
+}
+
+
+#ifdef HAVE_X86_SIMD
+// Translates 16 base64 characters into their 6 bit values, returning FALSE if
+// any of them is not in the alphabet (W. Mula's pshufb lookup).
+__attribute__((target("ssse3")))
+static gboolean base64_decode_block_ssse3(const guchar *in, guchar *out) {
+  const __m128i lut_lo   = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi   = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i nibble   = _mm_set1_epi8(0x0f);
+
+  __m128i chars = _mm_loadu_si128((const __m128i *) in);
+  __m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(chars, 4), nibble);
+  __m128i lo_nibbles = _mm_and_si128(chars, nibble);
+  __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+  __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+
+  if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())))
+    return FALSE;
+
+  __m128i eq_slash = _mm_cmpeq_epi8(chars, _mm_set1_epi8('/'));
+  __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_slash, hi_nibbles));
+  __m128i values = _mm_add_epi8(chars, roll);
+
+  // Pack the 6 bit values of every 4 characters into 3 bytes
+  __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  merged = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+  // Writes 16 bytes of which 12 are output, the caller leaves room for it
+  _mm_storeu_si128((__m128i *) out, merged);
+  return TRUE;
+}
+
+
+__attribute__((target("avx2")))
+static gboolean base64_decode_block_avx2(const guchar *in, guchar *out) {
+  const __m256i lut_lo   = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+                                            0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                            0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i lut_hi   = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                            0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                            0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+                                            0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i nibble   = _mm256_set1_epi8(0x0f);
+
+  __m256i chars = _mm256_loadu_si256((const __m256i *) in);
+  __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(chars, 4), nibble);
+  __m256i lo_nibbles = _mm256_and_si256(chars, nibble);
+  __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+  __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+
+  if (_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256())))
+    return FALSE;
+
+  __m256i eq_slash = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/'));
+  __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_slash, hi_nibbles));
+  __m256i values = _mm256_add_epi8(chars, roll);
+
+  __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+  merged = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+  merged = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  // Both lanes hold 12 bytes, move them next to each other
+  merged = _mm256_permutevar8x32_epi32(merged, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+  // Writes 32 bytes of which 24 are output, the caller leaves room for it
+  _mm256_storeu_si256((__m256i *) out, merged);
+  return TRUE;
+}
+
+
+// Encodes 12 bytes into 16 base64 characters, reading 16 bytes of input.
+__attribute__((target("ssse3")))
+static void base64_encode_block_ssse3(const guchar *in, gchar *out) {
+  const __m128i shift_lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+
+  __m128i bytes = _mm_loadu_si128((const __m128i *) in);
+  bytes = _mm_shuffle_epi8(bytes, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+
+  // Split every 3 bytes into four 6 bit indices
+  __m128i t0 = _mm_and_si128(bytes, _mm_set1_epi32(0x0fc0fc00));
+  __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  __m128i t2 = _mm_and_si128(bytes, _mm_set1_epi32(0x003f03f0));
+  __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  __m128i indices = _mm_or_si128(t1, t3);
+
+  __m128i shifts = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  shifts = _mm_or_si128(shifts, _mm_and_si128(less, _mm_set1_epi8(13)));
+  shifts = _mm_shuffle_epi8(shift_lut, shifts);
+
+  _mm_storeu_si128((__m128i *) out, _mm_add_epi8(shifts, indices));
+}
+
+
+// Returns the offset of the first '=' within the data, or length if none.
+__attribute__((target("sse2")))
+static gsize qp_find_escape_sse2(const guchar *data, gsize length) {
+  const __m128i equals = _mm_set1_epi8('=');
+  gsize i = 0;
+
+  for (; i + 16 <= length; i += 16) {
+    __m128i chars = _mm_loadu_si128((const __m128i *) (data + i));
+    gint mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chars, equals));
+    if (mask)
+      return i + __builtin_ctz(mask);
+  }
+
+  for (; i < length; i++)
+    if (data[i] == '=')
+      return i;
+  return length;
+}
+#endif
+
+
+/*
+ * Decodes base64 the way GMime does: characters outside the alphabet are
+ * skipped, and every trailing '=' (up to two) drops one byte of output. The
+ * partial group is kept in saved/state between calls. The output buffer
+ * must have room for inlen / 4 * 3 + 32 bytes.
+ */
+static gsize base64_decode_step(const guchar *in, gsize inlen, guchar *out, gint *state, guint32 *saved) {
+  const guchar *inptr = in;
+  const guchar *inend = in + inlen;
+  guchar *outptr = out;
+  guint32 value = *saved;
+  gint count = *state;
+
+  while (inptr < inend) {
+#ifdef HAVE_X86_SIMD
+    // Whole blocks of the alphabet, which is most of every line
+    if (count == 0) {
+      if (codec_has_avx2) {
+        while (inptr + 32 <= inend && base64_decode_block_avx2(inptr, outptr)) {
+          inptr += 32;
+          outptr += 24;
+        }
+      }
+      if (codec_has_ssse3) {
+        while (inptr + 16 <= inend && base64_decode_block_ssse3(inptr, outptr)) {
+          inptr += 16;
+          outptr += 12;
+        }
+      }
+      if (inptr >= inend)
+        break;
+    }
+#endif
+
+    guchar c = base64_rank[*inptr++];
+    if (c == 0xff)
+      continue;
+
+    value = (value << 6) | c;
+    if (++count == 4) {
+      *outptr++ = (guchar) (value >> 16);
+      *outptr++ = (guchar) (value >> 8);
+      *outptr++ = (guchar) value;
+      count = 0;
+    }
+  }
+
+  *saved = value;
+  *state = count;
+
+  // Drop one byte of output for each trailing '=' (up to 2)
+  gint padding = 2;
+  while (inptr > in && padding) {
+    inptr--;
+    if (base64_rank[*inptr] != 0xff) {
+      if (*inptr == '=' && outptr > out)
+        outptr--;
+      padding--;
+    }
+  }
+
+  return outptr - out;
+}
+
+
+/*
+ * Decodes quoted-printable the way GMime does: "=XX" becomes the byte it
+ * encodes, "=\n" and "=\r\n" are soft line breaks, and any other sequence
+ * after '=' is kept as is. The state between calls is 0 (text), 1 (after
+ * '=') or 2 (after '=' and the character in saved). The output never grows
+ * beyond inlen + 2 bytes.
+ */
+static gsize qp_decode_step(const guchar *in, gsize inlen, guchar *out, gint *state, guint32 *saved) {
+  const guchar *inptr = in;
+  const guchar *inend = in + inlen;
+  guchar *outptr = out;
+
+  while (inptr < inend) {
+    if (*state == 0) {
+      gsize run;
+#ifdef HAVE_X86_SIMD
+      run = qp_find_escape_sse2(inptr, inend - inptr);
+#else
+      const guchar *escape = memchr(inptr, '=', inend - inptr);
+      run = escape ? (gsize) (escape - inptr) : (gsize) (inend - inptr);
+#endif
+      memcpy(outptr, inptr, run);
+      outptr += run;
+      inptr += run;
+      if (inptr < inend) {
+        inptr++;
+        *state = 1;
+      }
+    } else if (*state == 1) {
+      guchar c = *inptr++;
+      if (c == '\n') {
+        *state = 0;
+      } else {
+        *saved = c;
+        *state = 2;
+      }
+    } else {
+      guchar c = *inptr++;
+      guchar first = (guchar) *saved;
+      if (hex_rank[first] != 0xff && hex_rank[c] != 0xff) {
+        *outptr++ = (hex_rank[first] << 4) | hex_rank[c];
+      } else if (first == '\r' && c == '\n') {
+        // soft line break
+      } else {
+        *outptr++ = '=';
+        *outptr++ = first;
+        *outptr++ = c;
+      }
+      *state = 0;
+    }
+  }
+
+  return outptr - out;
+}
+
+
+/*
+ * Encodes data into base64 without line breaks, like g_base64_encode.
+ */
+static gchar *fast_base64_encode(const guchar *data, gsize length) {
+  gchar *out = g_malloc((length + 2) / 3 * 4 + 1);
+  gchar *outptr = out;
+  gsize i = 0;
+
+  codec_init();
+#ifdef HAVE_X86_SIMD
+  // Each block reads 16 bytes to encode 12 of them
+  if (codec_has_ssse3) {
+    for (; i + 16 <= length; i += 12) {
+      base64_encode_block_ssse3(data + i, outptr);
+      outptr += 16;
+    }
+  }
+#endif
+
+  for (; i + 3 <= length; i += 3) {
+    guint32 value = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+    *outptr++ = base64_alphabet[(value >> 18) & 0x3f];
+    *outptr++ = base64_alphabet[(value >> 12) & 0x3f];
+    *outptr++ = base64_alphabet[(value >> 6) & 0x3f];
+    *outptr++ = base64_alphabet[value & 0x3f];
+  }
+
+  if (i < length) {
+    guint32 value = data[i] << 16;
+    if (i + 1 < length)
+      value |= data[i + 1] << 8;
+    *outptr++ = base64_alphabet[(value >> 18) & 0x3f];
+    *outptr++ = base64_alphabet[(value >> 12) & 0x3f];
+    *outptr++ = (i + 1 < length) ? base64_alphabet[(value >> 6) & 0x3f] : '=';
+    *outptr++ = '=';
+  }
+
+  *outptr = '\0';
+  return out;
+}
+
+
+/*
+ * FastDecodeFilter
+ *
+ * A GMime filter running the decoders above, to be used in place of
+ * g_mime_filter_basic_new for base64 and quoted-printable.
+ */
+typedef struct FastDecodeFilter {
+  GMimeFilter parent_object;
+  GMimeContentEncoding encoding;
+  guint32 saved;
+  gint state;
+} FastDecodeFilter;
+
+typedef struct FastDecodeFilterClass {
+  GMimeFilterClass parent_class;
+} FastDecodeFilterClass;
+
+G_DEFINE_TYPE(FastDecodeFilter, fast_decode_filter, GMIME_TYPE_FILTER)
+
+
+static GMimeFilter *fast_decode_filter_new(GMimeContentEncoding encoding) {
+  FastDecodeFilter *decoder = g_object_new(fast_decode_filter_get_type(), NULL);
+  decoder->encoding = encoding;
+  return (GMimeFilter *) decoder;
+}
+
+
+static GMimeFilter *fast_decode_filter_copy(GMimeFilter *filter) {
+  return fast_decode_filter_new(((FastDecodeFilter *) filter)->encoding);
+}
+
+
+static void fast_decode_filter_filter(GMimeFilter *filter, char *inbuf, size_t inlen, size_t prespace,
+                                      char **outbuf, size_t *outlen, size_t *outprespace) {
+  FastDecodeFilter *decoder = (FastDecodeFilter *) filter;
+  gsize decoded;
+
+  if (decoder->encoding == GMIME_CONTENT_ENCODING_BASE64) {
+    g_mime_filter_set_size(filter, inlen / 4 * 3 + 32, FALSE);
+    decoded = base64_decode_step((const guchar *) inbuf, inlen, (guchar *) filter->outbuf, &decoder->state, &decoder->saved);
+  } else {
+    g_mime_filter_set_size(filter, inlen + 3, FALSE);
+    decoded = qp_decode_step((const guchar *) inbuf, inlen, (guchar *) filter->outbuf, &decoder->state, &decoder->saved);
+  }
+
+  *outbuf = filter->outbuf;
+  *outlen = decoded;
+  *outprespace = filter->outpre;
+}
+
+
+static void fast_decode_filter_reset(GMimeFilter *filter) {
+  FastDecodeFilter *decoder = (FastDecodeFilter *) filter;
+  decoder->saved = 0;
+  decoder->state = 0;
+}
+
+
+static void fast_decode_filter_class_init(FastDecodeFilterClass *klass) {
+  GMimeFilterClass *filter_class = GMIME_FILTER_CLASS(klass);
+
+  filter_class->copy = fast_decode_filter_copy;
+  filter_class->filter = fast_decode_filter_filter;
+  filter_class->complete = fast_decode_filter_filter;
+  filter_class->reset = fast_decode_filter_reset;
+
+  codec_init();
+}
+
+
+static void fast_decode_filter_init(FastDecodeFilter *decoder) {
+  decoder->encoding = GMIME_CONTENT_ENCODING_BASE64;
+  decoder->saved = 0;
+  decoder->state = 0;
+}
+
+
+#ifdef HAVE_X86_SIMD
+/*
+ * Validates UTF-8 16 bytes at a time (J. Keiser and D. Lemire, "Validating
+ * UTF-8 in less than one instruction per byte"): the high and low nibble of
+ * every byte and the high nibble of the next one are looked up in tables of
+ * error classes, and the lengths of the sequences are checked against the
+ * lead bytes two and three positions back. Blocks of ASCII are skipped.
+ */
+#define UTF8_TOO_SHORT  (1 << 0)
+#define UTF8_TOO_LONG   (1 << 1)
+#define UTF8_OVERLONG_3 (1 << 2)
+#define UTF8_TOO_LARGE  (1 << 3)
+#define UTF8_SURROGATE  (1 << 4)
+#define UTF8_OVERLONG_2 (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4 (1 << 6)
+#define UTF8_TWO_CONTS  (1 << 7)
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+__attribute__((target("ssse3")))
+static __m128i utf8_block_errors(__m128i input, __m128i previous) {
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  const __m128i lut_byte_1_high = _mm_setr_epi8(
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4);
+  const __m128i lut_byte_1_low = _mm_setr_epi8(
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    UTF8_CARRY,
+    UTF8_CARRY,
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000);
+  const __m128i lut_byte_2_high = _mm_setr_epi8(
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT);
+
+  __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+  __m128i byte_1_high = _mm_shuffle_epi8(lut_byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+  __m128i byte_1_low  = _mm_shuffle_epi8(lut_byte_1_low, _mm_and_si128(prev1, nibble));
+  __m128i byte_2_high = _mm_shuffle_epi8(lut_byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+  __m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+  // Third and fourth bytes of a sequence must be continuations, which the
+  // lookups above cannot see
+  __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+  __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+  __m128i is_third  = _mm_subs_epu8(prev2, _mm_set1_epi8((char) (0xe0 - 0x80)));
+  __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char) (0xf0 - 0x80)));
+  __m128i must_continue = _mm_and_si128(_mm_or_si128(is_third, is_fourth), _mm_set1_epi8((char) 0x80));
+
+  return _mm_xor_si128(must_continue, special);
+}
+
+
+__attribute__((target("ssse3")))
+static gboolean utf8_validate_ssse3(const guchar *data, gsize length) {
+  // Lead bytes in the last positions of a block that need more bytes
+  const __m128i incomplete_limits = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                  (char) (0xf0 - 1), (char) (0xe0 - 1), (char) (0xc0 - 1));
+  __m128i previous = _mm_setzero_si128();
+  __m128i incomplete = _mm_setzero_si128();
+  __m128i errors = _mm_setzero_si128();
+  guchar tail[16];
+  gsize i = 0;
+
+  while (i < length) {
+    __m128i input;
+    if (i + 16 <= length) {
+      input = _mm_loadu_si128((const __m128i *) (data + i));
+    } else {
+      memset(tail, 0, sizeof(tail));
+      memcpy(tail, data + i, length - i);
+      input = _mm_loadu_si128((const __m128i *) tail);
+    }
+    i += 16;
+
+    if (!_mm_movemask_epi8(input)) {
+      errors = _mm_or_si128(errors, incomplete);
+    } else {
+      errors = _mm_or_si128(errors, utf8_block_errors(input, previous));
+      incomplete = _mm_subs_epu8(input, incomplete_limits);
+    }
+    previous = input;
+  }
+
+  errors = _mm_or_si128(errors, incomplete);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) == 0xffff;
+}
+#endif
+
+
+/*
+ * Whether the data is valid UTF-8, which includes plain ASCII. Unlike
+ * g_utf8_validate, NUL bytes are accepted.
+ */
+static gboolean utf8_validate_fast(const guchar *data, gsize length) {
+  codec_init();
+#ifdef HAVE_X86_SIMD
+  if (codec_has_ssse3)
+    return utf8_validate_ssse3(data, length);
+#endif
+
+  const gchar *ptr = (const gchar *) data;
+  const gchar *end = ptr + length;
+  const gchar *stop;
+
+  while (!g_utf8_validate(ptr, end - ptr, &stop)) {
+    if (stop >= end || *stop != '\0')
+      return FALSE;
+    ptr = stop + 1;
+  }
+  return TRUE;
+}
+
+
+/*
+ * Charsets
+ *
+ * Text parts end up in UTF-8. Content that already is valid UTF-8 (which
+ * includes ASCII) is kept as is whatever its label claims, as most mail is
+ * ASCII or UTF-8 labelled as ISO-8859-1. Everything else is converted with
+ * a converter kept per charset for the life of the process, and invalid
+ * bytes are replaced with U+FFFD.
+ */
+#define UTF8_REPLACEMENT "\xef\xbf\xbd"
+
+// Converters by lowercase charset name, (GIConv) -1 for unknown charsets.
+static GHashTable *charset_converters = NULL;
+
+
+static gboolean charset_is_utf8(const gchar *charset) {
+  return !g_ascii_strcasecmp(charset, UTF8_CHARSET) || !g_ascii_strcasecmp(charset, "utf8") ||
+         !g_ascii_strcasecmp(charset, "us-ascii") || !g_ascii_strcasecmp(charset, "ascii");
+}
+
+
+// Charsets in which valid UTF-8 does not mean the same text, because they
+// encode in 7 bits (ISO-2022-JP, UTF-7, HZ) or are not ASCII based at all.
+static gboolean charset_is_ascii_compatible(const gchar *charset) {
+  static const gchar *incompatible[] = { "iso-2022", "utf-7", "utf-16", "utf-32", "ucs-2", "ucs-4", "hz", "ebcdic", "ibm0", "cp037" };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS(incompatible); i++)
+    if (!g_ascii_strncasecmp(charset, incompatible[i], strlen(incompatible[i])))
+      return FALSE;
+  return TRUE;
+}
+
+
+static GIConv charset_converter(const gchar *charset) {
+  if (!charset_converters)
+    charset_converters = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+  gchar *key = g_ascii_strdown(charset, -1);
+  gpointer converter;
+
+  if (g_hash_table_lookup_extended(charset_converters, key, NULL, &converter)) {
+    g_free(key);
+  } else {
+    converter = g_iconv_open(UTF8_CHARSET, g_mime_charset_iconv_name(charset));
+    g_hash_table_insert(charset_converters, key, converter);
+  }
+
+  return (GIConv) converter;
+}
+
+
+// Converts the text to UTF-8, returning NULL if the charset is unknown.
+static GByteArray *charset_convert(const GByteArray *text, const gchar *charset) {
+  GIConv converter = charset_converter(charset);
+  if (converter == (GIConv) -1)
+    return NULL;
+
+  GByteArray *converted = g_byte_array_sized_new(text->len + text->len / 2 + 16);
+  g_byte_array_set_size(converted, text->len + text->len / 2 + 16);
+
+  gchar *inbuf = (gchar *) text->data;
+  gsize inleft = text->len;
+  gsize used = 0;
+
+  while (inleft > 0) {
+    gchar *outbuf = (gchar *) converted->data + used;
+    gsize outleft = converted->len - used;
+    gsize result = g_iconv(converter, &inbuf, &inleft, &outbuf, &outleft);
+    used = converted->len - outleft;
+
+    if (result != (gsize) -1 || errno == E2BIG) {
+      if (inleft > 0)
+        g_byte_array_set_size(converted, converted->len * 2);
+    } else {
+      // An invalid or incomplete sequence, which we replace and skip
+      if (converted->len - used < sizeof(UTF8_REPLACEMENT))
+        g_byte_array_set_size(converted, converted->len * 2);
+      memcpy(converted->data + used, UTF8_REPLACEMENT, sizeof(UTF8_REPLACEMENT) - 1);
+      used += sizeof(UTF8_REPLACEMENT) - 1;
+      inbuf++;
+      inleft--;
+    }
+  }
+
+  // Leave the shared converter in its initial state for the next part
+  g_iconv(converter, NULL, NULL, NULL, NULL);
+
+  g_byte_array_set_size(converted, used);
+  return converted;
+}
+
+
+static GByteArray *utf8_make_valid(const GByteArray *text) {
+  GByteArray *valid = g_byte_array_sized_new(text->len + 16);
+  const gchar *ptr = (const gchar *) text->data;
+  const gchar *end = ptr + text->len;
+  const gchar *stop;
+
+  while (ptr < end) {
+    g_utf8_validate(ptr, end - ptr, &stop);
+    g_byte_array_append(valid, (const guint8 *) ptr, stop - ptr);
+    if (stop >= end)
+      break;
+
+    if (*stop == '\0')
+      g_byte_array_append(valid, (const guint8 *) stop, 1);
+    else
+      g_byte_array_append(valid, (const guint8 *) UTF8_REPLACEMENT, sizeof(UTF8_REPLACEMENT) - 1);
+    ptr = stop + 1;
+  }
+
+  return valid;
+}
+
+
+/*
+ * Returns the text in UTF-8, which is the given array itself when it needs
+ * no conversion; otherwise the given array is freed. The budget is charged
+ * with the difference in size.
+ */
+static GByteArray *text_to_utf8(GByteArray *text, const gchar *charset, MemoryBudget *budget) {
+  gboolean valid = utf8_validate_fast(text->data, text->len);
+  if (valid && (!charset || charset_is_ascii_compatible(charset)))
+    return text;
+
+  GByteArray *converted = NULL;
+  if (charset && !charset_is_utf8(charset))
+    converted = charset_convert(text, charset);
+  if (!converted) {
+    if (valid)
+      return text;
+    converted = utf8_make_valid(text);
+  }
+
+  if (converted->len > text->len)
+    memory_budget_reserve(budget, converted->len - text->len);
+  else
+    memory_budget_release(budget, text->len - converted->len);
+
+  g_byte_array_free(text, TRUE);
+  return converted;
+}
+
+
+
 /*
  * CollectedPart
  */
 typedef struct CollectedPart {
   guint      part_id;        // the depth within the message where this part is located
   gchar      *content_type;  // content type (text/html, text/plan etc.)
-  GByteArray *content;       // content data
+  GByteArray *content;       // content data, not kept for attachments
+  gsize      size;           // decoded size of the content, whether kept or not
+  gboolean   truncated;      // content was cut short by the memory budget
   gchar      *content_id;    // for inline content
   gchar      *filename;      // for attachments, inlines and body parts that define filename
   gchar      *disposition;   // for attachments and inlines
@@ -389,6 +1152,8 @@ static CollectedPart* new_collected_part(guint part_id) {
   part->part_id      = part_id;
   part->content_type = NULL;
   part->content      = NULL;
+  part->size         = 0;
+  part->truncated    = FALSE;
   part->content_id   = NULL;
   part->filename     = NULL;
   part->disposition  = NULL;
@@ -431,6 +1196,8 @@ static void free_collected_part(gpointer part) {
  */
 typedef struct PartCollectorData {
   gboolean      raw;
+  MemoryBudget  *budget;          // [transfer none]
+  const gchar   *inline_url;      // inlines are referenced by URL instead of embedded
   guint         recursion_depth;  // We keep track of explicit recursions, and limit them (RECURSION_LIMIT)
   guint         part_id;          // We keep track of the depth within message parts to identify parts later
   CollectedPart *html_part;
@@ -442,10 +1209,12 @@ typedef struct PartCollectorData {
 } PartCollectorData;
 
 
-static PartCollectorData* new_part_collector_data(guint content_option) {
+static PartCollectorData* new_part_collector_data(guint content_option, const GmimexOptions *options, MemoryBudget *budget) {
   PartCollectorData *pcd = g_malloc(sizeof(PartCollectorData));
 
   pcd->raw = (content_option == COLLECT_RAW_CONTENT);
+  pcd->budget = budget;
+  pcd->inline_url = options ? options->inline_url : NULL;
 
   pcd->recursion_depth = 0;
   pcd->part_id         = 0;
@@ -490,10 +1259,11 @@ static void free_part_collector_data(PartCollectorData *pcdata) {
  * message. The part_id argument is the part number we want extracted.
  */
 typedef struct PartExtractorData {
-  guint      recursion_depth;
-  guint      part_id;
-  gchar      *content_type;
-  GByteArray *content;
+  guint       recursion_depth;
+  guint       part_id;
+  GMimeObject *part;        // the located part, owned by the message [transfer none]
+  gchar       *content_type;
+  GByteArray  *content;
 } PartExtractorData;
 
 
@@ -501,6 +1271,7 @@ static PartExtractorData *new_part_extractor_data(guint part_id) {
   PartExtractorData *ped = g_malloc(sizeof(PartExtractorData));
   ped->recursion_depth = 0;
   ped->part_id = part_id;
+  ped->part = NULL;
   ped->content_type = NULL;
   ped->content = NULL;
   return ped;
@@ -529,803 +1300,4563 @@ static void free_part_extractor_data(PartExtractorData *ped, gboolean release_co
 static gchar* permitted_tags            = "|a|abbr|acronym|address|area|b|bdo|body|big|blockquote|br|button|caption|center|cite|code|col|colgroup|dd|del|dfn|dir|div|dl|dt|em|fieldset|font|form|h1|h2|h3|h4|h5|h6|hr|i|img|input|ins|kbd|label|legend|li|map|menu|ol|optgroup|option|p|pre|q|s|samp|select|small|span|strike|strong|sub|sup|table|tbody|td|textarea|tfoot|th|thead|u|tr|tt|u|ul|var|";
 static gchar* permitted_attributes      = "|href|src|action|style|color|bgcolor|width|height|colspan|rowspan|cellspacing|cellpadding|border|align|valign|dir|type|";
 static gchar* protocol_attributes       = "|href|src|action|";
-static gchar* protocol_separators_regex = ":|(&#0*58)|(&#x70)|(&#x0*3a)|(%|&#37;)3A";
 static gchar* permitted_protocols       = "||ftp|http|https|cid|data|irc|mailto|news|gopher|nntp|telnet|webcal|xmpp|callto|feed|";
 static gchar* empty_tags                = "|area|br|col|hr|img|input|";
 static gchar* special_handling          = "|html|body|";
-static gchar* no_entity_sub             = "|pre|";
+static gchar* no_entity_sub             = "|pre|textarea|";
 
-// Forward declaration
-static GString* sanitize(GumboNode* node, GPtrArray* inlines_ary);
+/*
+ * Sanitizer policy
+ *
+ * The lists above make up the built-in policy. They are compiled once into
+ * lookup tables: flags per GumboTag, and hash sets of attribute names and
+ * protocols. Tags unknown to Gumbo never have any flag set.
+ *
+ * More policies are read from a key file, named by the file given in the
+ * GMIMEX_SANITIZER_POLICIES environment variable when the port starts, or
+ * loaded later with gmimex_load_sanitizer_policies. Each group is a policy
+ * of the same name, with the lists above as ';' separated keys, and keys
+ * left out taken from the built-in policy. The "default" group replaces the
+ * built-in policy itself:
+ *
+ *   [mobile]
+ *   permitted_tags=a;b;br;div;i;li;ol;p;span;table;tbody;td;tr;u;ul
+ *   permitted_attributes=href;align
+ */
+#define TAG_PERMITTED          (1 << 0)
+#define TAG_EMPTY              (1 << 1)
+#define TAG_SPECIAL_HANDLING   (1 << 2)
+#define TAG_PREFORMATTED       (1 << 3)   // of no_entity_sub, text escaped but whitespace kept
 
+#define ATTRIBUTE_PERMITTED    (1 << 0)
+#define ATTRIBUTE_PROTOCOL     (1 << 1)
 
-static GString *handle_unknown_tag(GumboStringPiece *text) {
-  if (text->data == NULL)
-    return g_string_new(NULL);
+// Longest attribute or protocol name looked up, longer ones are never listed
+#define POLICY_NAME_SIZE 32
 
-  // work with copy GumboStringPiece to prevent asserts
-  // if try to read same unknown tag name more than once
-  GumboStringPiece gsp = *text;
-  gumbo_tag_from_original_text(&gsp);
-  return g_string_new_len(gsp.data, gsp.length);
-}
+#define DEFAULT_SANITIZER_POLICY "default"
+#define SANITIZER_POLICIES_ENV   "GMIMEX_SANITIZER_POLICIES"
 
+typedef struct {
+  guint8 tag_flags[GUMBO_TAG_LAST];
+  GHashTable *attributes;   // lowercase name -> ATTRIBUTE_* flags
+  GHashTable *protocols;    // lowercase protocol -> TRUE, "" included
+} SanitizerPolicy;
 
-static GString *get_tag_name(GumboNode *node) {
-  // work around lack of proper name for document node
-  if (node->type == GUMBO_NODE_DOCUMENT)
-    return g_string_new("document");
+// Policies by name, replaced as a whole when they are loaded again.
+static GHashTable *sanitizer_policies = NULL;
 
-  const gchar *n_tagname = gumbo_normalized_tagname(node->v.element.tag);
-  GString *tagname = g_string_new(n_tagname);
 
-  if (!tagname->len) {
-    g_string_free(tagname, TRUE);
-    return handle_unknown_tag(&node->v.element.original_tag);
+// Returns the list under the key of the group, else the built-in list.
+static gchar **policy_list(GKeyFile *key_file, const gchar *group, const gchar *key, const gchar *builtin) {
+  if (key_file && g_key_file_has_key(key_file, group, key, NULL)) {
+    gchar **names = g_key_file_get_string_list(key_file, group, key, NULL, NULL);
+    return names ? names : g_new0(gchar *, 1);
   }
 
-  return tagname;
+  // The built-in lists start and end with a separator
+  gchar *inner = g_strndup(builtin + 1, strlen(builtin) - 2);
+  gchar **names = g_strsplit(inner, "|", -1);
+  g_free(inner);
+  return names;
 }
 
 
-static GString *build_attributes(GumboNode* node, GumboAttribute *at, gboolean no_entities, GPtrArray *inlines_ary) {
-  gchar *key = g_strjoin(NULL, "|", at->name, "|", NULL);
-  gchar *key_pattern = g_regex_escape_string(key, -1);
-  g_free(key);
+static void policy_add_tags(SanitizerPolicy *policy, gchar **names, guint8 flag) {
+  gchar **name;
 
-  gboolean is_permitted_attribute = g_regex_match_simple(key_pattern, permitted_attributes, G_REGEX_CASELESS, 0);
-  gboolean is_protocol_attribute  = g_regex_match_simple(key_pattern, protocol_attributes, G_REGEX_CASELESS, 0);
-  gchar *cid_content_id = NULL;
+  for (name = names; *name; name++) {
+    GumboTag tag = **name ? gumbo_tag_enum(*name) : GUMBO_TAG_UNKNOWN;
+    if (tag != GUMBO_TAG_UNKNOWN)
+      policy->tag_flags[tag] |= flag;
+    else if (**name)
+      g_printerr("Unknown tag in sanitizer policy: %s\r\n", *name);
+  }
+  g_strfreev(names);
+}
 
-  g_free(key_pattern);
 
-  if (!is_permitted_attribute)
-    return g_string_new(NULL);
+static void policy_add_names(GHashTable *table, gchar **names, guint flag, gboolean keep_empty) {
+  gchar **name;
 
-  GString *attr_value = g_string_new(at->value);
-  gstr_strip(attr_value);
+  for (name = names; *name; name++) {
+    if (!**name && !keep_empty)
+      continue;
+    gchar *key = g_ascii_strdown(*name, -1);
+    guint flags = GPOINTER_TO_UINT(g_hash_table_lookup(table, key));
+    g_hash_table_insert(table, key, GUINT_TO_POINTER(flags | flag));
+  }
+  g_strfreev(names);
+}
 
-  if (is_protocol_attribute) {
-    gchar **protocol_parts = g_regex_split_simple(protocol_separators_regex, attr_value->str, G_REGEX_CASELESS, 0);
-    guint pparts_length = 0;
 
-    while (protocol_parts[pparts_length])
-      pparts_length++;
+static SanitizerPolicy *new_sanitizer_policy(GKeyFile *key_file, const gchar *group) {
+  SanitizerPolicy *policy = g_new0(SanitizerPolicy, 1);
 
-    gboolean is_permitted_protocol = FALSE;
+  policy_add_tags(policy, policy_list(key_file, group, "permitted_tags", permitted_tags), TAG_PERMITTED);
+  policy_add_tags(policy, policy_list(key_file, group, "empty_tags", empty_tags), TAG_EMPTY);
+  policy_add_tags(policy, policy_list(key_file, group, "special_handling", special_handling), TAG_SPECIAL_HANDLING);
+  policy_add_tags(policy, policy_list(key_file, group, "no_entity_sub", no_entity_sub), TAG_PREFORMATTED);
 
-    if (pparts_length) {
-      static gchar* protocol_join_str = ":";
-      gchar* new_joined = g_strjoinv(protocol_join_str, protocol_parts);
-      g_string_assign(attr_value, new_joined);
-      g_free(new_joined);
+  policy->attributes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  policy_add_names(policy->attributes, policy_list(key_file, group, "permitted_attributes", permitted_attributes),
+                   ATTRIBUTE_PERMITTED, FALSE);
+  policy_add_names(policy->attributes, policy_list(key_file, group, "protocol_attributes", protocol_attributes),
+                   ATTRIBUTE_PROTOCOL, FALSE);
 
-      gchar *attr_protocol = g_strjoin(NULL, "|", protocol_parts[0], "|", NULL);
-      gchar *attr_prot_pattern = g_regex_escape_string(attr_protocol, -1);
-      g_free(attr_protocol);
-      is_permitted_protocol = g_regex_match_simple(attr_prot_pattern, permitted_protocols, G_REGEX_CASELESS, 0);
-      g_free(attr_prot_pattern);
+  policy->protocols = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  policy_add_names(policy->protocols, policy_list(key_file, group, "permitted_protocols", permitted_protocols),
+                   TRUE, TRUE);
 
-      if (is_permitted_protocol && !g_ascii_strcasecmp(protocol_parts[0], "cid"))
-        cid_content_id = g_strdup(protocol_parts[1]);
-    }
-    g_strfreev(protocol_parts);
+  return policy;
+}
 
-    if (!is_permitted_protocol) {
-      g_string_free(attr_value, TRUE);
-      return g_string_new(NULL);
-    }
-  }
 
-  gboolean cid_replaced = FALSE;
-  if (cid_content_id) {
-    if (inlines_ary && inlines_ary->len) {
-      guint i;
-      for (i = 0; i < inlines_ary->len; i++) {
-        CollectedPart *inline_body = g_ptr_array_index(inlines_ary, i);
-        if (inline_body->content_id && !g_ascii_strcasecmp(inline_body->content_id, cid_content_id)) {
-          if (inline_body->content->len < MAX_CID_SIZE) {
-            gchar *base64_data = g_base64_encode((const guchar *) inline_body->content->data, inline_body->content->len);
-            gchar *new_attr_value = g_strjoin(NULL, "data:", inline_body->content_type, ";base64,", base64_data, NULL);
-            g_string_assign(attr_value, new_attr_value);
-            g_free(base64_data);
-            g_free(new_attr_value);
-            cid_replaced = TRUE;
-          }
-        }
-      }
-    }
+static void free_sanitizer_policy(gpointer policy_ptr) {
+  SanitizerPolicy *policy = (SanitizerPolicy *) policy_ptr;
+  g_hash_table_destroy(policy->attributes);
+  g_hash_table_destroy(policy->protocols);
+  g_free(policy);
+}
 
-    // `cid` is not a valid URI schema, so if it was not replaced by the inline content,
-    // we replace it with a 1x1 image which should hide it. If there is content and we missed
-    // it due to the wrong contentId given, it will be avaialable as a downloadable attachment.
-    if (!cid_replaced)
-      g_string_assign(attr_value, MIN_DATA_URI_IMAGE);
 
-    g_free(cid_content_id);
-  }
+// Compiles every group of the key file, if any, besides the default policy.
+static GHashTable *new_sanitizer_policies(GKeyFile *key_file) {
+  GHashTable *policies = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free_sanitizer_policy);
 
-  GString *atts = g_string_new(" ");
+  g_hash_table_insert(policies, g_strdup(DEFAULT_SANITIZER_POLICY),
+                      new_sanitizer_policy(key_file, DEFAULT_SANITIZER_POLICY));
 
-  if (node->type == GUMBO_NODE_ELEMENT)
-    if (((node->v.element.tag == GUMBO_TAG_IMG) &&
-          !g_ascii_strcasecmp(at->name, "src")) ||
-        (!g_ascii_strcasecmp(at->name, "style") &&
-          g_regex_match_simple("url", attr_value->str, G_REGEX_CASELESS, 0)))
-      g_string_append(atts, "data-proxy-");
+  if (key_file) {
+    gchar **groups = g_key_file_get_groups(key_file, NULL);
+    gchar **group;
+    for (group = groups; *group; group++)
+      if (g_strcmp0(*group, DEFAULT_SANITIZER_POLICY))
+        g_hash_table_insert(policies, g_strdup(*group), new_sanitizer_policy(key_file, *group));
+    g_strfreev(groups);
+  }
+  return policies;
+}
 
-  g_string_append(atts, at->name);
 
-  // how do we want to handle attributes with empty values
-  // <input type="checkbox" checked />  or <input type="checkbox" checked="" />
+/*
+ * Compiles the policies of the key file and puts them in place of the
+ * current ones, which are kept if the file cannot be read. The swap
+ * happens between requests, so a request is sanitized with one set only.
+ */
+static gboolean load_sanitizer_policies(const gchar *path) {
+  GKeyFile *key_file = g_key_file_new();
+  GError *error = NULL;
+
+  if (!g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE, &error)) {
+    g_printerr("Cannot read the sanitizer policies %s: %s\r\n", path, error->message);
+    g_error_free(error);
+    g_key_file_free(key_file);
+    return FALSE;
+  }
 
-  gchar quote = at->original_value.data[0];
+  GHashTable *policies = new_sanitizer_policies(key_file);
+  g_key_file_free(key_file);
 
-  if (attr_value->len || (quote == '"') || (quote == '\'')) {
+  if (sanitizer_policies)
+    g_hash_table_destroy(sanitizer_policies);
+  sanitizer_policies = policies;
+  return TRUE;
+}
 
-    gchar *qs = "";
-    if (quote == '\'')
-      qs = "'";
 
-    if (quote == '"')
-      qs = "\"";
+static GHashTable *get_sanitizer_policies(void) {
+  if (!sanitizer_policies) {
+    const gchar *path = g_getenv(SANITIZER_POLICIES_ENV);
+    if (!path || !*path || !load_sanitizer_policies(path))
+      sanitizer_policies = new_sanitizer_policies(NULL);
+  }
+  return sanitizer_policies;
+}
 
-    g_string_append(atts, "=");
-    g_string_append(atts, qs);
 
-    if (no_entities) {
-      g_string_append(atts, attr_value->str);
-    } else {
-      GString *subd = gstr_substitute_xml_entities_into_attributes(quote, attr_value->str);
-      g_string_append(atts, subd->str);
-      g_string_free(subd, TRUE);
-    }
-    g_string_append(atts, qs);
-  }
+// Returns the named policy (the default one without a name), or NULL.
+static SanitizerPolicy *find_sanitizer_policy(const gchar *name) {
+  return g_hash_table_lookup(get_sanitizer_policies(), name ? name : DEFAULT_SANITIZER_POLICY);
+}
 
-  g_string_free(attr_value, TRUE);
-  return atts;
+
+static guint8 policy_tag_flags(SanitizerPolicy *policy, GumboNode *node) {
+  if (node->type != GUMBO_NODE_ELEMENT && node->type != GUMBO_NODE_TEMPLATE)
+    return 0;
+  if (node->v.element.tag >= GUMBO_TAG_UNKNOWN)
+    return 0;
+  return policy->tag_flags[node->v.element.tag];
 }
 
 
+// Looks the name up case insensitively without allocating.
+static guint policy_lookup(GHashTable *table, const gchar *name, gsize length) {
+  gchar key[POLICY_NAME_SIZE];
+  gsize i;
 
-static GString *sanitize_contents(GumboNode* node, GPtrArray *inlines_ary) {
-  GString *contents = g_string_new(NULL);
-  GString *tagname  = get_tag_name(node);
+  if (length >= sizeof(key))
+    return 0;
+  for (i = 0; i < length; i++)
+    key[i] = g_ascii_tolower(name[i]);
+  key[length] = '\0';
+  return GPOINTER_TO_UINT(g_hash_table_lookup(table, key));
+}
 
-  gchar *key = g_strjoin(NULL, "|", tagname->str, "|", NULL);
-  g_string_free(tagname, TRUE);
 
-  // Since we include pipes (|) we have to escape the regex string
-  gchar *key_pattern = g_regex_escape_string(key, -1);
-  g_free(key);
+// Matches "0*" followed by the two given characters, case insensitively.
+static gsize match_zero_padded(const gchar *text, gchar first, gchar second) {
+  const gchar *p = text;
 
-  gboolean no_entity_substitution = g_regex_match_simple(key_pattern, no_entity_sub, G_REGEX_CASELESS, 0);
-  g_free(key_pattern);
+  while (*p == '0')
+    p++;
+  if (g_ascii_tolower(p[0]) != first || g_ascii_tolower(p[1]) != second)
+    return 0;
+  return p + 2 - text;
+}
 
-  // build up result for each child, recursively if need be
-  GumboVector* children = &node->v.element.children;
-  guint i;
-  for (i = 0; i < children->length; ++i) {
-    GumboNode* child = (GumboNode*) (children->data[i]);
 
-    if (child->type == GUMBO_NODE_TEXT) {
-      if (no_entity_substitution) {
-        g_string_append(contents, child->v.text.text);
+/*
+ * Finds the separator ending the protocol of an URL: a colon, or a colon
+ * hidden as "&#58;", "&#x3a;" (any zero padding, the ';' being optional),
+ * "%3A" or "&#37;3A". Returns the offset of the separator, or -1 without one,
+ * and sets its length.
+ */
+static gssize find_protocol_separator(const gchar *value, gsize *separator_length) {
+  const gchar *p;
+
+  for (p = value; *p; p++) {
+    gsize length = 0;
+
+    if (*p == ':') {
+      length = 1;
+    } else if (*p == '%') {
+      if (p[1] == '3' && g_ascii_tolower(p[2]) == 'a')
+        length = 3;
+    } else if (*p == '&' && p[1] == '#') {
+      if (!g_ascii_strncasecmp(p + 2, "37;3a", 5)) {
+        length = 7;
+      } else if (g_ascii_tolower(p[2]) == 'x') {
+        gsize digits = match_zero_padded(p + 3, '3', 'a');
+        if (digits)
+          length = 3 + digits;
       } else {
-        GString *subd = gstr_substitute_xml_entities_into_text(child->v.text.text);
-        g_string_append(contents, subd->str);
-        g_string_free(subd, TRUE);
+        gsize digits = match_zero_padded(p + 2, '5', '8');
+        if (digits)
+          length = 2 + digits;
       }
+      if (length && p[length] == ';')
+        length++;
+    }
 
-    } else if (child->type == GUMBO_NODE_ELEMENT ||
-               child->type == GUMBO_NODE_TEMPLATE) {
-
-      GString *child_ser = sanitize(child, inlines_ary);
-      g_string_append(contents, child_ser->str);
-      g_string_free(child_ser, TRUE);
-
-    } else if (child->type == GUMBO_NODE_WHITESPACE) {
-      // keep all whitespace to keep as close to original as possible
-      g_string_append(contents, child->v.text.text);
-    } else if (child->type != GUMBO_NODE_COMMENT) {
-      // Does this actually exist: (child->type == GUMBO_NODE_CDATA)
-      fprintf(stderr, "unknown element of type: %d\n", child->type);
+    if (length) {
+      *separator_length = length;
+      return p - value;
     }
   }
-  return contents;
+  return -1;
 }
 
 
-static GString *sanitize(GumboNode* node, GPtrArray* inlines_ary) {
-  // special case the document node
-  if (node->type == GUMBO_NODE_DOCUMENT) {
-    GString *results = g_string_new("<!DOCTYPE html>\n");
-    GString *node_ser = sanitize_contents(node, inlines_ary);
-    g_string_append(results, node_ser->str);
-    g_string_free(node_ser, TRUE);
-    return results;
+/*
+ * Entity escaping
+ *
+ * Text is escaped in a single pass straight into the output: the runs
+ * between characters that need an entity are found 16 bytes at a time
+ * (SSE2) and copied as a whole.
+ */
+#ifdef HAVE_X86_SIMD
+// Returns the offset of the first '&', '<', '>' or quote within the data, or
+// length if none. Without a quote, pass '&' again.
+__attribute__((target("sse2")))
+static gsize find_entity_sse2(const guchar *data, gsize length, gchar quote) {
+  const __m128i amp   = _mm_set1_epi8('&');
+  const __m128i lt    = _mm_set1_epi8('<');
+  const __m128i gt    = _mm_set1_epi8('>');
+  const __m128i quot  = _mm_set1_epi8(quote);
+  gsize i = 0;
+
+  for (; i + 16 <= length; i += 16) {
+    __m128i chars = _mm_loadu_si128((const __m128i *) (data + i));
+    __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, amp), _mm_cmpeq_epi8(chars, lt)),
+                                _mm_or_si128(_mm_cmpeq_epi8(chars, gt), _mm_cmpeq_epi8(chars, quot)));
+    gint mask = _mm_movemask_epi8(hits);
+    if (mask)
+      return i + __builtin_ctz(mask);
   }
 
-  GString *tagname = get_tag_name(node);
-  gchar *key = g_strjoin(NULL, "|", tagname->str, "|", NULL);
-
-  gchar *key_pattern = g_regex_escape_string(key, -1);
-  g_free(key);
+  for (; i < length; i++)
+    if (data[i] == '&' || data[i] == '<' || data[i] == '>' || data[i] == quote)
+      return i;
+  return length;
+}
+#endif
 
 
-  gboolean need_special_handling     = g_regex_match_simple(key_pattern, special_handling,   G_REGEX_CASELESS, 0);
-  gboolean is_empty_tag              = g_regex_match_simple(key_pattern, empty_tags,         G_REGEX_CASELESS, 0);
-  gboolean no_entity_substitution    = g_regex_match_simple(key_pattern, no_entity_sub,      G_REGEX_CASELESS, 0);
-  gboolean tag_permitted             = g_regex_match_simple(key_pattern, permitted_tags,     G_REGEX_CASELESS, 0);
+/*
+ * Appends the text with '&', '<' and '>' replaced by entities, and the
+ * quote too when it is '"' or '\'' (for attribute values).
+ */
+static void gstr_append_escaped(GString *output, const gchar *text, gsize length, gchar quote) {
+  const guchar *data = (const guchar *) text;
+  gsize i = 0;
+
+  if (quote != '"' && quote != '\'')
+    quote = '&';
+
+  while (i < length) {
+    gsize run;
+#ifdef HAVE_X86_SIMD
+    run = find_entity_sse2(data + i, length - i, quote);
+#else
+    for (run = 0; i + run < length; run++) {
+      guchar c = data[i + run];
+      if (c == '&' || c == '<' || c == '>' || c == (guchar) quote)
+        break;
+    }
+#endif
+    g_string_append_len(output, text + i, run);
+    i += run;
+    if (i == length)
+      break;
+
+    switch (data[i]) {
+      case '&':  g_string_append(output, "&amp;");  break;
+      case '<':  g_string_append(output, "&lt;");   break;
+      case '>':  g_string_append(output, "&gt;");   break;
+      case '"':  g_string_append(output, "&quot;"); break;
+      default:   g_string_append(output, "&apos;"); break;
+    }
+    i++;
+  }
+}
 
-  g_free(key_pattern);
 
-  if (!need_special_handling && !tag_permitted) {
-    g_string_free(tagname, TRUE);
-    return g_string_new(NULL);
+/*
+ * Appends the text escaped as gstr_append_escaped does, with each run of
+ * whitespace collapsed into a single space, or left out when the output
+ * already ends with whitespace. Text written in several pieces thus
+ * collapses the same as when written at once.
+ */
+static void gstr_append_collapsed(GString *output, const gchar *text, gsize length) {
+  gsize i = 0;
+
+  while (i < length) {
+    gsize run = 0;
+    while (i + run < length && !g_ascii_isspace(text[i + run]))
+      run++;
+    gstr_append_escaped(output, text + i, run, 0);
+    i += run;
+    if (i == length)
+      break;
+
+    while (i < length && g_ascii_isspace(text[i]))
+      i++;
+    if (!output->len || !g_ascii_isspace(output->str[output->len - 1]))
+      g_string_append_c(output, ' ');
   }
+}
 
-  GString *close = g_string_new(NULL);
-  GString *closeTag = g_string_new(NULL);
-  GString *atts = g_string_new(NULL);
 
-  const GumboVector *attribs = &node->v.element.attributes;
-  guint i;
-  for (i = 0; i < attribs->length; ++i) {
-    GumboAttribute* at = (GumboAttribute*)(attribs->data[i]);
-    GString *attsstr = build_attributes(node, at, no_entity_substitution, inlines_ary);
-    g_string_append(atts, attsstr->str);
-    g_string_free(attsstr, TRUE);
-  }
+/*
+ * Sanitizer context
+ *
+ * The whole document is serialized into a single output buffer, sized
+ * after the raw HTML, which every node appends to in document order.
+ */
+typedef struct {
+  SanitizerPolicy *policy;
+  GPtrArray       *inlines;
+  GHashTable      *inline_references; // built on the first cid reference
+  const gchar     *inline_url;        // template of inline URLs, NULL to embed them
+  guint           max_depth;          // of the elements written, 0 for no limit
+  gsize           max_nodes;          // sanitized before stopping, 0 for no limit
+  gsize           max_output;         // bytes written before stopping, 0 for no limit
+  gboolean        minify;             // collapse whitespace and leave out redundant quotes
+  gsize           nodes;
+  gboolean        truncated;          // a limit was reached, the rest is left out
+  GString         *output;
+  gsize           output_aside;       // written into outputs other than the current one, put in it later
+} SanitizerContext;
 
-  if (is_empty_tag) {
-    g_string_append_c(close, '/');
-  } else {
-    g_string_append_printf(closeTag, "</%s>", tagname->str);
-  }
 
-  GString *contents = sanitize_contents(node, inlines_ary);
+/*
+ * Inline references
+ *
+ * Inline parts by lowercase content id, each with its URI built on first
+ * use, so that an image referenced many times is encoded once. The URI is
+ * either the inline URL template with the partId filled in, or a data URI
+ * of the content, in which case only parts small enough to be embedded are
+ * kept. When several parts have the same content id, the last one wins.
+ */
+#define INLINE_URL_PART_ID "{partId}"
 
-  if (need_special_handling) {
-    gstr_strip(contents);
-    g_string_append_c(contents, '\n');
-  }
+typedef struct {
+  CollectedPart *part;
+  gchar         *uri;
+} InlineReference;
 
-  GString *results = g_string_new(NULL);
-  g_string_append_printf(results, "<%s%s%s>", tagname->str, atts->str, close->str);
-  g_string_free(atts, TRUE);
 
-  g_string_free(tagname, TRUE);
+static void free_inline_reference(gpointer reference_ptr) {
+  InlineReference *reference = (InlineReference *) reference_ptr;
+  g_free(reference->uri);
+  g_free(reference);
+}
 
-  if (need_special_handling)
-    g_string_append_c(results, '\n');
 
-  g_string_append(results, contents->str);
-  g_string_free(contents, TRUE);
+static GHashTable *new_inline_references(GPtrArray *inlines, gboolean by_url) {
+  GHashTable *references = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, free_inline_reference);
+  guint i;
 
-  g_string_append(results, closeTag->str);
+  for (i = 0; inlines && i < inlines->len; i++) {
+    CollectedPart *inline_body = g_ptr_array_index(inlines, i);
+    if (!inline_body->content_id)
+      continue;
+    if (!by_url && (!inline_body->content || inline_body->content->len >= MAX_CID_SIZE))
+      continue;
 
-  if (need_special_handling)
-    g_string_append_c(results, '\n');
+    InlineReference *reference = g_new0(InlineReference, 1);
+    reference->part = inline_body;
+    g_hash_table_insert(references, g_ascii_strdown(inline_body->content_id, -1), reference);
+  }
+  return references;
+}
 
-  g_string_free(close, TRUE);
-  g_string_free(closeTag, TRUE);
 
-  return results;
+static gchar *inline_url_for(const gchar *inline_url, guint part_id) {
+  gchar **pieces = g_strsplit(inline_url, INLINE_URL_PART_ID, -1);
+  gchar *id = g_strdup_printf("%u", part_id);
+  gchar *url = g_strjoinv(id, pieces);
+  g_free(id);
+  g_strfreev(pieces);
+  return url;
 }
 
 
+// Returns the URI of the inline part with the content id, or NULL.
+static const gchar *inline_reference_uri(SanitizerContext *context, const gchar *content_id) {
+  if (!context->inlines || !context->inlines->len)
+    return NULL;
+  if (!context->inline_references)
+    context->inline_references = new_inline_references(context->inlines, context->inline_url != NULL);
 
+  gchar *key = g_ascii_strdown(content_id, -1);
+  InlineReference *reference = g_hash_table_lookup(context->inline_references, key);
+  g_free(key);
 
-/*
- * Textizer -> fetches text content out of HTML
- *
-static GString *textize(const GumboNode* node) {
-  if (node->type == GUMBO_NODE_TEXT) {
-    return g_string_new(node->v.text.text);
-  } else if (node->type == GUMBO_NODE_ELEMENT &&
-             node->v.element.tag != GUMBO_TAG_SCRIPT &&
-             node->v.element.tag != GUMBO_TAG_STYLE) {
-    const GumboVector* children = &node->v.element.children;
-    GString *contents = g_string_new(NULL);
-    guint i;
-    for (i = 0; i < children->length; ++i) {
-      GString *text = textize((GumboNode*) children->data[i]);
-      gstr_strip(text);
-      if (i && text->len && contents->len)
-        g_string_append_c(contents, ' ');
-      g_string_append(contents, text->str);
-      g_string_free(text, TRUE);
+  if (!reference)
+    return NULL;
+
+  if (!reference->uri) {
+    CollectedPart *part = reference->part;
+    if (context->inline_url) {
+      reference->uri = inline_url_for(context->inline_url, part->part_id);
+    } else {
+      gchar *base64_data = fast_base64_encode((const guchar *) part->content->data, part->content->len);
+      reference->uri = g_strjoin(NULL, "data:", part->content_type, ";base64,", base64_data, NULL);
+      g_free(base64_data);
     }
-    return contents;
-  } else {
-    return g_string_new(NULL);
   }
+  return reference->uri;
 }
-*/
-
 
 /*
+ * Style sanitizer
  *
- *
+ * Style attributes are split into declarations in a single scan over the
+ * value, and only safe declarations are written back. A declaration is
+ * dropped when its property runs code (behavior, -moz-binding), when its
+ * value holds expression() or a script URL, or when it has a url() whose
+ * protocol the policy does not permit. Comments and escapes can hide
+ * either of these, so they drop the declaration too. url() arguments are
+ * written back unquoted, with cid: references resolved like in src
+ * attributes.
  */
-static GMimeMessage* gmime_message_from_stream(GMimeStream *stream) {
-  g_return_val_if_fail(stream != NULL, NULL);
+static const gchar *css_code_properties[] = { "behavior", "-moz-binding", "-ms-behavior" };
+static const gchar *css_script_markers[]  = { "javascript:", "vbscript:", "livescript:" };
 
-  GMimeParser *parser = g_mime_parser_new_with_stream(stream);
-  if (!parser) {
-    g_printerr("failed to create parser\r\n");
-    return NULL;
-  }
 
-  GMimeMessage *message = g_mime_parser_construct_message(parser);
-  g_object_unref (parser);
-  if (!message) {
-    g_printerr("failed to construct message\r\n");
-    return NULL;
-  }
+static gboolean css_is_identifier(const gchar *name, gsize length) {
+  gsize i;
 
-  return message;
+  for (i = 0; i < length; i++)
+    if (!g_ascii_isalnum(name[i]) && name[i] != '-' && name[i] != '_')
+      return FALSE;
+  return length > 0;
 }
 
 
-/*
- *
- *
- */
-static GMimeMessage *gmime_message_from_file(FILE *file) {
-  g_return_val_if_fail(file != NULL, NULL);
+static gboolean css_span_contains_caseless(const gchar *text, gsize length, const gchar *needle) {
+  gsize needle_length = strlen(needle);
+  gsize i;
 
-  GMimeStream *stream = g_mime_stream_file_new(file);
+  for (i = 0; i + needle_length <= length; i++)
+    if (!g_ascii_strncasecmp(text + i, needle, needle_length))
+      return TRUE;
+  return FALSE;
+}
 
-  if (!stream) {
-    g_printerr("file stream could not be opened\r\n");
-    fclose(file);
-    return NULL;
-  }
 
-  // Being owner of the stream will automatically close the file when released
-  g_mime_stream_file_set_owner(GMIME_STREAM_FILE(stream), TRUE);
+static gboolean css_value_is_safe(const gchar *value, gsize length) {
+  gsize i;
 
-  GMimeMessage *message = gmime_message_from_stream(stream);
-  g_object_unref (stream);
-  if (!message) {
-    g_printerr("message could not be constructed from stream\r\n");
-    return NULL;
+  for (i = 0; i < length; i++) {
+    if (value[i] == '\\' || (value[i] == '/' && i + 1 < length && value[i + 1] == '*'))
+      return FALSE;
+
+    // expression() with any whitespace before the parenthesis
+    if ((value[i] == 'e' || value[i] == 'E') && i + 10 <= length &&
+        !g_ascii_strncasecmp(value + i, "expression", 10)) {
+      gsize j = i + 10;
+      while (j < length && g_ascii_isspace(value[j]))
+        j++;
+      if (j < length && value[j] == '(')
+        return FALSE;
+    }
   }
 
-  return message;
+  for (i = 0; i < G_N_ELEMENTS(css_script_markers); i++)
+    if (css_span_contains_caseless(value, length, css_script_markers[i]))
+      return FALSE;
+  return TRUE;
 }
 
 
-/*
- *
- *
- */
-static GMimeMessage *gmime_message_from_path(const gchar *path) {
-  g_return_val_if_fail(path != NULL, NULL);
-
-  // Note: we don't need to worry about closing the file, as it will be closed by the
-  // stream within message_from_file.
-  FILE *file = fopen (path, "r");
-
-  if (!file) {
-    g_printerr("cannot open file '%s': %s\r\n", path, g_strerror(errno));
-    return NULL;
+// Writes the url() argument back unquoted, returning FALSE if it must not be kept.
+static gboolean append_css_url(SanitizerContext *context, GString *output, const gchar *url, gsize length) {
+  url = gc_strip_span(url, &length);
+  if (length >= 2 && (url[0] == '"' || url[0] == '\'') && url[length - 1] == url[0]) {
+    url++;
+    length -= 2;
+    url = gc_strip_span(url, &length);
   }
 
-  GMimeMessage *message = gmime_message_from_file(file);
-  if (!message) {
-    g_printerr("message could not be constructed from file '%s': %s\r\n", path, g_strerror(errno));
-    return NULL;
+  gsize i;
+  for (i = 0; i < length; i++)
+    if (g_ascii_isspace(url[i]) || g_ascii_iscntrl(url[i]) || strchr("\"'()\\", url[i]))
+      return FALSE;
+
+  gchar *text = g_strndup(url, length);
+  gsize separator_length = 0;
+  gssize separator = find_protocol_separator(text, &separator_length);
+  gsize protocol_length = separator < 0 ? length : (gsize) separator;
+  gboolean is_permitted = length && policy_lookup(context->policy->protocols, text, protocol_length);
+
+  if (is_permitted) {
+    g_string_append(output, "url(");
+    if (separator >= 0 && protocol_length == 3 && !g_ascii_strncasecmp(text, "cid", 3)) {
+      const gchar *uri = inline_reference_uri(context, text + separator + separator_length);
+      g_string_append(output, uri ? uri : MIN_DATA_URI_IMAGE);
+    } else if (separator >= 0) {
+      g_string_append_len(output, text, separator);
+      g_string_append_c(output, ':');
+      g_string_append(output, text + separator + separator_length);
+    } else {
+      g_string_append(output, text);
+    }
+    g_string_append_c(output, ')');
   }
-
-  return message;
+  g_free(text);
+  return is_permitted;
 }
 
 
+// Writes the declaration to the output, returning TRUE if it has a url().
+static gboolean append_css_declaration(SanitizerContext *context, GString *output, const gchar *declaration, gsize length) {
+  const gchar *colon = memchr(declaration, ':', length);
+  if (!colon)
+    return FALSE;
+
+  gsize property_length = colon - declaration;
+  const gchar *property = gc_strip_span(declaration, &property_length);
+  gsize value_length = declaration + length - colon - 1;
+  const gchar *value = gc_strip_span(colon + 1, &value_length);
+  gsize i;
+
+  if (!css_is_identifier(property, property_length) || !value_length)
+    return FALSE;
+  for (i = 0; i < G_N_ELEMENTS(css_code_properties); i++)
+    if (property_length == strlen(css_code_properties[i]) &&
+        !g_ascii_strncasecmp(property, css_code_properties[i], property_length))
+      return FALSE;
+  if (!css_value_is_safe(value, value_length))
+    return FALSE;
+
+  gsize mark = output->len;
+  gboolean has_url = FALSE;
+
+  if (output->len)
+    g_string_append_c(output, ';');
+  g_string_append_len(output, property, property_length);
+  g_string_append_c(output, ':');
+
+  // Copy the value, rewriting every url() within it
+  const gchar *end = value + value_length;
+  const gchar *p = value;
+  while (p < end) {
+    const gchar *url = NULL;
+    for (i = 0; p + i + 4 <= end; i++)
+      if (!g_ascii_strncasecmp(p + i, "url(", 4)) {
+        url = p + i;
+        break;
+      }
+
+    if (!url) {
+      g_string_append_len(output, p, end - p);
+      break;
+    }
+    g_string_append_len(output, p, url - p);
+
+    const gchar *argument = url + 4;
+    const gchar *close = memchr(argument, ')', end - argument);
+    if (!close || !append_css_url(context, output, argument, close - argument)) {
+      g_string_truncate(output, mark);
+      return FALSE;
+    }
+    has_url = TRUE;
+    p = close + 1;
+  }
+  return has_url;
+}
+
 
 /*
- *
- *
+ * Writes the safe declarations of the style to the output, separated by ';'.
+ * Returns TRUE if any of them has a url().
  */
-static void collect_part(GMimeObject *part, PartCollectorData *fdata, gboolean multipart_parent) {
-  GMimeContentType        *content_type = g_mime_object_get_content_type(part);
-  GMimeContentDisposition *disposition  = g_mime_object_get_content_disposition(part);
+static gboolean sanitize_style(SanitizerContext *context, GString *output, const gchar *style, gsize length) {
+  const gchar *end = style + length;
+  const gchar *p = style;
+  gboolean has_url = FALSE;
+
+  while (p < end) {
+    const gchar *declaration = p;
+    gchar quote = 0;
+    guint depth = 0;
+
+    // A declaration ends at a ';' outside of strings and parentheses
+    for (; p < end; p++) {
+      if (quote) {
+        if (*p == quote)
+          quote = 0;
+      } else if (*p == '"' || *p == '\'') {
+        quote = *p;
+      } else if (*p == '(') {
+        depth++;
+      } else if (*p == ')' && depth) {
+        depth--;
+      } else if (*p == ';' && !depth) {
+        break;
+      }
+    }
 
-  if (!content_type)
-    return;
+    if (append_css_declaration(context, output, declaration, p - declaration))
+      has_url = TRUE;
+    p++;
+  }
+  return has_url;
+}
 
-  GMimeDataWrapper *wrapper = g_mime_part_get_content_object(GMIME_PART(part));
-  if (!wrapper)
-    return;
 
-  // All the information will be collected in the CollectedPart
-  CollectedPart *c_part = new_collected_part(fdata->part_id);
+// Attributes which mean something by being there, even without a value.
+static const gchar *boolean_attributes[] = {
+  "checked", "compact", "disabled", "ismap", "multiple", "nohref", "noresize", "noshade", "nowrap",
+  "readonly", "selected"
+};
 
-  gboolean is_attachment = FALSE;
-  if (disposition) {
-    c_part->disposition = g_ascii_strdown(disposition->disposition, -1);
-    is_attachment = !g_ascii_strcasecmp(disposition->disposition, GMIME_DISPOSITION_ATTACHMENT);
-  }
 
-  // If a filename is given, collect it always
-  const gchar *filename = g_mime_part_get_filename(GMIME_PART(part));
-  if (filename)
-    c_part->filename = g_strdup(filename);
+static gboolean is_boolean_attribute(const gchar *name) {
+  guint i;
+  for (i = 0; i < G_N_ELEMENTS(boolean_attributes); i++)
+    if (!g_ascii_strcasecmp(name, boolean_attributes[i]))
+      return TRUE;
+  return FALSE;
+}
 
-  // If a contentID is given, collect it always
-  const char* content_id = g_mime_part_get_content_id (GMIME_PART(part));
-  if (content_id)
-    c_part->content_id = g_strdup(content_id);
 
-  // Get the contentType in lowercase
-  gchar *content_type_str = g_mime_content_type_to_string(content_type);
-  c_part->content_type = g_ascii_strdown(content_type_str, -1);
-  g_free(content_type_str);
+// Tells whether the value could not be written unquoted.
+static gboolean needs_attribute_quotes(const gchar *value, gsize length) {
+  gsize i;
+  for (i = 0; i < length; i++)
+    if (g_ascii_isspace(value[i]) || strchr("\"'=<>`", value[i]))
+      return TRUE;
+  return FALSE;
+}
 
-  // To qualify as a message body, a MIME entity MUST NOT have a Content-Disposition header with the value "attachment".
-  if (!is_attachment && g_mime_content_type_is_type(content_type, "text", "*")) {
-    gboolean is_text_plain    = g_mime_content_type_is_type(content_type, "text", "plain");
-    gboolean is_text_html     = g_mime_content_type_is_type(content_type, "text", "html");
-    gboolean is_text_rtf      = g_mime_content_type_is_type(content_type, "text", "rtf");
-    gboolean is_text_enriched = g_mime_content_type_is_type(content_type, "text", "enriched");
 
-    gboolean is_new_text = !fdata->text_part && is_text_plain;
-    gboolean is_new_html = !fdata->html_part && (is_text_html || is_text_enriched || is_text_rtf);
+// Writes the attribute of an element of the tag if the policy permits it.
+// The quote is the one the value was given in, if any, replaced by '"'
+// where the value could not do without. Minifying, the value is left
+// unquoted where it can be, and left out with the attribute where empty.
+static void append_attribute(SanitizerContext *context, GumboTag tag, const gchar *name, const gchar *value,
+                             gchar quote) {
+  SanitizerPolicy *policy = context->policy;
+  GString *output = context->output;
+  guint attribute_flags = policy_lookup(policy->attributes, name, strlen(name));
+  gchar *cid_content_id = NULL;
 
-    GMimeStream *mem_stream = g_mime_stream_mem_new();
-    g_mime_stream_mem_set_owner(GMIME_STREAM_MEM(mem_stream), FALSE);
-    GMimeStream *filtered_mem_stream = g_mime_stream_filter_new(mem_stream);
+  if (!(attribute_flags & ATTRIBUTE_PERMITTED))
+    return;
 
-    const gchar *charset = g_mime_object_get_content_type_parameter(part, "charset");
-    if (charset && g_ascii_strcasecmp(charset, UTF8_CHARSET)) {
-      GMimeFilter *utf8_charset_filter = g_mime_filter_charset_new(charset, UTF8_CHARSET);
-      g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), utf8_charset_filter);
-      g_object_unref(utf8_charset_filter);
-    }
+  gsize value_length = strlen(value);
+  value = gc_strip_span(value, &value_length);
+  GString *attr_value = g_string_new_len(value, value_length);
 
-    if (!fdata->raw && is_new_text) {
-      GMimeFilter *strip_filter = g_mime_filter_strip_new();
-      g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), strip_filter);
-      g_object_unref(strip_filter);
+  if (attribute_flags & ATTRIBUTE_PROTOCOL) {
+    gsize separator_length = 0;
+    gssize separator = find_protocol_separator(attr_value->str, &separator_length);
+    gsize protocol_length = separator < 0 ? attr_value->len : (gsize)separator;
 
-      GMimeFilter *crlf_filter = g_mime_filter_crlf_new(FALSE, FALSE);
-      g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), crlf_filter);
-      g_object_unref(crlf_filter);
+    // An empty value has no protocol at all, as opposed to one starting with ':'
+    gboolean is_permitted_protocol = attr_value->len &&
+      policy_lookup(policy->protocols, attr_value->str, protocol_length);
 
-      GMimeFilter *html_filter = g_mime_filter_html_new(
-         GMIME_FILTER_HTML_CONVERT_NL        |
-         GMIME_FILTER_HTML_CONVERT_SPACES    |
-         GMIME_FILTER_HTML_CONVERT_URLS      |
-         GMIME_FILTER_HTML_MARK_CITATION     |
-         GMIME_FILTER_HTML_CONVERT_ADDRESSES |
-         GMIME_FILTER_HTML_CITE, CITATION_COLOUR);
-      g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), html_filter);
-      g_object_unref(html_filter);
+    if (is_permitted_protocol && separator >= 0) {
+      // an encoded separator is spelled out as the colon it stands for
+      if (separator_length > 1) {
+        g_string_erase(attr_value, separator, separator_length);
+        g_string_insert_c(attr_value, separator, ':');
+      }
+      if (protocol_length == 3 && !g_ascii_strncasecmp(attr_value->str, "cid", 3))
+        cid_content_id = g_strdup(attr_value->str + separator + 1);
     }
 
-    if (!fdata->raw && (is_new_text || is_new_html)) {
-      GMimeFilter *from_filter = g_mime_filter_from_new(GMIME_FILTER_FROM_MODE_ESCAPE);
-      g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), from_filter);
-      g_object_unref(from_filter);
+    if (!is_permitted_protocol) {
+      g_string_free(attr_value, TRUE);
+      return;
     }
+  }
 
-    // Add Enriched/RTF filter for this content
-    if (!fdata->raw && (is_new_html && (is_text_enriched || is_text_rtf))) {
-      guint flags = 0;
-      if (is_text_rtf)
-        flags = GMIME_FILTER_ENRICHED_IS_RICHTEXT;
+  if (cid_content_id) {
+    const gchar *uri = inline_reference_uri(context, cid_content_id);
 
-      GMimeFilter *enriched_filter = g_mime_filter_enriched_new(flags);
-      g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), enriched_filter);
-      g_object_unref(enriched_filter);
-    }
-    g_mime_data_wrapper_write_to_stream(wrapper, filtered_mem_stream);
+    // `cid` is not a valid URI schema, so if it was not replaced by the inline content,
+    // we replace it with a 1x1 image which should hide it. If there is content and we missed
+    // it due to the wrong contentId given, it will be avaialable as a downloadable attachment.
+    g_string_assign(attr_value, uri ? uri : MIN_DATA_URI_IMAGE);
 
-    // Very important! Flush the the stream and get all content through.
-    g_mime_stream_flush(filtered_mem_stream);
+    g_free(cid_content_id);
+  }
 
-    // Freed by the mem_stream on its own (owner) [transfer none]
-    c_part->content = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(mem_stream));
+  // Sources of images and styles with a url() are left for the client to proxy
+  gboolean is_proxied = (tag == GUMBO_TAG_IMG) && !g_ascii_strcasecmp(name, "src");
 
-    // After we unref the mem_stream, part_content is NOT available anymore
-    g_object_unref(filtered_mem_stream);
-    g_object_unref(mem_stream);
+  if (!g_ascii_strcasecmp(name, "style")) {
+    GString *style = g_string_sized_new(attr_value->len);
+    if (sanitize_style(context, style, attr_value->str, attr_value->len))
+      is_proxied = TRUE;
+    g_string_free(attr_value, TRUE);
+    attr_value = style;
 
-    // Without content, the collected body part is of no use, so we ignore it.
-    if (c_part->content->len == 0) {
-      free_collected_part(c_part);
+    // Nothing was left of the style
+    if (!attr_value->len) {
+      g_string_free(attr_value, TRUE);
       return;
     }
+  }
 
-    // We accept only the first text and first html content, everything
-    // else is considered an alternative body
-    if (is_new_text) {
-      fdata->text_part = c_part;
-    } else if (is_new_html) {
-      fdata->html_part = c_part;
-    } else {
-      g_ptr_array_add(fdata->alternative_bodies, c_part);
+  // Values left unquoted in the source may still need quotes once decoded
+  if (quote != '"' && quote != '\'')
+    quote = 0;
+  if (needs_attribute_quotes(attr_value->str, attr_value->len)) {
+    quote = '"';
+  } else if (context->minify) {
+    // Empty attributes are left out, except the ones meant by being there
+    if (!attr_value->len && !is_boolean_attribute(name)) {
+      g_string_free(attr_value, TRUE);
+      return;
     }
+    quote = 0;
+  }
 
-  } else {
-    GMimeStream *attachment_mem_stream = g_mime_stream_mem_new();
-    g_mime_stream_mem_set_owner (GMIME_STREAM_MEM(attachment_mem_stream), FALSE);
-    g_mime_data_wrapper_write_to_stream(wrapper, attachment_mem_stream);
-    g_mime_stream_flush(attachment_mem_stream);
+  g_string_append_c(output, ' ');
 
-    c_part->content = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(attachment_mem_stream));
-    g_object_unref(attachment_mem_stream);
+  if (is_proxied)
+    g_string_append(output, "data-proxy-");
 
-    // Some content may not have disposition defined so we need to determine better what it is
-    if ((disposition && !g_ascii_strcasecmp(disposition->disposition, GMIME_DISPOSITION_INLINE)) ||
-        g_mime_part_get_content_id(GMIME_PART(part))) {
-      g_ptr_array_add(fdata->inlines, c_part);
-    } else {
-      // All other disposition should be kept within attachments
-      g_ptr_array_add(fdata->attachments, c_part);
-    }
+  g_string_append(output, name);
+
+  // how do we want to handle attributes with empty values
+  // <input type="checkbox" checked />  or <input type="checkbox" checked="" />
+
+  if (attr_value->len || (quote == '"') || (quote == '\'')) {
+
+    gchar *qs = "";
+    if (quote == '\'')
+      qs = "'";
+
+    if (quote == '"')
+      qs = "\"";
 
+    g_string_append(output, "=");
+    g_string_append(output, qs);
+
+    gstr_append_escaped(output, attr_value->str, attr_value->len, quote);
+    g_string_append(output, qs);
   }
+
+  g_string_free(attr_value, TRUE);
+}
+
+
+
+// Counts a node about to be sanitized, and tells whether the limits on the
+// nodes and on the output leave room for it. Once they do not, the context
+// is flagged as truncated, and the elements open are only closed.
+static gboolean sanitizer_within_limits(SanitizerContext *context) {
+  if ((context->max_nodes && ++context->nodes > context->max_nodes) ||
+      (context->max_output && context->output->len + context->output_aside >= context->max_output))
+    context->truncated = TRUE;
+  return !context->truncated;
 }
 
 
 /*
+ * Tree traversal
  *
- *
+ * The parse tree is walked with a stack of frames on the heap rather than
+ * by recursion, as mail may nest elements tens of thousands deep. Elements
+ * nested deeper than the maximum depth are flattened: their tags are left
+ * out and their text is written in place, walking their subtree by the
+ * parent links of Gumbo, so the stack stays bounded by the maximum depth.
+ * Past the limits on nodes and output, the open elements are closed and
+ * the rest of the tree is left out.
  */
-static void collector_foreach_callback(GMimeObject *parent, GMimeObject *part, gpointer user_data) {
-  g_return_if_fail(user_data != NULL);
+typedef struct {
+  GumboNode *node;
+  guint     child;            // index of the next child to sanitize
+  guint8    tag_flags;
+  gboolean  preformatted;     // it or an ancestor keeps its whitespace
+  gsize     contents_start;   // in the output
+} SanitizerFrame;
 
-  PartCollectorData *fdata = (PartCollectorData *) user_data;
-
-  if (GMIME_IS_MESSAGE_PART(part)) {
 
-    if (fdata->recursion_depth++ < RECURSION_LIMIT) {
-      GMimeMessage *message = g_mime_message_part_get_message((GMimeMessagePart *) part); // transfer none
-      if (message)
-        g_mime_message_foreach(message, collector_foreach_callback, user_data);
+static GumboVector *node_children(GumboNode *node) {
+  return node->type == GUMBO_NODE_DOCUMENT ? &node->v.document.children : &node->v.element.children;
+}
 
-    } else {
-      g_printerr("endless recursion detected: %d\r\n", fdata->recursion_depth);
-      return;
-    }
 
-  } else if (GMIME_IS_MESSAGE_PARTIAL(part)) {
-    // Save into an array ? Todo: Look into the specs
-  } else if (GMIME_IS_MULTIPART(part)) {
-    // Nothing special needed on multipart, let descend further
-  } else if (GMIME_IS_PART(part)) {
-    collect_part(part, fdata, GMIME_IS_MULTIPART(parent));
-    fdata->part_id++;
-  } else {
-    g_assert_not_reached();
+// Minifying, the whitespace of text outside preformatted elements is
+// collapsed.
+static void sanitize_text(SanitizerContext *context, GumboNode* node, gboolean preformatted) {
+  GString *contents = context->output;
+
+  if (context->minify && !preformatted &&
+      (node->type == GUMBO_NODE_TEXT || node->type == GUMBO_NODE_WHITESPACE)) {
+    gstr_append_collapsed(contents, node->v.text.text, strlen(node->v.text.text));
+  } else if (node->type == GUMBO_NODE_TEXT) {
+    gstr_append_escaped(contents, node->v.text.text, strlen(node->v.text.text), 0);
+  } else if (node->type == GUMBO_NODE_WHITESPACE) {
+    // keep all whitespace to keep as close to original as possible
+    g_string_append(contents, node->v.text.text);
+  } else if (node->type != GUMBO_NODE_COMMENT) {
+    // Does this actually exist: (node->type == GUMBO_NODE_CDATA)
+    g_printerr("unknown element of type: %d\r\n", node->type);
   }
 }
 
 
-static PartCollectorData *collect_parts(GMimeMessage *message, guint content_option) {
-  PartCollectorData *pc = new_part_collector_data(content_option);
-  g_mime_message_foreach(message, collector_foreach_callback, pc);
-  return pc;
+static void sanitize_start(SanitizerContext *context, SanitizerFrame *frame) {
+  GString *results = context->output;
+  GumboNode *node = frame->node;
+  guint8 tag_flags = frame->tag_flags;
+
+  // Only tags known to Gumbo have flags, so they all have a normalized name
+  const gchar *tagname = gumbo_normalized_tagname(node->v.element.tag);
+
+  g_string_append_c(results, '<');
+  g_string_append(results, tagname);
+
+  const GumboVector *attribs = &node->v.element.attributes;
+  guint i;
+  for (i = 0; i < attribs->length; ++i) {
+    GumboAttribute *at = (GumboAttribute*)(attribs->data[i]);
+    append_attribute(context, node->v.element.tag, at->name, at->value, at->original_value.data[0]);
+  }
+
+  // Minifying, a value left unquoted would take in the '/'
+  if ((tag_flags & TAG_EMPTY) && !context->minify)
+    g_string_append_c(results, '/');
+  g_string_append_c(results, '>');
+
+  if (tag_flags & TAG_SPECIAL_HANDLING)
+    g_string_append_c(results, '\n');
+
+  frame->contents_start = results->len;
 }
 
 
+static void sanitize_end(SanitizerContext *context, SanitizerFrame *frame) {
+  GString *results = context->output;
+  gboolean need_special_handling = frame->tag_flags & TAG_SPECIAL_HANDLING;
 
+  if (need_special_handling) {
+    gstr_strip_from(results, frame->contents_start);
+    g_string_append_c(results, '\n');
+  }
 
-/*
- *
- *
- */
-static void extract_part(GMimeObject *part, PartExtractorData *a_data) {
-  GMimeDataWrapper *attachment_wrapper = g_mime_part_get_content_object(GMIME_PART(part));
-  GMimeStream *attachment_mem_stream = g_mime_stream_mem_new();
-  g_mime_stream_mem_set_owner(GMIME_STREAM_MEM(attachment_mem_stream), FALSE);
-  g_mime_data_wrapper_write_to_stream(attachment_wrapper, attachment_mem_stream);
-  g_mime_stream_flush(attachment_mem_stream);
-  a_data->content = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(attachment_mem_stream));
-  g_object_unref(attachment_mem_stream);
+  if (!(frame->tag_flags & TAG_EMPTY))
+    g_string_append_printf(results, "</%s>", gumbo_normalized_tagname(frame->node->v.element.tag));
+
+  if (need_special_handling)
+    g_string_append_c(results, '\n');
 }
 
 
-/*
- *
- *
- */
-static void part_extractor_foreach_callback(GMimeObject *parent, GMimeObject *part, gpointer user_data) {
-  PartExtractorData *a_data = (PartExtractorData *) user_data;
+// Tells whether the element is written, or dropped along with its contents.
+static gboolean is_sanitized_element(guint8 tag_flags) {
+  return tag_flags & (TAG_SPECIAL_HANDLING | TAG_PERMITTED);
+}
 
-  if (GMIME_IS_MESSAGE_PART(part)) {
 
-    if (a_data->recursion_depth < RECURSION_LIMIT) {
-      GMimeMessage *message = g_mime_message_part_get_message((GMimeMessagePart *) part); // transfer none
-      if (message)
-        g_mime_message_foreach(message, part_extractor_foreach_callback, a_data);
+// Writes the text within the element, nested too deep for its tags and the
+// ones within it to be written. A preformatted element is not there to keep
+// the whitespace of its text.
+static void sanitize_flattened(SanitizerContext *context, GumboNode *root, gboolean preformatted) {
+  GumboNode *node = root;
+
+  while (node && sanitizer_within_limits(context)) {
+    GumboNode *next = NULL;
 
+    if (node->type == GUMBO_NODE_ELEMENT || node->type == GUMBO_NODE_TEMPLATE) {
+      if (is_sanitized_element(policy_tag_flags(context->policy, node)) && node->v.element.children.length)
+        next = node->v.element.children.data[0];
     } else {
-      g_printerr("endless recursion detected: %d\r\n", a_data->recursion_depth);
-      return;
+      sanitize_text(context, node, preformatted);
     }
 
-  } else if (GMIME_IS_MESSAGE_PARTIAL (part)) {
-    // Save into an array ? Todo: Look into the specs
-  } else if (GMIME_IS_MULTIPART (part)) {
-    // Nothing special needed on multipart, let descend further
-  } else if (GMIME_IS_PART (part)) {
+    // Then the next sibling of the node, or of the nearest ancestor having one
+    while (!next && node != root) {
+      GumboVector *siblings = &node->parent->v.element.children;
+      if (node->index_within_parent + 1 < siblings->length)
+        next = siblings->data[node->index_within_parent + 1];
+      else
+        node = node->parent;
+    }
+    node = next;
+  }
+}
 
-    // We are interested only in the part 0 (counting down by same logic)
-    if (a_data->part_id == 0)
-      extract_part(part, a_data);
 
-    a_data->part_id--;
+static void sanitize_tree(SanitizerContext *context, GumboNode *document) {
+  GArray *stack = g_array_sized_new(FALSE, FALSE, sizeof(SanitizerFrame), 64);
+  SanitizerFrame root = { document, 0, 0, FALSE, 0 };
 
-  } else {
-    g_assert_not_reached();
+  g_string_append(context->output, "<!DOCTYPE html>\n");
+  g_array_append_val(stack, root);
+
+  while (stack->len) {
+    SanitizerFrame *frame = &g_array_index(stack, SanitizerFrame, stack->len - 1);
+    GumboVector *children = node_children(frame->node);
+
+    if (frame->child == children->length || !sanitizer_within_limits(context)) {
+      if (frame->node != document)
+        sanitize_end(context, frame);
+      g_array_set_size(stack, stack->len - 1);
+      continue;
+    }
+
+    GumboNode *child = (GumboNode*) (children->data[frame->child++]);
+
+    if (child->type != GUMBO_NODE_ELEMENT && child->type != GUMBO_NODE_TEMPLATE) {
+      sanitize_text(context, child, frame->preformatted);
+      continue;
+    }
+
+    SanitizerFrame element = { child, 0, policy_tag_flags(context->policy, child), frame->preformatted, 0 };
+    if (!is_sanitized_element(element.tag_flags))
+      continue;
+
+    // The frames on the stack are the document and the ancestors of the child
+    if (context->max_depth && stack->len > context->max_depth) {
+      sanitize_flattened(context, child, frame->preformatted);
+      continue;
+    }
+
+    element.preformatted = element.preformatted || (element.tag_flags & TAG_PREFORMATTED);
+    sanitize_start(context, &element);
+    g_array_append_val(stack, element);
   }
+
+  g_array_free(stack, TRUE);
+}
+
+
+// Both sanitizer engines write into a single buffer of about the size of
+// the HTML they read.
+static void init_sanitizer_context(SanitizerContext *context, GPtrArray* inlines_ary, const GmimexOptions *options,
+                                   gsize size_hint) {
+  context->policy = find_sanitizer_policy(options ? options->sanitizer_policy : NULL);
+  context->inlines = inlines_ary;
+  context->inline_references = NULL;
+  context->inline_url = options ? options->inline_url : NULL;
+  context->max_depth = options ? options->max_depth : GMIMEX_DEFAULT_MAX_DEPTH;
+  context->max_nodes = options ? options->max_html_nodes : GMIMEX_DEFAULT_MAX_HTML_NODES;
+  context->max_output = options ? options->max_html_output : GMIMEX_DEFAULT_MAX_HTML_OUTPUT;
+  context->minify = options ? options->minify : FALSE;
+  context->nodes = 0;
+  context->truncated = FALSE;
+  context->output = g_string_sized_new(size_hint + 64);
+  context->output_aside = 0;
+}
+
+
+// Returns the output, which the context no longer holds, and whether a
+// limit cut it short.
+static GString *finish_sanitizer_context(SanitizerContext *context, gboolean *truncated) {
+  if (context->inline_references)
+    g_hash_table_destroy(context->inline_references);
+  *truncated = context->truncated;
+  return context->output;
+}
+
+
+static GString *sanitize(GumboNode* document, GPtrArray* inlines_ary, const GmimexOptions *options, gsize size_hint,
+                         gboolean *truncated) {
+  SanitizerContext context;
+
+  init_sanitizer_context(&context, inlines_ary, options, size_hint);
+  sanitize_tree(&context, document);
+  return finish_sanitizer_context(&context, truncated);
 }
 
 
 /*
+ * Streaming sanitizer
  *
+ * The other sanitizer engine, which builds no parse tree: the HTML is
+ * tokenized in a single pass, and every token is filtered through the
+ * policy and written as soon as it is read. Only the stack of open elements
+ * and the active formatting elements are kept besides the output, instead
+ * of a node for every tag, attribute and text of the body.
  *
+ * Its output is the one of the tree for the HTML mail is made of, as the
+ * HTML5 tree construction is followed wherever it changes what is written:
+ * html and body are implied, head elements and comments are dropped, <p>,
+ * <li>, <dd>, <dt>, <option>, table cells and rows are closed by the tags
+ * implying their end, tbody, tr and colgroup are implied in tables, end
+ * tags which close nothing are dropped, formatting elements closed along
+ * with a block are reopened after it or split around it, and content
+ * misplaced in a table is moved in front of it. Where the tree would move
+ * what is written already, the output is patched in place. Rarer parse
+ * error recovery, like the one of <frameset> or <math>, is not followed.
  */
-static GByteArray *gmime_message_get_part_data(GMimeMessage* message, guint part_id) {
-  g_return_val_if_fail(message != NULL, NULL);
+#define STREAM_SANITIZER_ENGINE "stream"
+#define TREE_SANITIZER_ENGINE   "tree"
+
+#define STREAM_TAG_VOID        (1 << 0)  // has neither contents nor an end tag
+#define STREAM_TAG_SPECIAL     (1 << 1)  // keeps end tags of other elements from closing it
+#define STREAM_TAG_SCOPE       (1 << 2)  // bounds the scope open elements are looked for in
+#define STREAM_TAG_CLOSES_P    (1 << 3)  // implies the end of an open <p>
+#define STREAM_TAG_RAW_TEXT    (1 << 4)  // contents are text up to the end tag
+#define STREAM_TAG_REFERENCES  (1 << 5)  // ... in which character references are decoded
+#define STREAM_TAG_HEAD        (1 << 6)  // goes into the head when before the body
+#define STREAM_TAG_HEADING     (1 << 7)
+#define STREAM_TAG_FORMATTING  (1 << 8)  // reopened when closed along with a block
+#define STREAM_TAG_MARKER      (1 << 9)  // ... but not out of one of these
+#define STREAM_TAG_REOPENS     (1 << 10) // reopens formatting elements before it
+#define STREAM_TAG_TABLE_PART  (1 << 11) // stays in a table, where other content is moved out
+
+static gchar* stream_void_tags       = "|area|base|basefont|bgsound|br|col|embed|frame|hr|img|input|keygen|link|meta|param|source|track|wbr|";
+static gchar* stream_special_tags    = "|address|applet|area|article|aside|base|basefont|bgsound|blockquote|body|br|button|caption|center|col|colgroup|dd|details|dir|div|dl|dt|embed|fieldset|figcaption|figure|footer|form|frame|frameset|h1|h2|h3|h4|h5|h6|head|header|hgroup|hr|html|iframe|img|input|li|link|listing|main|marquee|menu|meta|nav|noembed|noframes|noscript|object|ol|p|param|plaintext|pre|script|section|select|source|style|summary|table|tbody|td|template|textarea|tfoot|th|thead|title|tr|track|ul|wbr|xmp|";
+static gchar* stream_scope_tags      = "|applet|caption|html|marquee|object|table|td|template|th|";
+static gchar* stream_closes_p_tags   = "|address|article|aside|blockquote|center|dd|details|dialog|dir|div|dl|dt|fieldset|figcaption|figure|footer|form|h1|h2|h3|h4|h5|h6|header|hgroup|hr|li|listing|main|menu|nav|ol|p|plaintext|pre|section|summary|ul|xmp|";
+static gchar* stream_raw_text_tags   = "|iframe|noembed|noframes|noscript|plaintext|script|style|textarea|title|xmp|";
+static gchar* stream_reference_tags  = "|textarea|title|";
+static gchar* stream_head_tags       = "|base|basefont|bgsound|link|meta|noframes|noscript|script|style|title|";
+static gchar* stream_heading_tags    = "|h1|h2|h3|h4|h5|h6|";
+static gchar* stream_formatting_tags = "|a|b|big|code|em|font|i|nobr|s|small|strike|strong|tt|u|";
+static gchar* stream_marker_tags     = "|applet|caption|marquee|object|td|template|th|";
+static gchar* stream_reopens_tags    = "|applet|area|br|embed|img|input|keygen|marquee|object|select|wbr|";
+static gchar* stream_table_part_tags = "|caption|col|colgroup|script|style|table|tbody|td|template|tfoot|th|thead|tr|";
+
+static guint16 stream_tag_classes[GUMBO_TAG_LAST];
+static gboolean stream_tag_classes_ready = FALSE;
+
+
+static void stream_add_tag_class(const gchar *list, guint16 tag_class) {
+  gchar **names = policy_list(NULL, NULL, NULL, list);
+  gchar **name;
+
+  // Tags this version of Gumbo does not know are left out
+  for (name = names; *name; name++) {
+    GumboTag tag = gumbo_tag_enum(*name);
+    if (tag != GUMBO_TAG_UNKNOWN)
+      stream_tag_classes[tag] |= tag_class;
+  }
+  g_strfreev(names);
+}
 
-  PartExtractorData *a_data = new_part_extractor_data(part_id);
-  g_mime_message_foreach(message, part_extractor_foreach_callback, a_data);
-  GByteArray *content = a_data->content;
-  free_part_extractor_data(a_data, FALSE);
 
-  if (!content)
-    g_printerr("could not locate partId %d\r\n", part_id);
+static void init_stream_tag_classes(void) {
+  if (stream_tag_classes_ready)
+    return;
 
-  return content;
+  stream_add_tag_class(stream_void_tags, STREAM_TAG_VOID);
+  stream_add_tag_class(stream_special_tags, STREAM_TAG_SPECIAL);
+  stream_add_tag_class(stream_scope_tags, STREAM_TAG_SCOPE);
+  stream_add_tag_class(stream_closes_p_tags, STREAM_TAG_CLOSES_P);
+  stream_add_tag_class(stream_raw_text_tags, STREAM_TAG_RAW_TEXT);
+  stream_add_tag_class(stream_reference_tags, STREAM_TAG_REFERENCES);
+  stream_add_tag_class(stream_head_tags, STREAM_TAG_HEAD);
+  stream_add_tag_class(stream_heading_tags, STREAM_TAG_HEADING);
+  stream_add_tag_class(stream_formatting_tags, STREAM_TAG_FORMATTING);
+  stream_add_tag_class(stream_marker_tags, STREAM_TAG_MARKER);
+  stream_add_tag_class(stream_reopens_tags, STREAM_TAG_REOPENS);
+  stream_add_tag_class(stream_table_part_tags, STREAM_TAG_TABLE_PART);
+
+  // Besides the special elements listed, every element reopens formatting ones
+  gint tag;
+  for (tag = 0; tag < GUMBO_TAG_LAST; tag++)
+    if (!(stream_tag_classes[tag] & STREAM_TAG_SPECIAL))
+      stream_tag_classes[tag] |= STREAM_TAG_REOPENS;
+
+  stream_tag_classes_ready = TRUE;
+}
+
+
+/*
+ * Character references
+ *
+ * The tokenizer decodes references in text and attribute values like Gumbo
+ * does, as the output is escaped again. Named references are the ones of
+ * HTML5, in character_references.h, the legacy ones of which are also read
+ * without their ';'.
+ */
+// Longest name of a reference read without its ';'
+#define LEGACY_REFERENCE_SIZE 6
+
+// Numeric references to 0x80-0x9F stand for these windows-1252 characters
+static const gunichar windows_1252_references[32] = {
+  0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+  0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+  0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+  0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+};
+
+
+static int compare_character_reference(const void *name, const void *reference) {
+  return strcmp((const gchar *) name, ((const CharacterReference *) reference)->name);
 }
 
 
+static const CharacterReference *find_character_reference(const gchar *name, gsize length) {
+  gchar key[32];
 
+  if (length >= sizeof(key))
+    return NULL;
+  memcpy(key, name, length);
+  key[length] = '\0';
+  return bsearch(key, character_references, G_N_ELEMENTS(character_references),
+                 sizeof(CharacterReference), compare_character_reference);
+}
 
 
 /*
- *
- *
+ * Decodes the character reference at text, just past its '&', into the
+ * output. Returns the length of the reference, or 0 when there is none and
+ * the '&' stands for itself.
  */
-static void collect_addresses_into(InternetAddressList *ilist, AddressesList *addr_list, guint size) {
-  g_return_if_fail(ilist != NULL);
-  g_return_if_fail(addr_list != NULL);
-  g_return_if_fail(size != 0);
+static gsize append_character_reference(GString *output, const gchar *text, const gchar *end, gboolean in_attribute) {
+  const gchar *p = text;
+  gunichar codepoint = 0;
+
+  if (p < end && *p == '#') {
+    gboolean hex = (p + 1 < end) && (p[1] == 'x' || p[1] == 'X');
+    const gchar *digits = p = p + (hex ? 2 : 1);
+
+    for (; p < end && (hex ? g_ascii_isxdigit(*p) : g_ascii_isdigit(*p)); p++)
+      if (codepoint <= 0x10FFFF)
+        codepoint = codepoint * (hex ? 16 : 10) + (hex ? g_ascii_xdigit_value(*p) : g_ascii_digit_value(*p));
+    if (p == digits)
+      return 0;
+    if (p < end && *p == ';')
+      p++;
+
+    if (codepoint >= 0x80 && codepoint <= 0x9F)
+      codepoint = windows_1252_references[codepoint - 0x80];
+    else if (!codepoint || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+      codepoint = 0xFFFD;
+  } else {
+    const gchar *name_end = p;
+    const CharacterReference *reference = NULL;
 
-  guint i;
-  for (i = 0; i < size; i++) {
-    InternetAddress *address = internet_address_list_get_address(ilist, i); // transfer none
+    while (name_end < end && g_ascii_isalnum(*name_end))
+      name_end++;
 
-    if (INTERNET_ADDRESS_IS_GROUP(address)) {
-      InternetAddressGroup *group = INTERNET_ADDRESS_GROUP(address);
-      InternetAddressList *group_list = internet_address_group_get_members(group); // transer none
+    if (name_end < end && *name_end == ';')
+      reference = find_character_reference(p, name_end - p);
 
-      if (group_list) {
-        guint gsize = internet_address_list_length(group_list);
-        if (gsize)
-          collect_addresses_into(group_list, addr_list, gsize);
+    if (reference) {
+      p = name_end + 1;
+    } else {
+      // Without its ';', the longest legacy reference the name starts with
+      gsize length = MIN((gsize) (name_end - p), LEGACY_REFERENCE_SIZE);
+      for (; length >= 2; length--) {
+        reference = find_character_reference(p, length);
+        if (reference && reference->legacy)
+          break;
+        reference = NULL;
       }
+      if (!reference)
+        return 0;
+      // Within attributes, "&copy=1" and "&copyright" are kept as they are
+      if (in_attribute && p + length < end && (g_ascii_isalnum(p[length]) || p[length] == '='))
+        return 0;
+      p += length;
+    }
+    // A few references stand for a character and a combining mark
+    g_string_append_unichar(output, reference->codepoints[0]);
+    if (reference->codepoints[1])
+      g_string_append_unichar(output, reference->codepoints[1]);
+    return p - text;
+  }
 
-    } else if (INTERNET_ADDRESS_IS_MAILBOX(address)) {
-      InternetAddressMailbox *mailbox = INTERNET_ADDRESS_MAILBOX(address);
-      const gchar *name    = internet_address_get_name(address);
-      const gchar *address = internet_address_mailbox_get_addr(mailbox);
-      Address *addr = new_address(address, name);
-      addresses_list_add(addr_list, addr);
+  g_string_append_unichar(output, codepoint);
+  return p - text;
+}
+
+
+// Appends the text with its line breaks read as '\n', like Gumbo reads
+// them, and its character references decoded if asked.
+static void append_decoded_text(GString *output, const gchar *text, gsize length,
+                                gboolean references, gboolean in_attribute) {
+  const gchar *p = text;
+  const gchar *end = text + length;
+
+  while (p < end) {
+    const gchar *run = p;
+    while (p < end && *p != '\r' && !(references && *p == '&'))
+      p++;
+    g_string_append_len(output, run, p - run);
+    if (p == end)
+      break;
+
+    if (*p == '\r') {
+      g_string_append_c(output, '\n');
+      p += (p + 1 < end && p[1] == '\n') ? 2 : 1;
+    } else {
+      gsize reference_length = append_character_reference(output, ++p, end, in_attribute);
+      if (!reference_length)
+        g_string_append_c(output, '&');
+      p += reference_length;
     }
   }
 }
 
 
+typedef struct {
+  GumboTag tag;
+  gchar    *name;            // of a tag unknown to Gumbo, else NULL
+  guint8   flags;            // TAG_* flags of the policy
+  gboolean dropped;          // it or an ancestor is not permitted, so it is not written
+  gboolean flattened;        // nested deeper than the maximum depth, only its text is written
+  gboolean preformatted;     // it or a written ancestor keeps its whitespace
+  guint    depth;
+  guint    serial;           // tells it apart from the elements opened before it
+  GString  *output;          // it is written into
+  gsize    start;            // of its start tag in the output
+  gsize    contents_start;   // in the output
+  gsize    foster_at;        // of a table, where content moved out of it goes, in front of it
+  GString  *fostered;        // ... and that content, put there once the table is closed
+  gint     foster_table;     // of content moved out of a table, the index of the table, else -1
+  GString  *foster_output;   // ... and the output the table is in, its own being a new one
+  GString  *adopted_before;  // of a block moved out of formatting elements, their tags going in front of it
+  GString  *adopted_after;   // ... and after its start tag, put there once it is closed
+} StreamElement;
+
+typedef struct {
+  gsize name;                // offsets in the attribute data
+  gsize value;
+  gchar quote;
+} StreamAttribute;
+
+typedef struct {
+  GumboTag tag;              // GUMBO_TAG_UNKNOWN for a marker
+  guint    serial;           // of its element while it is open
+  gint     index;            // of its element in the open elements, where it was found last
+  GString  *attribute_data;  // a copy of the attributes of its start tag
+  GArray   *attributes;
+} StreamFormatting;
+
+typedef struct {
+  SanitizerContext *context;
+  GArray   *open;            // of StreamElement, the current one last
+  guint    open_counts[GUMBO_TAG_LAST];  // of the open elements of every tag
+  GArray   *formatting;      // of StreamFormatting, the active formatting elements
+  guint    serial;           // of the element opened last
+  gint     foster_table;     // index of the table the next element is moved out of, or -1
+  gboolean has_doctype;
+  gboolean has_html;
+  gboolean has_head;
+  gboolean has_body;
+  gboolean skip_newline;     // a newline right after <pre> is not contents
+  GString  *tag_name;        // of the tag read last, in lower case
+  GString  *attribute_data;  // names and values of its attributes
+  GArray   *attributes;      // of StreamAttribute
+  GString  *text;            // decoded text
+} StreamSanitizer;
+
+typedef enum {
+  STREAM_SCOPE_DEFAULT,
+  STREAM_SCOPE_LIST_ITEM,
+  STREAM_SCOPE_BUTTON,
+  STREAM_SCOPE_TABLE
+} StreamScope;
+
+
+static StreamElement *stream_current(StreamSanitizer *s) {
+  return s->open->len ? &g_array_index(s->open, StreamElement, s->open->len - 1) : NULL;
+}
+
+
+static gboolean stream_current_is(StreamSanitizer *s, GumboTag tag) {
+  StreamElement *current = stream_current(s);
+  return current && current->tag == tag;
+}
 
-static AddressesList *collect_str_addresses(const gchar* addresses_list_str) {
-  g_return_val_if_fail(addresses_list_str != NULL, NULL);
 
-  AddressesList* result = NULL;
-  InternetAddressList *addresses = internet_address_list_parse_string(addresses_list_str); // transfer-FULL
+// Writes the end of the element the way sanitize_end does.
+static void stream_write_end(StreamSanitizer *s, StreamElement *element) {
+  GString *output = s->context->output;
+  gboolean need_special_handling = element->flags & TAG_SPECIAL_HANDLING;
 
-  if (addresses) {
-    guint addresses_length = internet_address_list_length(addresses);
-    if (addresses_length) {
-      result = new_addresses_list();
-      collect_addresses_into(addresses, result, addresses_length);
-    }
-    g_object_unref(addresses);
+  if (element->dropped || element->flattened)
+    return;
+
+  if (need_special_handling) {
+    gstr_strip_from(output, element->contents_start);
+    g_string_append_c(output, '\n');
   }
-  return result;
+
+  if (!(element->flags & TAG_EMPTY))
+    g_string_append_printf(output, "</%s>", gumbo_normalized_tagname(element->tag));
+
+  if (need_special_handling)
+    g_string_append_c(output, '\n');
 }
 
 
-static AddressesList *collect_addresses(InternetAddressList *list) {
-  g_return_val_if_fail(list != NULL, NULL);
+// Shifts the positions of the open elements written after the position of
+// the output where text was inserted. The text is inserted within them, as
+// it is for an element closed already.
+static void stream_shift_open(StreamSanitizer *s, GString *output, gsize at, gsize length) {
+  guint i;
 
-  AddressesList* result = NULL;
-  guint size = internet_address_list_length(list);
-  if (size) {
-    result = new_addresses_list();
-    collect_addresses_into(list, result, size);
+  for (i = 0; i < s->open->len; i++) {
+    StreamElement *element = &g_array_index(s->open, StreamElement, i);
+    if (element->output != output)
+      continue;
+    if (element->start > at)
+      element->start += length;
+    if (element->contents_start > at)
+      element->contents_start += length;
+    if (element->foster_at > at)
+      element->foster_at += length;
   }
-  return result;
 }
 
 
-static AddressesList *get_from_addresses(GMimeMessage *message) {
-  const gchar *from_str = g_mime_message_get_sender(message); // transfer-none
-  if (from_str)
-    return collect_str_addresses(from_str);
-  return NULL;
+// Adds what was written for content moved out of the table at the index
+// to the content going in front of it, and writes into the output of the
+// table again. The content is only put in front of the table once it is
+// closed, so that the table is moved once rather than for every piece.
+static void stream_add_fostered(StreamSanitizer *s, gint table_index, GString *table_output) {
+  StreamElement *table = &g_array_index(s->open, StreamElement, table_index);
+  GString *fostered = s->context->output;
+
+  s->context->output_aside += fostered->len;
+  s->context->output_aside -= table_output->len;
+  if (!table->fostered) {
+    table->fostered = fostered;
+  } else {
+    g_string_append_len(table->fostered, fostered->str, fostered->len);
+    g_string_free(fostered, TRUE);
+  }
+  s->context->output = table_output;
 }
 
 
-static AddressesList *get_reply_to_addresses(GMimeMessage *message) {
-  const gchar *reply_to_string = g_mime_message_get_reply_to(message); // transfer-none
-  if (reply_to_string)
-    return collect_str_addresses(reply_to_string);
-  return NULL;
+// Puts the content moved out of the table, closed, in front of it.
+static void stream_insert_fostered(StreamSanitizer *s, StreamElement *table) {
+  if (table->output == s->context->output)
+    s->context->output_aside -= table->fostered->len;
+  g_string_insert_len(table->output, table->foster_at, table->fostered->str, table->fostered->len);
+  stream_shift_open(s, table->output, table->foster_at, table->fostered->len);
+  g_string_free(table->fostered, TRUE);
+  table->fostered = NULL;
 }
 
 
-static AddressesList *get_to_addresses(GMimeMessage *message) {
-  InternetAddressList *recipients_to = g_mime_message_get_recipients(message, GMIME_RECIPIENT_TYPE_TO); // transfer-none
-  if (recipients_to)
-    return collect_addresses(recipients_to);
-  return NULL;
+// Puts the tags of the formatting elements the block, closed, was moved out
+// of around its start tag.
+static void stream_insert_adopted(StreamSanitizer *s, StreamElement *block) {
+  GString *before = block->adopted_before;
+  GString *after = block->adopted_after;
+
+  if (block->output == s->context->output)
+    s->context->output_aside -= before->len + after->len;
+  g_string_insert_len(block->output, block->contents_start, after->str, after->len);
+  stream_shift_open(s, block->output, block->contents_start, after->len);
+  g_string_insert_len(block->output, block->start, before->str, before->len);
+  stream_shift_open(s, block->output, block->start, before->len);
+  g_string_free(before, TRUE);
+  g_string_free(after, TRUE);
+  block->adopted_before = block->adopted_after = NULL;
 }
 
 
-static AddressesList *get_cc_addresses(GMimeMessage *message) {
-  InternetAddressList *recipients_cc = g_mime_message_get_recipients(message, GMIME_RECIPIENT_TYPE_CC); // transfer-none
-  if (recipients_cc)
-    return collect_addresses(recipients_cc);
-  return NULL;
-}
+// Writes the start tag of the element with the attributes given, the way
+// sanitize_start does.
+static void stream_write_start(StreamSanitizer *s, StreamElement *element, GString *attribute_data, GArray *attributes) {
+  SanitizerContext *context = s->context;
+  GString *output = context->output;
+  guint i;
+
+  if (element->dropped || element->flattened)
+    return;
 
+  g_string_append_c(output, '<');
+  g_string_append(output, gumbo_normalized_tagname(element->tag));
 
-static AddressesList *get_bcc_addresses(GMimeMessage *message) {
-  InternetAddressList *recipients_bcc = g_mime_message_get_recipients(message, GMIME_RECIPIENT_TYPE_BCC); // transfer-none
-  if (recipients_bcc)
-    return collect_addresses(recipients_bcc);
-  return NULL;
+  for (i = 0; attributes && i < attributes->len; i++) {
+    StreamAttribute *at = &g_array_index(attributes, StreamAttribute, i);
+    append_attribute(context, element->tag, attribute_data->str + at->name, attribute_data->str + at->value,
+                     at->quote);
+  }
+
+  if ((element->flags & TAG_EMPTY) && !context->minify)
+    g_string_append_c(output, '/');
+  g_string_append_c(output, '>');
+
+  if (element->flags & TAG_SPECIAL_HANDLING)
+    g_string_append_c(output, '\n');
 }
 
 
-static MessageBody* get_body(CollectedPart *body_part, gboolean sanitize_body, GPtrArray *inlines) {
-  g_return_val_if_fail(body_part != NULL, NULL);
+// Makes an element of the tag, a child of the parent given.
+static StreamElement new_stream_element(StreamSanitizer *s, GumboTag tag, StreamElement *parent) {
+  guint max_depth = s->context->max_depth;
+  StreamElement element = { tag, NULL, 0, FALSE, FALSE, FALSE, parent ? parent->depth + 1 : 1, ++s->serial,
+                            s->context->output, 0, 0, 0, NULL, -1, NULL, NULL, NULL };
 
-  MessageBody *mb = new_message_body();
+  element.flags = (tag < GUMBO_TAG_UNKNOWN) ? s->context->policy->tag_flags[tag] : 0;
+  element.dropped = (parent && parent->dropped) || !(element.flags & (TAG_PERMITTED | TAG_SPECIAL_HANDLING));
+  element.flattened = max_depth && element.depth > max_depth;
+  element.preformatted = (parent && parent->preformatted) ||
+                         ((element.flags & TAG_PREFORMATTED) && !element.flattened);
+  element.start = element.foster_at = s->context->output->len;
+  return element;
+}
 
-  // We keep the raw size intentionally
-  mb->size = body_part->content->len;
 
-  mb->content_type = g_strdup(body_part->content_type);
+// Opens an element of the tag, with the given attributes unless it is
+// implied. The element goes in front of the table of foster_table if set.
+static void stream_open(StreamSanitizer *s, GumboTag tag, GString *attribute_data, GArray *attributes) {
+  SanitizerContext *context = s->context;
+  StreamElement *parent = stream_current(s);
+  gint foster_table = s->foster_table;
+  GString *foster_output = NULL;
+
+  if (foster_table >= 0) {
+    // Its parent is the one of the table
+    parent = &g_array_index(s->open, StreamElement, foster_table - 1);
+    foster_output = context->output;
+    context->output_aside += foster_output->len;
+    context->output = g_string_new(NULL);
+    s->foster_table = -1;
+  }
 
-  if (sanitize_body) {
-    // Parse any HTML tags
-    GString *raw_content = g_string_new_len((const gchar*) body_part->content->data, body_part->content->len);
-    GumboOutput* output = gumbo_parse_with_options(&kGumboDefaultOptions, raw_content->str, raw_content->len);
+  StreamElement element = new_stream_element(s, tag, parent);
+  element.foster_table = foster_table;
+  element.foster_output = foster_output;
 
-    // Remove unallowed HTML tags (like scripts, bad href etc..)
-    GString *sanitized_content = sanitize(output->document, inlines);
-    mb->content = sanitized_content;
+  stream_write_start(s, &element, attribute_data, attributes);
+  element.contents_start = context->output->len;
+  s->skip_newline = (tag == GUMBO_TAG_PRE || tag == GUMBO_TAG_LISTING || tag == GUMBO_TAG_TEXTAREA);
 
-    gumbo_destroy_output(&kGumboDefaultOptions, output);
-    g_string_free(raw_content, TRUE);
-  } else {
-    mb->content = g_string_new_len((const gchar*) body_part->content->data, body_part->content->len);
+  if (stream_tag_classes[tag] & STREAM_TAG_VOID) {
+    stream_write_end(s, &element);
+    if (foster_output)
+      stream_add_fostered(s, foster_table, foster_output);
+    return;
   }
 
-  return mb;
+  if (tag == GUMBO_TAG_UNKNOWN)
+    element.name = g_strdup(s->tag_name->str);
+  g_array_append_val(s->open, element);
+  s->open_counts[tag]++;
 }
 
 
-static gchar *guess_content_type_extension(const gchar *content_type) {
-  g_return_val_if_fail(content_type != NULL, NULL);
+// Opens an element of the start tag read last.
+static void stream_open_tag(StreamSanitizer *s, GumboTag tag) {
+  stream_open(s, tag, s->attribute_data, s->attributes);
+}
+
+
+static void stream_remove_formatting(StreamSanitizer *s, gint index) {
+  StreamFormatting *entry = &g_array_index(s->formatting, StreamFormatting, index);
+
+  if (entry->attribute_data)
+    g_string_free(entry->attribute_data, TRUE);
+  if (entry->attributes)
+    g_array_free(entry->attributes, TRUE);
+  g_array_remove_index(s->formatting, index);
+}
+
+
+// Forgets the formatting elements opened since the last marker, and it.
+static void stream_clear_formatting_to_marker(StreamSanitizer *s) {
+  while (s->formatting->len) {
+    gint last = s->formatting->len - 1;
+    gboolean is_marker = g_array_index(s->formatting, StreamFormatting, last).tag == GUMBO_TAG_UNKNOWN;
+    stream_remove_formatting(s, last);
+    if (is_marker)
+      return;
+  }
+}
+
+
+static void stream_pop(StreamSanitizer *s) {
+  StreamElement element = *stream_current(s);
+
+  stream_write_end(s, &element);
+  g_free(element.name);
+  g_array_set_size(s->open, s->open->len - 1);
+  s->open_counts[element.tag]--;
+
+  if (element.adopted_before)
+    stream_insert_adopted(s, &element);
+  if (element.fostered)
+    stream_insert_fostered(s, &element);
+  if (element.foster_output)
+    stream_add_fostered(s, element.foster_table, element.foster_output);
+  if (stream_tag_classes[element.tag] & STREAM_TAG_MARKER)
+    stream_clear_formatting_to_marker(s);
+}
+
+
+// Closes the open elements down to the one at the index, included.
+static void stream_pop_to(StreamSanitizer *s, gint index) {
+  while ((gint) s->open->len > index)
+    stream_pop(s);
+}
+
+
+// Returns the index of the open element of the active formatting entry, or
+// -1. The element is most often still where it was found last, else it is
+// looked for there again only once it has moved.
+static gint stream_find_open(StreamSanitizer *s, StreamFormatting *entry) {
+  gint i = entry->index;
+
+  if (i >= 0 && i < (gint) s->open->len && g_array_index(s->open, StreamElement, i).serial == entry->serial)
+    return i;
+  for (i = (gint) s->open->len - 1; i >= 0; i--)
+    if (g_array_index(s->open, StreamElement, i).serial == entry->serial)
+      return entry->index = i;
+  return -1;
+}
+
+
+// Returns the index of the last active formatting element of the tag
+// after the last marker, or -1.
+static gint stream_find_formatting(StreamSanitizer *s, GumboTag tag) {
+  gint i;
+
+  for (i = (gint) s->formatting->len - 1; i >= 0; i--) {
+    GumboTag formatting_tag = g_array_index(s->formatting, StreamFormatting, i).tag;
+    if (formatting_tag == GUMBO_TAG_UNKNOWN)
+      return -1;
+    if (formatting_tag == tag)
+      return i;
+  }
+  return -1;
+}
+
+
+// Remembers the formatting element just opened for the start tag read
+// last, or a marker without a tag.
+static void stream_push_formatting(StreamSanitizer *s, GumboTag tag) {
+  StreamFormatting entry = { tag, s->serial, (gint) s->open->len - 1, NULL, NULL };
+  gint equal = 0;
+  gint earliest = -1;
+  gint i;
+
+  if (tag != GUMBO_TAG_UNKNOWN) {
+    // Of more than three equal elements, the earliest one is forgotten
+    for (i = (gint) s->formatting->len - 1; i >= 0; i--) {
+      StreamFormatting *other = &g_array_index(s->formatting, StreamFormatting, i);
+      if (other->tag == GUMBO_TAG_UNKNOWN)
+        break;
+      if (other->tag == tag && other->attribute_data->len == s->attribute_data->len &&
+          !memcmp(other->attribute_data->str, s->attribute_data->str, s->attribute_data->len)) {
+        earliest = i;
+        // There are never more than three
+        if (++equal == 3)
+          break;
+      }
+    }
+    if (equal == 3)
+      stream_remove_formatting(s, earliest);
+
+    entry.attribute_data = g_string_new_len(s->attribute_data->str, s->attribute_data->len);
+    entry.attributes = g_array_sized_new(FALSE, FALSE, sizeof(StreamAttribute), s->attributes->len);
+    g_array_append_vals(entry.attributes, s->attributes->data, s->attributes->len);
+  }
+  g_array_append_val(s->formatting, entry);
+}
+
+
+// Reopens the formatting elements closed along with a block, like <b> in
+// "<p><b>bold</p><p>still bold".
+static void stream_reopen_formatting(StreamSanitizer *s) {
+  gint i = (gint) s->formatting->len - 1;
+
+  for (; i >= 0; i--) {
+    StreamFormatting *entry = &g_array_index(s->formatting, StreamFormatting, i);
+    if (entry->tag == GUMBO_TAG_UNKNOWN || stream_find_open(s, entry) >= 0)
+      break;
+  }
+
+  for (i++; i < (gint) s->formatting->len; i++) {
+    StreamFormatting *entry = &g_array_index(s->formatting, StreamFormatting, i);
+    stream_open(s, entry->tag, entry->attribute_data, entry->attributes);
+    entry->serial = s->serial;
+    entry->index = (gint) s->open->len - 1;
+  }
+}
+
+
+static gboolean stream_in_table_context(StreamSanitizer *s) {
+  StreamElement *current = stream_current(s);
+  return current && (current->tag == GUMBO_TAG_TABLE || current->tag == GUMBO_TAG_TBODY ||
+                     current->tag == GUMBO_TAG_THEAD || current->tag == GUMBO_TAG_TFOOT ||
+                     current->tag == GUMBO_TAG_TR);
+}
+
+
+// Tells whether tags are read like in a table rather than in a cell or the
+// body, as they are too within content moved out of the table.
+static gboolean stream_in_table_mode(StreamSanitizer *s) {
+  gint i;
+
+  for (i = (gint) s->open->len - 1; i >= 0; i--) {
+    switch (g_array_index(s->open, StreamElement, i).tag) {
+    case GUMBO_TAG_TABLE:
+    case GUMBO_TAG_TBODY:
+    case GUMBO_TAG_THEAD:
+    case GUMBO_TAG_TFOOT:
+    case GUMBO_TAG_TR:
+      return TRUE;
+    case GUMBO_TAG_TD:
+    case GUMBO_TAG_TH:
+    case GUMBO_TAG_CAPTION:
+    case GUMBO_TAG_SELECT:
+    case GUMBO_TAG_TEMPLATE:
+    case GUMBO_TAG_BODY:
+      return FALSE;
+    default:
+      break;
+    }
+  }
+  return FALSE;
+}
+
+
+// Returns the index of the innermost open table.
+static gint stream_find_table(StreamSanitizer *s) {
+  gint i;
+
+  for (i = (gint) s->open->len - 1; i > 0; i--)
+    if (g_array_index(s->open, StreamElement, i).tag == GUMBO_TAG_TABLE)
+      return i;
+  return -1;
+}
+
+
+// Returns the index of the open select the current element is in, or -1.
+// Only options and their groups are opened within it.
+static gint stream_find_select(StreamSanitizer *s) {
+  gint i;
+
+  for (i = (gint) s->open->len - 1; i >= 0; i--) {
+    GumboTag tag = g_array_index(s->open, StreamElement, i).tag;
+    if (tag == GUMBO_TAG_SELECT)
+      return i;
+    if (tag != GUMBO_TAG_OPTION && tag != GUMBO_TAG_OPTGROUP)
+      return -1;
+  }
+  return -1;
+}
+
+
+// Tells whether the tag ends a select within a table, like the table
+// parts do.
+static gboolean stream_ends_select_in_table(StreamSanitizer *s, GumboTag tag) {
+  return (stream_tag_classes[tag] & STREAM_TAG_TABLE_PART) && tag != GUMBO_TAG_COL && tag != GUMBO_TAG_COLGROUP &&
+         tag != GUMBO_TAG_SCRIPT && tag != GUMBO_TAG_STYLE && tag != GUMBO_TAG_TEMPLATE && stream_find_table(s) >= 0;
+}
+
+
+static gboolean stream_bounds_scope(GumboTag tag, StreamScope scope) {
+  switch (scope) {
+  case STREAM_SCOPE_TABLE:
+    return tag == GUMBO_TAG_HTML || tag == GUMBO_TAG_TABLE || tag == GUMBO_TAG_TEMPLATE;
+  case STREAM_SCOPE_LIST_ITEM:
+    if (tag == GUMBO_TAG_OL || tag == GUMBO_TAG_UL)
+      return TRUE;
+    break;
+  case STREAM_SCOPE_BUTTON:
+    if (tag == GUMBO_TAG_BUTTON)
+      return TRUE;
+    break;
+  default:
+    break;
+  }
+  return stream_tag_classes[tag] & STREAM_TAG_SCOPE;
+}
+
+
+// Returns the index of the open element of the tag within the scope, or
+// -1. Headings stand for one another.
+static gint stream_in_scope(StreamSanitizer *s, GumboTag tag, StreamScope scope) {
+  gboolean is_heading = stream_tag_classes[tag] & STREAM_TAG_HEADING;
+  gint i;
+
+  // Most often none is open, which spares walking deeply nested elements
+  if (is_heading ? !(s->open_counts[GUMBO_TAG_H1] + s->open_counts[GUMBO_TAG_H2] + s->open_counts[GUMBO_TAG_H3] +
+                     s->open_counts[GUMBO_TAG_H4] + s->open_counts[GUMBO_TAG_H5] + s->open_counts[GUMBO_TAG_H6]) :
+                   !s->open_counts[tag])
+    return -1;
+
+  for (i = (gint) s->open->len - 1; i >= 0; i--) {
+    GumboTag open_tag = g_array_index(s->open, StreamElement, i).tag;
+    if (open_tag == tag || (is_heading && (stream_tag_classes[open_tag] & STREAM_TAG_HEADING)))
+      return i;
+    if (stream_bounds_scope(open_tag, scope))
+      return -1;
+  }
+  return -1;
+}
+
+
+// Closes the elements open within the current table, table section (of
+// the tbody level) or row (of the tr level).
+static void stream_clear_to_table_level(StreamSanitizer *s, GumboTag level) {
+  while (s->open->len) {
+    GumboTag tag = stream_current(s)->tag;
+    if (tag == GUMBO_TAG_HTML || tag == GUMBO_TAG_TEMPLATE || tag == GUMBO_TAG_TABLE)
+      return;
+    if (level != GUMBO_TAG_TABLE &&
+        (tag == GUMBO_TAG_TBODY || tag == GUMBO_TAG_THEAD || tag == GUMBO_TAG_TFOOT))
+      return;
+    if (level == GUMBO_TAG_TR && tag == GUMBO_TAG_TR)
+      return;
+    stream_pop(s);
+  }
+}
+
+
+static void stream_close_in_scope(StreamSanitizer *s, GumboTag tag, StreamScope scope) {
+  gint index = stream_in_scope(s, tag, scope);
+  if (index >= 0)
+    stream_pop_to(s, index);
+}
+
+
+// Returns the index of the active formatting element of the open element
+// of the serial, or -1.
+static gint stream_find_formatting_of(StreamSanitizer *s, guint serial) {
+  gint i;
+
+  for (i = (gint) s->formatting->len - 1; i >= 0; i--) {
+    StreamFormatting *entry = &g_array_index(s->formatting, StreamFormatting, i);
+    if (entry->tag != GUMBO_TAG_UNKNOWN && entry->serial == serial)
+      return i;
+  }
+  return -1;
+}
+
+
+/*
+ * Splits the formatting element at the index of the open elements around
+ * the block at the index, the first special element opened within it, the
+ * way the adoption agency of HTML5 moves the block out of it:
+ *
+ *   <b>bold<p>para  becomes  <b>bold</b><p><b>para
+ *
+ * The block is written already, so the end tags of the formatting element
+ * and of the elements within it go in front of its start tag, with the
+ * formatting ones among the three innermost reopened, and the formatting
+ * element is reopened right after it. The tags are kept aside with the
+ * block until it is closed, so that its contents are moved once rather
+ * than for every split. Returns FALSE when the elements are not all
+ * written into the same output, as they are not when the block was moved
+ * out of a table.
+ */
+static gboolean stream_adopt(StreamSanitizer *s, gint entry, gint index, gint block_index) {
+  SanitizerContext *context = s->context;
+  GString *output = context->output;
+  GString *before;
+  GString *after;
+  GArray *clones;
+  StreamElement *parent = index ? &g_array_index(s->open, StreamElement, index - 1) : NULL;
+  StreamElement block = g_array_index(s->open, StreamElement, block_index);
+  StreamElement reopened;
+  StreamFormatting moved;
+  gint bookmark;
+  gint i;
+
+  for (i = index; i <= block_index; i++)
+    if (g_array_index(s->open, StreamElement, i).output != block.output)
+      return FALSE;
+
+  // Farther than three elements out of the block, formatting elements are
+  // not reopened, like the inner loop of the adoption agency leaves them
+  for (i = index + 1; i < block_index - 3; i++) {
+    gint element_entry = stream_find_formatting_of(s, g_array_index(s->open, StreamElement, i).serial);
+    if (element_entry < 0)
+      continue;
+    stream_remove_formatting(s, element_entry);
+    if (element_entry < entry)
+      entry--;
+  }
+
+  before = g_string_new(NULL);
+  after = g_string_new(NULL);
+  clones = g_array_new(FALSE, FALSE, sizeof(StreamElement));
+  bookmark = entry + 1;
+
+  context->output = before;
+  for (i = block_index - 1; i >= index; i--) {
+    StreamElement *element = &g_array_index(s->open, StreamElement, i);
+    if (!element->dropped && !element->flattened && !(element->flags & TAG_EMPTY)) {
+      g_string_append(before, "</");
+      g_string_append(before, element->name ? element->name : gumbo_normalized_tagname(element->tag));
+      g_string_append_c(before, '>');
+    }
+  }
+
+  // The formatting elements left within the formatting element are
+  // reopened around the block, the others end there
+  for (i = index + 1; i < block_index; i++) {
+    StreamElement *element = &g_array_index(s->open, StreamElement, i);
+    gint element_entry = stream_find_formatting_of(s, element->serial);
+    StreamFormatting *formatting;
+
+    if (element_entry < 0)
+      continue;
+    formatting = &g_array_index(s->formatting, StreamFormatting, element_entry);
+
+    StreamElement clone = new_stream_element(s, element->tag, clones->len ?
+                                             &g_array_index(clones, StreamElement, clones->len - 1) : parent);
+    stream_write_start(s, &clone, formatting->attribute_data, formatting->attributes);
+    clone.output = block.output;
+    clone.start = clone.contents_start = clone.foster_at = block.start;
+    g_array_append_val(clones, clone);
+
+    formatting->serial = clone.serial;
+    formatting->index = index + clones->len - 1;
+    bookmark = element_entry + 1;
+  }
+
+  context->output = after;
+  moved = g_array_index(s->formatting, StreamFormatting, entry);
+  reopened = new_stream_element(s, moved.tag, &block);
+  stream_write_start(s, &reopened, moved.attribute_data, moved.attributes);
+  reopened.output = block.output;
+  reopened.start = reopened.contents_start = reopened.foster_at = block.contents_start;
+  context->output = output;
+
+  // The tags of a later split go within the ones of an earlier one
+  context->output_aside += before->len + after->len;
+  if (!block.adopted_before) {
+    block.adopted_before = before;
+    block.adopted_after = after;
+  } else {
+    g_string_append_len(block.adopted_before, before->str, before->len);
+    g_string_prepend_len(block.adopted_after, after->str, after->len);
+    g_string_free(before, TRUE);
+    g_string_free(after, TRUE);
+  }
+
+  // The formatting element moves after the innermost one reopened around
+  // the block
+  moved.serial = reopened.serial;
+  moved.index = index + clones->len + 1;
+  g_array_insert_val(s->formatting, bookmark, moved);
+  g_array_remove_index(s->formatting, entry);
+
+  // Only the formatting element may have been moved out of a table, as the
+  // elements within it are written into the same output
+  gint foster_table = g_array_index(s->open, StreamElement, index).foster_table;
+  GString *foster_output = g_array_index(s->open, StreamElement, index).foster_output;
+
+  for (i = index; i < block_index; i++) {
+    StreamElement *element = &g_array_index(s->open, StreamElement, i);
+    s->open_counts[element->tag]--;
+    g_free(element->name);
+  }
+  for (i = 0; i < (gint) clones->len; i++)
+    s->open_counts[g_array_index(clones, StreamElement, i).tag]++;
+  s->open_counts[reopened.tag]++;
+
+  g_array_remove_range(s->open, index, block_index - index);
+  g_array_insert_vals(s->open, index, clones->data, clones->len);
+  g_array_index(s->open, StreamElement, index + clones->len) = block;
+  g_array_insert_val(s->open, index + clones->len + 1, reopened);
+
+  // The element in its place now ends the content moved out of the table
+  g_array_index(s->open, StreamElement, index).foster_table = foster_table;
+  g_array_index(s->open, StreamElement, index).foster_output = foster_output;
+
+  // Content moved out of the block or a table within it follows its table
+  for (i = index + clones->len + 2; i < (gint) s->open->len; i++) {
+    StreamElement *element = &g_array_index(s->open, StreamElement, i);
+    if (element->foster_table == block_index)
+      element->foster_table = index + clones->len;
+    else if (element->foster_table > block_index)
+      element->foster_table += index + clones->len + 1 - block_index;
+  }
+
+  g_array_free(clones, TRUE);
+  return TRUE;
+}
+
+
+/*
+ * Closes the formatting element of the end tag the way the adoption agency
+ * of HTML5 does. Returns FALSE without such an element, when the end tag
+ * is read like any other.
+ */
+static gboolean stream_end_formatting(StreamSanitizer *s, GumboTag tag) {
+  gint round;
+
+  for (round = 0; round < 8; round++) {
+    gint entry = stream_find_formatting(s, tag);
+    gint index;
+    gint block_index = -1;
+    gint i;
+
+    if (entry < 0)
+      return round > 0;
+
+    index = stream_find_open(s, &g_array_index(s->formatting, StreamFormatting, entry));
+    if (index < 0) {
+      stream_remove_formatting(s, entry);
+      return TRUE;
+    }
+
+    for (i = (gint) s->open->len - 1; i > index; i--) {
+      GumboTag open_tag = g_array_index(s->open, StreamElement, i).tag;
+      // Out of scope, the end tag is ignored
+      if (stream_bounds_scope(open_tag, STREAM_SCOPE_DEFAULT))
+        return TRUE;
+      if (stream_tag_classes[open_tag] & STREAM_TAG_SPECIAL)
+        block_index = i;
+    }
+
+    if (block_index < 0) {
+      stream_pop_to(s, index);
+      stream_remove_formatting(s, entry);
+      return TRUE;
+    }
+
+    if (!stream_adopt(s, entry, index, block_index))
+      return TRUE;
+  }
+  return TRUE;
+}
+
+
+/*
+ * Closes the elements the start tag implies the end of, and opens the
+ * table parts it implies. Returns FALSE when the tag is dropped, as table
+ * parts outside of a table are.
+ */
+static gboolean stream_imply(StreamSanitizer *s, GumboTag tag) {
+  guint16 tag_class = stream_tag_classes[tag];
+  gint i;
+
+  switch (tag) {
+  case GUMBO_TAG_LI:
+  case GUMBO_TAG_DD:
+  case GUMBO_TAG_DT:
+    for (i = (gint) s->open->len - 1; i >= 0; i--) {
+      GumboTag open_tag = g_array_index(s->open, StreamElement, i).tag;
+      if (tag == GUMBO_TAG_LI ? open_tag == GUMBO_TAG_LI : (open_tag == GUMBO_TAG_DD || open_tag == GUMBO_TAG_DT)) {
+        stream_pop_to(s, i);
+        break;
+      }
+      if ((stream_tag_classes[open_tag] & STREAM_TAG_SPECIAL) &&
+          open_tag != GUMBO_TAG_ADDRESS && open_tag != GUMBO_TAG_DIV && open_tag != GUMBO_TAG_P)
+        break;
+    }
+    break;
+  case GUMBO_TAG_A:
+    // A link ends where another one starts
+    if (stream_find_formatting(s, tag) >= 0) {
+      stream_end_formatting(s, tag);
+      i = stream_find_formatting(s, tag);
+      if (i >= 0)
+        stream_remove_formatting(s, i);
+    }
+    break;
+  case GUMBO_TAG_BUTTON:
+    stream_close_in_scope(s, tag, STREAM_SCOPE_DEFAULT);
+    break;
+  case GUMBO_TAG_OPTION:
+  case GUMBO_TAG_OPTGROUP:
+    if (stream_current_is(s, GUMBO_TAG_OPTION))
+      stream_pop(s);
+    if (tag == GUMBO_TAG_OPTGROUP && stream_current_is(s, GUMBO_TAG_OPTGROUP))
+      stream_pop(s);
+    break;
+  case GUMBO_TAG_TD:
+  case GUMBO_TAG_TH:
+  case GUMBO_TAG_TR:
+    if (stream_in_scope(s, GUMBO_TAG_TABLE, STREAM_SCOPE_TABLE) < 0)
+      return FALSE;
+    // A cell ends the open cell, a row ends the whole open row
+    i = MAX(stream_in_scope(s, GUMBO_TAG_TD, STREAM_SCOPE_TABLE), stream_in_scope(s, GUMBO_TAG_TH, STREAM_SCOPE_TABLE));
+    if (i >= 0)
+      stream_pop_to(s, i);
+    stream_clear_to_table_level(s, tag == GUMBO_TAG_TR ? GUMBO_TAG_TBODY : GUMBO_TAG_TR);
+    if (stream_current_is(s, GUMBO_TAG_TABLE))
+      stream_open(s, GUMBO_TAG_TBODY, NULL, NULL);
+    if (tag != GUMBO_TAG_TR && !stream_current_is(s, GUMBO_TAG_TR))
+      stream_open(s, GUMBO_TAG_TR, NULL, NULL);
+    break;
+  case GUMBO_TAG_TBODY:
+  case GUMBO_TAG_THEAD:
+  case GUMBO_TAG_TFOOT:
+  case GUMBO_TAG_CAPTION:
+  case GUMBO_TAG_COLGROUP:
+  case GUMBO_TAG_COL:
+    if (stream_in_scope(s, GUMBO_TAG_TABLE, STREAM_SCOPE_TABLE) < 0)
+      return FALSE;
+    if (tag == GUMBO_TAG_COL && stream_current_is(s, GUMBO_TAG_COLGROUP))
+      break;
+    stream_clear_to_table_level(s, GUMBO_TAG_TABLE);
+    if (tag == GUMBO_TAG_COL)
+      stream_open(s, GUMBO_TAG_COLGROUP, NULL, NULL);
+    break;
+  case GUMBO_TAG_TABLE:
+    // A table does not go straight into another one, it ends it
+    if (stream_in_table_mode(s))
+      stream_pop_to(s, stream_find_table(s));
+    // Without a doctype mail is read in quirks mode, where tables go into paragraphs
+    if (s->has_doctype)
+      stream_close_in_scope(s, GUMBO_TAG_P, STREAM_SCOPE_BUTTON);
+    break;
+  default:
+    break;
+  }
+
+  if (tag_class & STREAM_TAG_CLOSES_P)
+    stream_close_in_scope(s, GUMBO_TAG_P, STREAM_SCOPE_BUTTON);
+
+  if ((tag_class & STREAM_TAG_HEADING) && s->open->len &&
+      (stream_tag_classes[stream_current(s)->tag] & STREAM_TAG_HEADING))
+    stream_pop(s);
+
+  return TRUE;
+}
+
+
+static void stream_open_html(StreamSanitizer *s, gboolean with_attributes) {
+  if (with_attributes)
+    stream_open_tag(s, GUMBO_TAG_HTML);
+  else
+    stream_open(s, GUMBO_TAG_HTML, NULL, NULL);
+  s->has_html = TRUE;
+}
+
+
+static void stream_open_body(StreamSanitizer *s, gboolean with_attributes) {
+  if (!s->has_html)
+    stream_open_html(s, FALSE);
+  if (stream_current_is(s, GUMBO_TAG_HEAD))
+    stream_pop(s);
+  if (with_attributes)
+    stream_open_tag(s, GUMBO_TAG_BODY);
+  else
+    stream_open(s, GUMBO_TAG_BODY, NULL, NULL);
+  s->has_body = TRUE;
+}
+
+
+static gboolean stream_is_hidden_input(StreamSanitizer *s) {
+  guint i;
+
+  for (i = 0; i < s->attributes->len; i++) {
+    StreamAttribute *at = &g_array_index(s->attributes, StreamAttribute, i);
+    if (!strcmp(s->attribute_data->str + at->name, "type"))
+      return !g_ascii_strcasecmp(s->attribute_data->str + at->value, "hidden");
+  }
+  return FALSE;
+}
+
+
+static void stream_start_tag(StreamSanitizer *s, GumboTag tag) {
+  gint select;
+
+  if (tag == GUMBO_TAG_HTML) {
+    if (!s->has_html)
+      stream_open_html(s, TRUE);
+    return;
+  }
+
+  if (!s->has_body) {
+    if (!s->has_html)
+      stream_open_html(s, FALSE);
+
+    if (tag == GUMBO_TAG_HEAD) {
+      if (!s->has_head)
+        stream_open_tag(s, GUMBO_TAG_HEAD);
+      s->has_head = TRUE;
+      return;
+    }
+    if (stream_tag_classes[tag] & STREAM_TAG_HEAD) {
+      stream_open_tag(s, tag);
+      return;
+    }
+
+    stream_open_body(s, tag == GUMBO_TAG_BODY);
+    if (tag == GUMBO_TAG_BODY)
+      return;
+  } else if (tag == GUMBO_TAG_BODY || tag == GUMBO_TAG_HEAD) {
+    return;
+  }
+
+  // Within a select only options are opened, and scripts, other tags end
+  // it or are ignored
+  select = stream_find_select(s);
+  if (select >= 0 && tag != GUMBO_TAG_OPTION && tag != GUMBO_TAG_OPTGROUP && tag != GUMBO_TAG_SCRIPT &&
+      tag != GUMBO_TAG_TEMPLATE) {
+    if (tag != GUMBO_TAG_SELECT && tag != GUMBO_TAG_INPUT && tag != GUMBO_TAG_KEYGEN &&
+        tag != GUMBO_TAG_TEXTAREA && !stream_ends_select_in_table(s, tag))
+      return;
+    stream_pop_to(s, select);
+    if (tag == GUMBO_TAG_SELECT)
+      return;
+  }
+
+  // A column group only holds columns
+  if (stream_current_is(s, GUMBO_TAG_COLGROUP) && tag != GUMBO_TAG_COL && tag != GUMBO_TAG_TEMPLATE)
+    stream_pop(s);
+
+  if (!stream_imply(s, tag))
+    return;
+
+  if (stream_in_table_context(s) && !(stream_tag_classes[tag] & STREAM_TAG_TABLE_PART)) {
+    // Forms stay in tables, empty, and so do hidden inputs
+    if (tag == GUMBO_TAG_FORM) {
+      stream_open_tag(s, tag);
+      stream_pop(s);
+      return;
+    }
+    if (tag != GUMBO_TAG_INPUT || !stream_is_hidden_input(s))
+      s->foster_table = stream_find_table(s);
+  } else if (stream_tag_classes[tag] & STREAM_TAG_REOPENS) {
+    stream_reopen_formatting(s);
+  }
+
+  stream_open_tag(s, tag);
+
+  if (stream_tag_classes[tag] & STREAM_TAG_FORMATTING)
+    stream_push_formatting(s, tag);
+  else if (stream_tag_classes[tag] & STREAM_TAG_MARKER)
+    stream_push_formatting(s, GUMBO_TAG_UNKNOWN);
+}
+
+
+static void stream_end_tag(StreamSanitizer *s, GumboTag tag) {
+  gint i;
+
+  if (!s->has_body) {
+    // Before the body only the end of the head counts, and the end of raw
+    // text like the one of <title>
+    if (stream_current_is(s, tag) && (stream_tag_classes[tag] & STREAM_TAG_RAW_TEXT)) {
+      stream_pop(s);
+      return;
+    }
+    if (tag == GUMBO_TAG_HTML || tag == GUMBO_TAG_BODY)
+      stream_open_body(s, FALSE);
+    else if (tag != GUMBO_TAG_HEAD && tag != GUMBO_TAG_BR)
+      return;
+  }
+
+  // Within a select other end tags are ignored, but for the ones of the
+  // table parts it is in
+  i = stream_find_select(s);
+  if (i >= 0 && tag != GUMBO_TAG_OPTION && tag != GUMBO_TAG_OPTGROUP && tag != GUMBO_TAG_SELECT) {
+    if (!stream_ends_select_in_table(s, tag) || stream_in_scope(s, tag, STREAM_SCOPE_TABLE) < 0)
+      return;
+    stream_pop_to(s, i);
+  }
+
+  switch (tag) {
+  case GUMBO_TAG_HTML:
+  case GUMBO_TAG_BODY:
+    // Whatever follows still goes into the body
+    return;
+  case GUMBO_TAG_HEAD:
+    if (stream_current_is(s, GUMBO_TAG_HEAD))
+      stream_pop(s);
+    return;
+  case GUMBO_TAG_BR:
+    // Read as a <br>
+    g_array_set_size(s->attributes, 0);
+    stream_start_tag(s, GUMBO_TAG_BR);
+    return;
+  case GUMBO_TAG_P:
+    // Closing no paragraph makes an empty one
+    if (stream_in_scope(s, GUMBO_TAG_P, STREAM_SCOPE_BUTTON) < 0) {
+      g_array_set_size(s->attributes, 0);
+      stream_start_tag(s, GUMBO_TAG_P);
+    }
+    stream_close_in_scope(s, GUMBO_TAG_P, STREAM_SCOPE_BUTTON);
+    return;
+  default:
+    break;
+  }
+
+  if ((stream_tag_classes[tag] & STREAM_TAG_FORMATTING) && stream_end_formatting(s, tag))
+    return;
+
+  if (stream_tag_classes[tag] & STREAM_TAG_SPECIAL) {
+    StreamScope scope = STREAM_SCOPE_DEFAULT;
+    if (tag == GUMBO_TAG_LI)
+      scope = STREAM_SCOPE_LIST_ITEM;
+    else if (tag == GUMBO_TAG_TABLE || tag == GUMBO_TAG_TBODY || tag == GUMBO_TAG_THEAD || tag == GUMBO_TAG_TFOOT ||
+             tag == GUMBO_TAG_TR || tag == GUMBO_TAG_TD || tag == GUMBO_TAG_TH ||
+             tag == GUMBO_TAG_CAPTION || tag == GUMBO_TAG_COLGROUP)
+      scope = STREAM_SCOPE_TABLE;
+    stream_close_in_scope(s, tag, scope);
+    return;
+  }
+
+  // Any other end tag closes the nearest element of its name, unless a
+  // special element is open within it
+  for (i = (gint) s->open->len - 1; i >= 0; i--) {
+    StreamElement *element = &g_array_index(s->open, StreamElement, i);
+    if (tag != GUMBO_TAG_UNKNOWN ? element->tag == tag :
+        (element->tag == GUMBO_TAG_UNKNOWN && !strcmp(element->name, s->tag_name->str))) {
+      stream_pop_to(s, i);
+      return;
+    }
+    if (stream_tag_classes[element->tag] & STREAM_TAG_SPECIAL)
+      return;
+  }
+}
+
+
+static void stream_write_text(StreamSanitizer *s, StreamElement *element, const gchar *text, gsize length) {
+  GString *output = s->context->output;
+
+  if (element->dropped)
+    return;
+
+  if (s->context->minify && !element->preformatted)
+    gstr_append_collapsed(output, text, length);
+  else
+    gstr_append_escaped(output, text, length, 0);
+}
+
+
+// Writes text into the current element, decoding its references if asked.
+static void stream_text(StreamSanitizer *s, const gchar *text, gsize length, gboolean references) {
+  StreamElement *current;
+  gboolean is_blank = TRUE;
+  gsize i;
+
+  if (s->skip_newline) {
+    s->skip_newline = FALSE;
+    if (length && *text == '\r') {
+      text++;
+      length--;
+    }
+    if (length && *text == '\n') {
+      text++;
+      length--;
+    }
+  }
+
+  if (!length)
+    return;
+
+  if (memchr(text, '\r', length) || (references && memchr(text, '&', length))) {
+    g_string_truncate(s->text, 0);
+    append_decoded_text(s->text, text, length, references, FALSE);
+    text = s->text->str;
+    length = s->text->len;
+  }
+
+  for (i = 0; i < length && is_blank; i++)
+    is_blank = g_ascii_isspace(text[i]);
+
+  if (!s->has_body) {
+    // Whitespace before the body is dropped, as is the text of head elements
+    current = stream_current(s);
+    if (is_blank || (current && current->tag != GUMBO_TAG_HTML && current->tag != GUMBO_TAG_HEAD))
+      return;
+    stream_open_body(s, FALSE);
+  }
+
+  if (!is_blank && stream_current_is(s, GUMBO_TAG_COLGROUP))
+    stream_pop(s);
+
+  current = stream_current(s);
+  if (stream_tag_classes[current->tag] & STREAM_TAG_RAW_TEXT) {
+    stream_write_text(s, current, text, length);
+  } else if (stream_find_select(s) >= 0) {
+    stream_write_text(s, current, text, length);
+  } else if (stream_in_table_context(s)) {
+    gint table = stream_find_table(s);
+
+    // Text in a table, unless blank, goes in front of it
+    if (is_blank || table <= 0) {
+      stream_write_text(s, current, text, length);
+    } else {
+      GString *table_output = s->context->output;
+      s->context->output_aside += table_output->len;
+      s->context->output = g_string_new(NULL);
+      stream_write_text(s, &g_array_index(s->open, StreamElement, table - 1), text, length);
+      stream_add_fostered(s, table, table_output);
+    }
+  } else {
+    stream_reopen_formatting(s);
+    stream_write_text(s, stream_current(s), text, length);
+  }
+}
+
+
+static void stream_add_attribute(StreamSanitizer *s, const gchar *name, gsize name_length,
+                                 const gchar *value, gsize value_length, gchar quote) {
+  GString *data = s->attribute_data;
+  StreamAttribute attribute;
+  guint i;
+
+  attribute.name = data->len;
+  for (i = 0; i < name_length; i++)
+    g_string_append_c(data, g_ascii_tolower(name[i]));
+  g_string_append_c(data, '\0');
+
+  // Of attributes of the same name, the first one is kept
+  for (i = 0; i < s->attributes->len; i++) {
+    if (!strcmp(data->str + g_array_index(s->attributes, StreamAttribute, i).name, data->str + attribute.name)) {
+      g_string_truncate(data, attribute.name);
+      return;
+    }
+  }
+
+  attribute.value = data->len;
+  append_decoded_text(data, value, value_length, TRUE, TRUE);
+  g_string_append_c(data, '\0');
+  attribute.quote = quote;
+  g_array_append_val(s->attributes, attribute);
+}
+
+
+/*
+ * Reads the name and attributes of the tag at text, just past its '<' or
+ * '</'. Returns the position after its '>', or NULL when the input ends
+ * first, which drops the tag.
+ */
+static const gchar *stream_read_tag(StreamSanitizer *s, const gchar *text, const gchar *end) {
+  const gchar *p = text;
+
+  g_string_truncate(s->tag_name, 0);
+  g_string_truncate(s->attribute_data, 0);
+  g_array_set_size(s->attributes, 0);
+
+  for (; p < end && !g_ascii_isspace(*p) && *p != '/' && *p != '>'; p++)
+    g_string_append_c(s->tag_name, g_ascii_tolower(*p));
+
+  for (;;) {
+    while (p < end && (g_ascii_isspace(*p) || *p == '/'))
+      p++;
+    if (p == end)
+      return NULL;
+    if (*p == '>')
+      return p + 1;
+
+    const gchar *name = p++;
+    while (p < end && !g_ascii_isspace(*p) && *p != '/' && *p != '>' && *p != '=')
+      p++;
+    gsize name_length = p - name;
+    while (p < end && g_ascii_isspace(*p))
+      p++;
+
+    const gchar *value = p;
+    gsize value_length = 0;
+    gchar quote = 0;
+
+    if (p < end && *p == '=') {
+      p++;
+      while (p < end && g_ascii_isspace(*p))
+        p++;
+      if (p < end && (*p == '"' || *p == '\'')) {
+        quote = *p++;
+        const gchar *value_end = memchr(p, quote, end - p);
+        if (!value_end)
+          return NULL;
+        value = p;
+        value_length = value_end - p;
+        p = value_end + 1;
+      } else {
+        value = p;
+        while (p < end && !g_ascii_isspace(*p) && *p != '>')
+          p++;
+        value_length = p - value;
+      }
+    }
+    stream_add_attribute(s, name, name_length, value, value_length, quote);
+  }
+}
+
+
+// Finds the end tag of the raw text element read last, or the end of input.
+static const gchar *stream_find_raw_text_end(StreamSanitizer *s, GumboTag tag, const gchar *text, const gchar *end) {
+  const gchar *name = s->tag_name->str;
+  gsize name_length = s->tag_name->len;
+  const gchar *p = text;
+
+  if (tag == GUMBO_TAG_PLAINTEXT)
+    return end;
+
+  while (p < end && (p = memchr(p, '<', end - p))) {
+    const gchar *after_name = p + 2 + name_length;
+    if (after_name < end && p[1] == '/' && !g_ascii_strncasecmp(p + 2, name, name_length) &&
+        (g_ascii_isspace(*after_name) || *after_name == '/' || *after_name == '>'))
+      return p;
+    p++;
+  }
+  return end;
+}
+
+
+/*
+ * Reads the markup at the '<' of text and acts on it. Returns the position
+ * after it, or NULL when the '<' starts no markup and is text.
+ */
+static const gchar *stream_markup(StreamSanitizer *s, const gchar *text, const gchar *end) {
+  const gchar *p = text + 1;
+
+  // A newline right after <pre> only counts as the next token
+  s->skip_newline = FALSE;
+
+  if (p == end)
+    return NULL;
+
+  if (g_ascii_isalpha(*p)) {
+    p = stream_read_tag(s, p, end);
+    if (!p)
+      return end;
+
+    GumboTag tag = gumbo_tag_enum(s->tag_name->str);
+    stream_start_tag(s, tag);
+
+    // Unless the tag was ignored
+    if ((stream_tag_classes[tag] & STREAM_TAG_RAW_TEXT) && stream_current_is(s, tag)) {
+      const gchar *contents_end = stream_find_raw_text_end(s, tag, p, end);
+      stream_text(s, p, contents_end - p, stream_tag_classes[tag] & STREAM_TAG_REFERENCES);
+      p = contents_end;
+      // Without an end tag it ends with the document
+      if (p == end && stream_current_is(s, tag))
+        stream_pop(s);
+    }
+    return p;
+  }
+
+  if (*p == '/') {
+    p++;
+    if (p == end)
+      return NULL;
+    if (g_ascii_isalpha(*p)) {
+      p = stream_read_tag(s, p, end);
+      if (!p)
+        return end;
+      stream_end_tag(s, gumbo_tag_enum(s->tag_name->str));
+      return p;
+    }
+    if (*p == '>')
+      return p + 1;
+  } else if (*p == '!') {
+    if (end - p >= 3 && !strncmp(p, "!--", 3)) {
+      // Comments end at "-->", or at "--!>" past their start
+      const gchar *comment_end = p + 1;
+      while ((comment_end = memchr(comment_end, '>', end - comment_end)) &&
+             !(comment_end - p >= 3 && comment_end[-1] == '-' && comment_end[-2] == '-') &&
+             !(comment_end - p >= 6 && comment_end[-1] == '!' && comment_end[-2] == '-' && comment_end[-3] == '-'))
+        comment_end++;
+      return comment_end ? comment_end + 1 : end;
+    }
+    if (end - p >= 8 && !g_ascii_strncasecmp(p + 1, "doctype", 7))
+      s->has_doctype = TRUE;
+  } else if (*p != '?') {
+    return NULL;
+  }
+
+  // Doctypes, processing instructions and bogus comments end at the next '>'
+  p = memchr(p, '>', end - p);
+  return p ? p + 1 : end;
+}
+
+
+static GString *sanitize_stream(const gchar *html, gsize length, GPtrArray* inlines_ary, const GmimexOptions *options,
+                                gboolean *truncated) {
+  SanitizerContext context;
+  StreamSanitizer s;
+  const gchar *p = html;
+  const gchar *end = html + length;
+
+  init_stream_tag_classes();
+  init_sanitizer_context(&context, inlines_ary, options, length);
+
+  s.context = &context;
+  s.open = g_array_new(FALSE, FALSE, sizeof(StreamElement));
+  s.formatting = g_array_new(FALSE, FALSE, sizeof(StreamFormatting));
+  memset(s.open_counts, 0, sizeof(s.open_counts));
+  s.serial = 0;
+  s.foster_table = -1;
+  s.has_doctype = s.has_html = s.has_head = s.has_body = FALSE;
+  s.skip_newline = FALSE;
+  s.tag_name = g_string_new(NULL);
+  s.attribute_data = g_string_new(NULL);
+  s.attributes = g_array_new(FALSE, FALSE, sizeof(StreamAttribute));
+  s.text = g_string_new(NULL);
+
+  g_string_append(context.output, "<!DOCTYPE html>\n");
+
+  // Past the limits the document ends, with every element open closed
+  while (p < end && sanitizer_within_limits(&context)) {
+    if (*p == '<') {
+      const gchar *next = stream_markup(&s, p, end);
+      if (next) {
+        p = next;
+        continue;
+      }
+    }
+
+    // Text runs up to the next '<'
+    const gchar *text_end = memchr(p + 1, '<', end - p - 1);
+    if (!text_end)
+      text_end = end;
+    stream_text(&s, p, text_end - p, TRUE);
+    p = text_end;
+  }
+
+  // Even an empty document has a body
+  if (!s.has_body)
+    stream_open_body(&s, FALSE);
+  stream_pop_to(&s, 0);
+
+  while (s.formatting->len)
+    stream_remove_formatting(&s, s.formatting->len - 1);
+
+  g_array_free(s.open, TRUE);
+  g_array_free(s.formatting, TRUE);
+  g_string_free(s.tag_name, TRUE);
+  g_string_free(s.attribute_data, TRUE);
+  g_array_free(s.attributes, TRUE);
+  g_string_free(s.text, TRUE);
+
+  return finish_sanitizer_context(&context, truncated);
+}
+
+
+// Returns the position after the '>' of the tag at text, just past its '<'
+// or '</', reading its attributes like stream_read_tag, or NULL when the
+// input ends first.
+static const gchar *html_skip_tag(const gchar *text, const gchar *end) {
+  const gchar *p = text;
+
+  for (;;) {
+    while (p < end && (g_ascii_isspace(*p) || *p == '/'))
+      p++;
+    if (p == end)
+      return NULL;
+    if (*p == '>')
+      return p + 1;
+
+    p++;
+    while (p < end && !g_ascii_isspace(*p) && *p != '/' && *p != '>' && *p != '=')
+      p++;
+    while (p < end && g_ascii_isspace(*p))
+      p++;
+    if (p == end || *p != '=')
+      continue;
+
+    p++;
+    while (p < end && g_ascii_isspace(*p))
+      p++;
+    if (p < end && (*p == '"' || *p == '\'')) {
+      p = memchr(p + 1, *p, end - p - 1);
+      if (!p)
+        return NULL;
+      p++;
+    } else {
+      while (p < end && !g_ascii_isspace(*p) && *p != '>')
+        p++;
+    }
+  }
+}
+
+
+/*
+ * Returns the given length cut down to the end of the last tag, comment or
+ * doctype the tokenizer completes within it, for HTML longer than that, so
+ * that no tag is left half open. The markup is read like the streaming
+ * sanitizer reads it: a '>' within a quoted attribute value, a comment or
+ * the raw text of a script ends nothing. Without any markup completed within
+ * it the HTML is cut without splitting a UTF-8 sequence.
+ */
+static gsize html_cut_length(const gchar *html, gsize length) {
+  const gchar *end = html + length;
+  const gchar *p = html;
+  const gchar *cut = NULL;
+
+  init_stream_tag_classes();
+
+  while (p < end && (p = memchr(p, '<', end - p))) {
+    p++;
+    if (p == end)
+      break;
+
+    if (g_ascii_isalpha(*p) || (*p == '/' && p + 1 < end && g_ascii_isalpha(p[1]))) {
+      gboolean is_end_tag = (*p == '/');
+      const gchar *name = is_end_tag ? p + 1 : p;
+      gsize name_length = 0;
+      while (name + name_length < end && !g_ascii_isspace(name[name_length]) &&
+             name[name_length] != '/' && name[name_length] != '>')
+        name_length++;
+
+      p = html_skip_tag(name + name_length, end);
+      if (!p)
+        break;
+      cut = p;
+
+      // Raw text runs up to the end tag of its element, if any within the HTML
+      gchar tag_name[16];
+      gsize i;
+      if (is_end_tag || name_length >= sizeof(tag_name))
+        continue;
+      for (i = 0; i < name_length; i++)
+        tag_name[i] = g_ascii_tolower(name[i]);
+      tag_name[name_length] = '\0';
+      GumboTag tag = gumbo_tag_enum(tag_name);
+      if (!(stream_tag_classes[tag] & STREAM_TAG_RAW_TEXT))
+        continue;
+      if (tag == GUMBO_TAG_PLAINTEXT)
+        break;
+
+      const gchar *raw_end = p;
+      while ((raw_end = memchr(raw_end, '<', end - raw_end))) {
+        const gchar *after_name = raw_end + 2 + name_length;
+        if (after_name < end && raw_end[1] == '/' && !g_ascii_strncasecmp(raw_end + 2, name, name_length) &&
+            (g_ascii_isspace(*after_name) || *after_name == '/' || *after_name == '>'))
+          break;
+        raw_end++;
+      }
+      if (!raw_end)
+        break;
+      p = raw_end;
+    } else if (end - p >= 3 && !strncmp(p, "!--", 3)) {
+      // Comments end at "-->", or at "--!>" past their start
+      const gchar *comment_end = p + 1;
+      while ((comment_end = memchr(comment_end, '>', end - comment_end)) &&
+             !(comment_end - p >= 3 && comment_end[-1] == '-' && comment_end[-2] == '-') &&
+             !(comment_end - p >= 6 && comment_end[-1] == '!' && comment_end[-2] == '-' && comment_end[-3] == '-'))
+        comment_end++;
+      if (!comment_end)
+        break;
+      p = cut = comment_end + 1;
+    } else if (*p == '!' || *p == '?' || *p == '/') {
+      // Doctypes, processing instructions and bogus comments end at the next '>'
+      p = memchr(p, '>', end - p);
+      if (!p)
+        break;
+      p = cut = p + 1;
+    }
+  }
+
+  if (cut)
+    return cut - html;
+
+  while (length && ((guchar) html[length] & 0xc0) == 0x80)
+    length--;
+  return length;
+}
+
+
+// Cuts the content down to the given length, at the end of the last complete
+// tag when there is one.
+static void truncate_html(GString *content, gsize length) {
+  if (content->len <= length)
+    return;
+
+  g_string_truncate(content, html_cut_length(content->str, length));
+}
+
+
+/*
+ * Textizer -> fetches text content out of HTML
+ *
+static GString *textize(const GumboNode* node) {
+  if (node->type == GUMBO_NODE_TEXT) {
+    return g_string_new(node->v.text.text);
+  } else if (node->type == GUMBO_NODE_ELEMENT &&
+             node->v.element.tag != GUMBO_TAG_SCRIPT &&
+             node->v.element.tag != GUMBO_TAG_STYLE) {
+    const GumboVector* children = &node->v.element.children;
+    GString *contents = g_string_new(NULL);
+    guint i;
+    for (i = 0; i < children->length; ++i) {
+      GString *text = textize((GumboNode*) children->data[i]);
+      gstr_strip(text);
+      if (i && text->len && contents->len)
+        g_string_append_c(contents, ' ');
+      g_string_append(contents, text->str);
+      g_string_free(text, TRUE);
+    }
+    return contents;
+  } else {
+    return g_string_new(NULL);
+  }
+}
+*/
+
+
+/*
+ *
+ *
+ */
+static GMimeMessage* gmime_message_from_stream(GMimeStream *stream) {
+  g_return_val_if_fail(stream != NULL, NULL);
+
+  GMimeParser *parser = g_mime_parser_new_with_stream(stream);
+  if (!parser) {
+    g_printerr("failed to create parser\r\n");
+    return NULL;
+  }
+
+  GMimeMessage *message = g_mime_parser_construct_message(parser);
+  g_object_unref (parser);
+  if (!message) {
+    g_printerr("failed to construct message\r\n");
+    return NULL;
+  }
+
+  return message;
+}
+
+
+/*
+ *
+ *
+ */
+static GMimeMessage *gmime_message_from_file(FILE *file) {
+  g_return_val_if_fail(file != NULL, NULL);
+
+  GMimeStream *stream = g_mime_stream_file_new(file);
+
+  if (!stream) {
+    g_printerr("file stream could not be opened\r\n");
+    fclose(file);
+    return NULL;
+  }
+
+  // Being owner of the stream will automatically close the file when released
+  g_mime_stream_file_set_owner(GMIME_STREAM_FILE(stream), TRUE);
+
+  GMimeMessage *message = gmime_message_from_stream(stream);
+  g_object_unref (stream);
+  if (!message) {
+    g_printerr("message could not be constructed from stream\r\n");
+    return NULL;
+  }
+
+  return message;
+}
+
+
+/*
+ * Parses a message from the start of its file, of which the data holds the
+ * header block and maybe some of the body. A multipart body is parsed from
+ * the data too when its structure is all there, that is when the data holds
+ * the whole file or the closing boundary of the body. Otherwise the message
+ * is parsed from its headers alone.
+ */
+static GMimeMessage *gmime_message_from_window(const gchar *data, gsize length, gsize headers_length, gboolean complete) {
+  GMimeStream *stream = g_mime_stream_mem_new_with_buffer(data, headers_length);
+  GMimeMessage *message = gmime_message_from_stream(stream);
+  g_object_unref(stream);
+
+  GMimeObject *body = message ? g_mime_message_get_mime_part(message) : NULL;
+  if (!body || !GMIME_IS_MULTIPART(body) || length == headers_length)
+    return message;
+
+  if (!complete) {
+    const gchar *boundary = g_mime_multipart_get_boundary(GMIME_MULTIPART(body));
+    gchar *delimiter = boundary ? g_strdup_printf("\n--%s--", boundary) : NULL;
+    complete = delimiter && g_strstr_len(data + headers_length, length - headers_length, delimiter);
+    g_free(delimiter);
+  }
+  if (!complete)
+    return message;
+
+  g_object_unref(message);
+  stream = g_mime_stream_mem_new_with_buffer(data, length);
+  message = gmime_message_from_stream(stream);
+  g_object_unref(stream);
+  return message;
+}
+
+
+/*
+ * Compressed messages
+ *
+ * Message files may be stored compressed (like with Dovecot's zlib plugin),
+ * in which case they are recognized by their magic bytes and decompressed
+ * while they are parsed and read. When only headers are needed we stop
+ * decompressing once the header block and the window of a batched read
+ * have been seen, the structure of the body being read from that window
+ * when it is all there.
+ */
+typedef enum MessageCompression {
+  MESSAGE_COMPRESSION_NONE,
+  MESSAGE_COMPRESSION_GZIP,
+  MESSAGE_COMPRESSION_ZSTD
+} MessageCompression;
+
+
+static MessageCompression detect_compression(FILE *file) {
+  guchar magic[4];
+  size_t nread = fread(magic, 1, sizeof(magic), file);
+  rewind(file);
+
+  if (nread >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+    return MESSAGE_COMPRESSION_GZIP;
+
+  if (nread == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+    return MESSAGE_COMPRESSION_ZSTD;
+
+  return MESSAGE_COMPRESSION_NONE;
+}
+
+
+// Returns the length of the header block including the empty line that ends it,
+// or 0 if the end of the headers is not within the data.
+static gsize header_block_length(const guint8 *data, gsize length) {
+  gsize i;
+  for (i = 0; i + 1 < length; i++) {
+    if (data[i] != '\n')
+      continue;
+    if (data[i + 1] == '\n')
+      return i + 2;
+    if (data[i + 1] == '\r' && i + 2 < length && data[i + 2] == '\n')
+      return i + 3;
+  }
+  return 0;
+}
+
+
+// Appends decompressed (or plain) data and tells whether we have all that is
+// needed: with a window, its bytes and at least the whole header block.
+static gboolean decompressed_append(GByteArray *content, const gchar *data, gsize length, gsize window) {
+  gsize previous_length = content->len;
+  g_byte_array_append(content, (const guint8 *) data, length);
+
+  if (!window || content->len < window)
+    return FALSE;
+
+  // Past the window only the tail may contain a header end that was not there before.
+  gsize search_from = (previous_length >= window && previous_length > 2) ? previous_length - 2 : 0;
+  return header_block_length(content->data + search_from, content->len - search_from) > 0;
+}
+
+
+/*
+ * InflateStream
+ *
+ * A GMime stream of the decompressed message, inflated lazily as it is read,
+ * so that a compressed message never needs to be in memory as a whole. The
+ * parser keeps substreams of it for the content of parts, which seek the
+ * stream of the whole message when read: forward by inflating and dropping
+ * what lies in between, backward by inflating again from the start of the
+ * file. Parts are mostly read in order, so this rarely happens.
+ */
+typedef struct InflateStream {
+  GMimeStream parent_object;
+  struct InflateStream *source;  // the stream of the whole message a substream reads from
+  FILE *file;
+  GMimeStream *file_stream;
+  GMimeStream *unzip_stream;
+#ifdef HAVE_ZSTD
+  ZSTD_DCtx *dctx;
+  ZSTD_inBuffer input;
+  gchar in_buffer[RANGE_BUFFER_SIZE];
+#endif
+  gint64 inflated;               // bytes of the message inflated so far
+  gboolean finished;
+} InflateStream;
+
+typedef struct InflateStreamClass {
+  GMimeStreamClass parent_class;
+} InflateStreamClass;
+
+G_DEFINE_TYPE(InflateStream, inflate_stream, GMIME_TYPE_STREAM)
+
+
+// Opens the gzip filter on the file, from its start.
+static void inflate_stream_open_gzip(InflateStream *inflate) {
+  if (inflate->unzip_stream) {
+    g_object_unref(inflate->unzip_stream);
+    g_object_unref(inflate->file_stream);
+  }
+
+  inflate->file_stream = g_mime_stream_file_new_with_bounds(inflate->file, 0, -1);
+  g_mime_stream_file_set_owner(GMIME_STREAM_FILE(inflate->file_stream), FALSE);
+
+  inflate->unzip_stream = g_mime_stream_filter_new(inflate->file_stream);
+  GMimeFilter *unzip_filter = g_mime_filter_gzip_new(GMIME_FILTER_GZIP_MODE_UNZIP, 0);
+  g_mime_stream_filter_add(GMIME_STREAM_FILTER(inflate->unzip_stream), unzip_filter);
+  g_object_unref(unzip_filter);
+}
+
+
+static GMimeStream *inflate_stream_new(FILE *file, MessageCompression compression) {
+  InflateStream *inflate = g_object_new(inflate_stream_get_type(), NULL);
+  g_mime_stream_construct(GMIME_STREAM(inflate), 0, -1);
+  inflate->file = file;
+
+  if (compression == MESSAGE_COMPRESSION_GZIP)
+    inflate_stream_open_gzip(inflate);
+#ifdef HAVE_ZSTD
+  if (compression == MESSAGE_COMPRESSION_ZSTD)
+    inflate->dctx = ZSTD_createDCtx();
+#endif
+
+  return GMIME_STREAM(inflate);
+}
+
+
+// Inflates the next bytes of the message, returning 0 at its end.
+static ssize_t inflate_source_read(InflateStream *source, char *buf, size_t len) {
+  ssize_t nread = 0;
+  if (source->finished)
+    return 0;
+
+  if (source->unzip_stream) {
+    nread = g_mime_stream_read(source->unzip_stream, buf, len);
+    if (nread < 0)
+      nread = 0;
+  }
+#ifdef HAVE_ZSTD
+  else if (source->dctx) {
+    ZSTD_outBuffer output = { buf, len, 0 };
+    while (!output.pos) {
+      if (source->input.pos == source->input.size) {
+        size_t in_length = fread(source->in_buffer, 1, sizeof(source->in_buffer), source->file);
+        source->input = (ZSTD_inBuffer) { source->in_buffer, in_length, 0 };
+      }
+
+      size_t ret = ZSTD_decompressStream(source->dctx, &output, &source->input);
+      if (ZSTD_isError(ret)) {
+        g_printerr("zstd decompression failed: %s\r\n", ZSTD_getErrorName(ret));
+        source->finished = TRUE;
+        return -1;
+      }
+      // Nothing left to read and nothing more flushed
+      if (!output.pos && !source->input.size)
+        break;
+    }
+    nread = output.pos;
+  }
+#endif
+
+  if (nread)
+    source->inflated += nread;
+  else
+    source->finished = TRUE;
+  return nread;
+}
+
+
+// Moves the inflated position of the message to the given offset, or to its
+// end when it is shorter, which is returned.
+static gint64 inflate_source_seek(InflateStream *source, gint64 offset) {
+  if (offset < source->inflated) {
+    if (source->unzip_stream) {
+      inflate_stream_open_gzip(source);
+    }
+#ifdef HAVE_ZSTD
+    else if (source->dctx) {
+      rewind(source->file);
+      ZSTD_DCtx_reset(source->dctx, ZSTD_reset_session_only);
+      source->input = (ZSTD_inBuffer) { source->in_buffer, 0, 0 };
+    }
+#endif
+    source->inflated = 0;
+    source->finished = FALSE;
+  }
+
+  gchar buffer[RANGE_BUFFER_SIZE];
+  while (source->inflated < offset) {
+    if (inflate_source_read(source, buffer, MIN((gint64) sizeof(buffer), offset - source->inflated)) <= 0)
+      break;
+  }
+  return source->inflated;
+}
+
+
+static ssize_t inflate_stream_read(GMimeStream *stream, char *buf, size_t len) {
+  InflateStream *source = ((InflateStream *) stream)->source ? ((InflateStream *) stream)->source : (InflateStream *) stream;
+
+  if (stream->bound_end != -1) {
+    if (stream->position >= stream->bound_end)
+      return -1;
+    len = MIN((gint64) len, stream->bound_end - stream->position);
+  }
+
+  if (inflate_source_seek(source, stream->position) < stream->position)
+    return 0;
+
+  ssize_t nread = inflate_source_read(source, buf, len);
+  if (nread > 0)
+    stream->position += nread;
+  return nread;
+}
+
+
+static ssize_t inflate_stream_write(GMimeStream *stream, const char *buf, size_t len) {
+  return -1;
+}
+
+
+static int inflate_stream_flush(GMimeStream *stream) {
+  return 0;
+}
+
+
+static int inflate_stream_close(GMimeStream *stream) {
+  return 0;
+}
+
+
+static gboolean inflate_stream_eos(GMimeStream *stream) {
+  InflateStream *source = ((InflateStream *) stream)->source ? ((InflateStream *) stream)->source : (InflateStream *) stream;
+
+  if (stream->bound_end != -1 && stream->position >= stream->bound_end)
+    return TRUE;
+  return source->finished && stream->position >= source->inflated;
+}
+
+
+static int inflate_stream_reset(GMimeStream *stream) {
+  stream->position = stream->bound_start;
+  return 0;
+}
+
+
+static gint64 inflate_stream_length(GMimeStream *stream) {
+  InflateStream *source = ((InflateStream *) stream)->source ? ((InflateStream *) stream)->source : (InflateStream *) stream;
+
+  if (stream->bound_end != -1)
+    return stream->bound_end - stream->bound_start;
+
+  // The length of the message is only known once it is all inflated
+  gint64 position = source->inflated;
+  gint64 length = inflate_source_seek(source, G_MAXINT64);
+  inflate_source_seek(source, position);
+  return length - stream->bound_start;
+}
+
+
+static gint64 inflate_stream_seek(GMimeStream *stream, gint64 offset, GMimeSeekWhence whence) {
+  gint64 real;
+  switch (whence) {
+    case GMIME_STREAM_SEEK_SET:
+      real = offset;
+      break;
+    case GMIME_STREAM_SEEK_CUR:
+      real = stream->position + offset;
+      break;
+    case GMIME_STREAM_SEEK_END:
+      real = stream->bound_start + inflate_stream_length(stream) + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  // The message is inflated up to the position when it is read
+  if (real < stream->bound_start || (stream->bound_end != -1 && real > stream->bound_end))
+    return -1;
+  stream->position = real;
+  return real;
+}
+
+
+static gint64 inflate_stream_tell(GMimeStream *stream) {
+  return stream->position;
+}
+
+
+static GMimeStream *inflate_stream_substream(GMimeStream *stream, gint64 start, gint64 end) {
+  InflateStream *source = ((InflateStream *) stream)->source ? ((InflateStream *) stream)->source : (InflateStream *) stream;
+
+  InflateStream *substream = g_object_new(inflate_stream_get_type(), NULL);
+  g_mime_stream_construct(GMIME_STREAM(substream), start, end);
+  substream->source = g_object_ref(source);
+  return GMIME_STREAM(substream);
+}
+
+
+static void inflate_stream_finalize(GObject *object) {
+  InflateStream *inflate = (InflateStream *) object;
+
+  if (inflate->source) {
+    g_object_unref(inflate->source);
+  } else {
+    if (inflate->unzip_stream)
+      g_object_unref(inflate->unzip_stream);
+    if (inflate->file_stream)
+      g_object_unref(inflate->file_stream);
+#ifdef HAVE_ZSTD
+    if (inflate->dctx)
+      ZSTD_freeDCtx(inflate->dctx);
+#endif
+    if (inflate->file)
+      fclose(inflate->file);
+  }
+
+  G_OBJECT_CLASS(inflate_stream_parent_class)->finalize(object);
+}
+
+
+static void inflate_stream_class_init(InflateStreamClass *klass) {
+  GMimeStreamClass *stream_class = GMIME_STREAM_CLASS(klass);
+
+  stream_class->read = inflate_stream_read;
+  stream_class->write = inflate_stream_write;
+  stream_class->flush = inflate_stream_flush;
+  stream_class->close = inflate_stream_close;
+  stream_class->eos = inflate_stream_eos;
+  stream_class->reset = inflate_stream_reset;
+  stream_class->seek = inflate_stream_seek;
+  stream_class->tell = inflate_stream_tell;
+  stream_class->length = inflate_stream_length;
+  stream_class->substream = inflate_stream_substream;
+
+  G_OBJECT_CLASS(klass)->finalize = inflate_stream_finalize;
+}
+
+
+static void inflate_stream_init(InflateStream *inflate) {
+  inflate->source = NULL;
+  inflate->file = NULL;
+  inflate->file_stream = NULL;
+  inflate->unzip_stream = NULL;
+#ifdef HAVE_ZSTD
+  inflate->dctx = NULL;
+  inflate->input = (ZSTD_inBuffer) { NULL, 0, 0 };
+#endif
+  inflate->inflated = 0;
+  inflate->finished = FALSE;
+}
+
+
+// Reads the decompressed message up to the window and at least its whole
+// header block, telling whether that is all of it.
+static GByteArray *inflate_stream_read_window(GMimeStream *stream, gsize window, gboolean *complete) {
+  GByteArray *content = g_byte_array_new();
+  gchar buffer[RANGE_BUFFER_SIZE];
+  ssize_t nread;
+
+  *complete = TRUE;
+  while ((nread = g_mime_stream_read(stream, buffer, sizeof(buffer))) > 0)
+    if (decompressed_append(content, buffer, nread, window)) {
+      *complete = FALSE;
+      break;
+    }
+
+  if (nread < 0) {
+    g_byte_array_free(content, TRUE);
+    return NULL;
+  }
+  return content;
+}
+
+
+static GMimeStream *compressed_file_stream_new(FILE *file, MessageCompression compression) {
+#ifndef HAVE_ZSTD
+  if (compression == MESSAGE_COMPRESSION_ZSTD) {
+    g_printerr("zstd compressed messages are not supported by this build\r\n");
+    fclose(file);
+    return NULL;
+  }
+#endif
+  return inflate_stream_new(file, compression);
+}
+
+
+static GMimeMessage *gmime_message_from_compressed_file(FILE *file, MessageCompression compression, gboolean headers_only) {
+  GMimeStream *stream = compressed_file_stream_new(file, compression);
+  if (!stream)
+    return NULL;
+
+  if (headers_only) {
+    gboolean complete;
+    GByteArray *content = inflate_stream_read_window(stream, BATCH_READ_SIZE, &complete);
+    g_object_unref(stream);
+    if (!content)
+      return NULL;
+
+    if (!complete) {
+      GMimeMessage *message = gmime_message_from_window((const gchar *) content->data, content->len,
+                                                        header_block_length(content->data, content->len), FALSE);
+      g_byte_array_free(content, TRUE);
+      return message;
+    }
+
+    // The memory stream owns the byte array from now on
+    stream = g_mime_stream_mem_new_with_byte_array(content);
+  }
+
+  // The parts of the message keep the stream, an inflating one inflates their
+  // content again when they are read
+  GMimeMessage *message = gmime_message_from_stream(stream);
+  g_object_unref(stream);
+  return message;
+}
+
+
+/*
+ * Mbox
+ *
+ * Besides maildir files, messages can be addressed within an mbox file by the
+ * byte offset of their From_ line. The offsets come from an index built in a
+ * single pass over the mbox (see build_mbox_index), where a message ends at
+ * the next From_ line following an empty line. Opening a message finds its
+ * end the same way and parses that range only, so the cost does not depend
+ * on the size of the mbox.
+ */
+typedef struct MboxIndexer {
+  FILE     *index;         // written to, or NULL when only the messages are looked for
+  GString  *line_head;     // beginning of the current line, enough to recognize a From_ line
+  guint64  line_start;     // offset of the current line
+  gboolean previous_empty; // From_ lines only count after an empty line (or at the start)
+  gboolean in_message;
+  guint64  message_start;
+  guint64  message_end;    // of the message closed last
+  GString  *from_line;
+  guint    count;
+} MboxIndexer;
+
+
+static void mbox_indexer_init(MboxIndexer *indexer, FILE *index, guint64 start) {
+  indexer->index          = index;
+  indexer->line_head      = g_string_sized_new(MBOX_FROM_LINE_MAX);
+  indexer->line_start     = start;
+  indexer->previous_empty = TRUE;
+  indexer->in_message     = FALSE;
+  indexer->message_start  = start;
+  indexer->message_end    = start;
+  indexer->from_line      = g_string_sized_new(MBOX_FROM_LINE_MAX);
+  indexer->count          = 0;
+}
+
+
+static void mbox_indexer_free(MboxIndexer *indexer) {
+  g_string_free(indexer->line_head, TRUE);
+  g_string_free(indexer->from_line, TRUE);
+}
+
+
+static void mbox_indexer_close_message(MboxIndexer *indexer, guint64 message_end) {
+  if (!indexer->in_message)
+    return;
+
+  if (indexer->index)
+    fprintf(indexer->index, "%" G_GUINT64_FORMAT "\t%" G_GUINT64_FORMAT "\t%s\n",
+            indexer->message_start, message_end - indexer->message_start, indexer->from_line->str);
+  indexer->message_end = message_end;
+  indexer->count++;
+  indexer->in_message = FALSE;
+}
+
+
+static void mbox_indexer_end_line(MboxIndexer *indexer, guint64 line_length) {
+  GString *head = indexer->line_head;
+
+  if (head->len && head->str[head->len - 1] == '\r') {
+    g_string_truncate(head, head->len - 1);
+    line_length--;
+  }
+
+  if (indexer->previous_empty && g_str_has_prefix(head->str, "From ")) {
+    mbox_indexer_close_message(indexer, indexer->line_start);
+    indexer->in_message    = TRUE;
+    indexer->message_start = indexer->line_start;
+    g_string_assign(indexer->from_line, head->str + strlen("From "));
+  }
+
+  indexer->previous_empty = (line_length == 0);
+  g_string_truncate(head, 0);
+}
+
+
+// Reads the mbox from the start the indexer was given, up to its end or
+// until the count of messages is closed.
+static gboolean mbox_indexer_read(MboxIndexer *indexer, FILE *mbox, guint max_count) {
+  gchar buffer[RANGE_BUFFER_SIZE];
+  guint64 position = indexer->line_start;
+  size_t nread;
+
+  while ((nread = fread(buffer, 1, sizeof(buffer), mbox)) > 0) {
+    gchar *cur = buffer;
+    gchar *end = buffer + nread;
+
+    while (cur < end) {
+      gchar *eol = memchr(cur, '\n', end - cur);
+      gchar *segment_end = eol ? eol : end;
+
+      gsize head_room = MBOX_FROM_LINE_MAX - MIN(indexer->line_head->len, MBOX_FROM_LINE_MAX);
+      g_string_append_len(indexer->line_head, cur, MIN(head_room, (gsize) (segment_end - cur)));
+
+      if (!eol)
+        break;
+
+      guint64 eol_offset = position + (eol - buffer);
+      mbox_indexer_end_line(indexer, eol_offset - indexer->line_start);
+      indexer->line_start = eol_offset + 1;
+      cur = eol + 1;
+
+      if (indexer->count >= max_count)
+        return TRUE;
+    }
+    position += nread;
+  }
+
+  if (position > indexer->line_start)
+    mbox_indexer_end_line(indexer, position - indexer->line_start);
+  mbox_indexer_close_message(indexer, position);
+
+  return !ferror(mbox) && (!indexer->index || !ferror(indexer->index));
+}
+
+
+static gboolean build_mbox_index(FILE *mbox, FILE *index, guint *count) {
+  MboxIndexer indexer;
+
+  mbox_indexer_init(&indexer, index, 0);
+  gboolean built = mbox_indexer_read(&indexer, mbox, G_MAXUINT);
+  *count = indexer.count;
+  mbox_indexer_free(&indexer);
+  return built;
+}
+
+
+// Finds the range of the message of the From_ line at the offset, past
+// that line, with the end build_mbox_index gives it.
+static gboolean mbox_message_range(FILE *mbox, gint64 message_offset, gint64 *start, gint64 *end) {
+  gchar line[MBOX_FROM_LINE_MAX];
+  MboxIndexer indexer;
+
+  if (fseeko(mbox, message_offset, SEEK_SET) || !fgets(line, sizeof(line), mbox) ||
+      !g_str_has_prefix(line, "From "))
+    return FALSE;
+  while (!strchr(line, '\n') && fgets(line, sizeof(line), mbox));
+  *start = ftello(mbox);
+  if (*start < 0 || fseeko(mbox, message_offset, SEEK_SET))
+    return FALSE;
+
+  mbox_indexer_init(&indexer, NULL, message_offset);
+  gboolean found = mbox_indexer_read(&indexer, mbox, 1) && indexer.count == 1;
+  *end = indexer.message_end;
+  mbox_indexer_free(&indexer);
+  return found;
+}
+
+
+static GMimeMessage *gmime_message_from_mbox(FILE *file, gint64 message_offset) {
+  g_return_val_if_fail(file != NULL, NULL);
+
+  gint64 start, end;
+  if (!mbox_message_range(file, message_offset, &start, &end)) {
+    g_printerr("no message at offset %" G_GINT64_FORMAT "\r\n", message_offset);
+    fclose(file);
+    return NULL;
+  }
+
+  GMimeStream *stream = g_mime_stream_file_new_with_bounds(file, start, end);
+
+  if (!stream) {
+    g_printerr("file stream could not be opened\r\n");
+    fclose(file);
+    return NULL;
+  }
+
+  // Being owner of the stream will automatically close the file when released
+  g_mime_stream_file_set_owner(GMIME_STREAM_FILE(stream), TRUE);
+
+  GMimeMessage *message = gmime_message_from_stream(stream);
+  g_object_unref (stream);
+  if (!message) {
+    g_printerr("message could not be constructed at offset %" G_GINT64_FORMAT "\r\n", message_offset);
+    return NULL;
+  }
+
+  return message;
+}
+
+
+/*
+ *
+ *
+ */
+static GMimeMessage *gmime_message_from_path(const gchar *path, gint64 message_offset, gboolean headers_only) {
+  g_return_val_if_fail(path != NULL, NULL);
+
+  // Note: we don't need to worry about closing the file, as it will be closed by the
+  // stream within message_from_file.
+  FILE *file = fopen (path, "r");
+
+  if (!file) {
+    g_printerr("cannot open file '%s': %s\r\n", path, g_strerror(errno));
+    return NULL;
+  }
+
+  GMimeMessage *message;
+  MessageCompression compression = MESSAGE_COMPRESSION_NONE;
+  if (message_offset < 0)
+    compression = detect_compression(file);
+
+  if (message_offset >= 0) {
+    message = gmime_message_from_mbox(file, message_offset);
+  } else if (compression != MESSAGE_COMPRESSION_NONE) {
+    message = gmime_message_from_compressed_file(file, compression, headers_only);
+  } else {
+    message = gmime_message_from_file(file);
+  }
+  if (!message) {
+    g_printerr("message could not be constructed from file '%s': %s\r\n", path, g_strerror(errno));
+    return NULL;
+  }
+
+  return message;
+}
+
+
+
+/*
+ * Decoded content
+ *
+ * The data wrapper of a part keeps the content in its transfer encoding. We
+ * decode it through a stream we can read in chunks, so that callers decide
+ * how much of it to keep instead of always getting all of it in memory.
+ */
+static GMimeStream *decoded_stream_new(GMimeStream *encoded, GMimeContentEncoding encoding) {
+  GMimeStream *decoded = g_mime_stream_filter_new(encoded);
+
+  switch (encoding) {
+    case GMIME_CONTENT_ENCODING_BASE64:
+    case GMIME_CONTENT_ENCODING_QUOTEDPRINTABLE:
+    case GMIME_CONTENT_ENCODING_UUENCODE: {
+      GMimeFilter *decoder = (encoding == GMIME_CONTENT_ENCODING_UUENCODE)
+        ? g_mime_filter_basic_new(encoding, FALSE)
+        : fast_decode_filter_new(encoding);
+      g_mime_stream_filter_add(GMIME_STREAM_FILTER(decoded), decoder);
+      g_object_unref(decoder);
+      break;
+    }
+    default:
+      break;
+  }
+
+  return decoded;
+}
+
+
+// Estimates the decoded size of the content from its encoded length, base64
+// taking 4 characters for 3 bytes, line breaks aside.
+static gsize estimated_decoded_size(GMimeDataWrapper *wrapper) {
+  GMimeStream *encoded = g_mime_data_wrapper_get_stream(wrapper); // transfer none
+  gint64 length = MAX(g_mime_stream_length(encoded), 0);
+
+  if (g_mime_data_wrapper_get_encoding(wrapper) == GMIME_CONTENT_ENCODING_BASE64)
+    length = length / 4 * 3;
+  return length;
+}
+
+
+// Decodes the content into the sink, keeping at most `keep` bytes of it and
+// only as much as the budget allows; the rest is only counted. Returns the
+// full decoded size, and in `kept` the number of bytes written to the sink.
+static gsize write_decoded_content(GMimeDataWrapper *wrapper, GMimeStream *sink, gsize keep, MemoryBudget *budget, gsize *kept) {
+  GMimeStream *encoded = g_mime_data_wrapper_get_stream(wrapper); // transfer none
+  GMimeStream *source  = g_mime_stream_substream(encoded, encoded->bound_start, encoded->bound_end);
+  GMimeStream *decoded = decoded_stream_new(source, g_mime_data_wrapper_get_encoding(wrapper));
+
+  gchar buffer[RANGE_BUFFER_SIZE];
+  gsize size = 0, written = 0;
+  gboolean keeping = (sink != NULL);
+  ssize_t nread;
+
+  while ((nread = g_mime_stream_read(decoded, buffer, sizeof(buffer))) > 0) {
+    size += nread;
+    if (!keeping)
+      continue;
+
+    gsize wanted = MIN((gsize) nread, keep - written);
+    gsize allowed = memory_budget_reserve(budget, wanted);
+    if (allowed)
+      g_mime_stream_write(sink, buffer, allowed);
+    written += allowed;
+    keeping = (allowed == (gsize) nread);
+  }
+
+  g_object_unref(decoded);
+  g_object_unref(source);
+
+  if (kept)
+    *kept = written;
+  return size;
+}
+
+
+/*
+ *
+ *
+ */
+static void collect_part(GMimeObject *part, PartCollectorData *fdata, gboolean multipart_parent) {
+  GMimeContentType        *content_type = g_mime_object_get_content_type(part);
+  GMimeContentDisposition *disposition  = g_mime_object_get_content_disposition(part);
+
+  if (!content_type)
+    return;
+
+  GMimeDataWrapper *wrapper = g_mime_part_get_content_object(GMIME_PART(part));
+  if (!wrapper)
+    return;
+
+  // All the information will be collected in the CollectedPart
+  CollectedPart *c_part = new_collected_part(fdata->part_id);
+
+  gboolean is_attachment = FALSE;
+  if (disposition) {
+    c_part->disposition = g_ascii_strdown(disposition->disposition, -1);
+    is_attachment = !g_ascii_strcasecmp(disposition->disposition, GMIME_DISPOSITION_ATTACHMENT);
+  }
+
+  // If a filename is given, collect it always
+  const gchar *filename = g_mime_part_get_filename(GMIME_PART(part));
+  if (filename)
+    c_part->filename = g_strdup(filename);
+
+  // If a contentID is given, collect it always
+  const char* content_id = g_mime_part_get_content_id (GMIME_PART(part));
+  if (content_id)
+    c_part->content_id = g_strdup(content_id);
+
+  // Get the contentType in lowercase
+  gchar *content_type_str = g_mime_content_type_to_string(content_type);
+  c_part->content_type = g_ascii_strdown(content_type_str, -1);
+  g_free(content_type_str);
+
+  // To qualify as a message body, a MIME entity MUST NOT have a Content-Disposition header with the value "attachment".
+  if (!is_attachment && g_mime_content_type_is_type(content_type, "text", "*")) {
+    gboolean is_text_plain    = g_mime_content_type_is_type(content_type, "text", "plain");
+    gboolean is_text_html     = g_mime_content_type_is_type(content_type, "text", "html");
+    gboolean is_text_rtf      = g_mime_content_type_is_type(content_type, "text", "rtf");
+    gboolean is_text_enriched = g_mime_content_type_is_type(content_type, "text", "enriched");
+
+    gboolean is_new_text = !fdata->text_part && is_text_plain;
+    gboolean is_new_html = !fdata->html_part && (is_text_html || is_text_enriched || is_text_rtf);
+
+    // Decode the text first, to see whether it needs a charset conversion
+    GMimeStream *text_stream = g_mime_stream_mem_new();
+    g_mime_stream_mem_set_owner(GMIME_STREAM_MEM(text_stream), FALSE);
+
+    gsize kept = 0;
+    c_part->size = write_decoded_content(wrapper, text_stream, G_MAXSIZE, fdata->budget, &kept);
+    c_part->truncated = (kept < c_part->size);
+
+    GByteArray *text = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(text_stream));
+    g_object_unref(text_stream);
+
+    const gchar *charset = g_mime_object_get_content_type_parameter(part, "charset");
+    text = text_to_utf8(text, charset, fdata->budget);
+
+    // Raw content and alternative bodies need no filters
+    if (fdata->raw || !(is_new_text || is_new_html)) {
+      c_part->content = text;
+    } else {
+      GMimeStream *mem_stream = g_mime_stream_mem_new();
+      g_mime_stream_mem_set_owner(GMIME_STREAM_MEM(mem_stream), FALSE);
+      GMimeStream *filtered_mem_stream = g_mime_stream_filter_new(mem_stream);
+
+      if (is_new_text) {
+        GMimeFilter *strip_filter = g_mime_filter_strip_new();
+        g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), strip_filter);
+        g_object_unref(strip_filter);
+
+        GMimeFilter *crlf_filter = g_mime_filter_crlf_new(FALSE, FALSE);
+        g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), crlf_filter);
+        g_object_unref(crlf_filter);
+
+        GMimeFilter *html_filter = g_mime_filter_html_new(
+           GMIME_FILTER_HTML_CONVERT_NL        |
+           GMIME_FILTER_HTML_CONVERT_SPACES    |
+           GMIME_FILTER_HTML_CONVERT_URLS      |
+           GMIME_FILTER_HTML_MARK_CITATION     |
+           GMIME_FILTER_HTML_CONVERT_ADDRESSES |
+           GMIME_FILTER_HTML_CITE, CITATION_COLOUR);
+        g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), html_filter);
+        g_object_unref(html_filter);
+      }
+
+      GMimeFilter *from_filter = g_mime_filter_from_new(GMIME_FILTER_FROM_MODE_ESCAPE);
+      g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), from_filter);
+      g_object_unref(from_filter);
+
+      // Add Enriched/RTF filter for this content
+      if (is_new_html && (is_text_enriched || is_text_rtf)) {
+        guint flags = 0;
+        if (is_text_rtf)
+          flags = GMIME_FILTER_ENRICHED_IS_RICHTEXT;
+
+        GMimeFilter *enriched_filter = g_mime_filter_enriched_new(flags);
+        g_mime_stream_filter_add(GMIME_STREAM_FILTER(filtered_mem_stream), enriched_filter);
+        g_object_unref(enriched_filter);
+      }
+
+      g_mime_stream_write(filtered_mem_stream, (const char *) text->data, text->len);
+
+      // Very important! Flush the the stream and get all content through.
+      g_mime_stream_flush(filtered_mem_stream);
+
+      // Freed by the mem_stream on its own (owner) [transfer none]
+      c_part->content = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(mem_stream));
+
+      // After we unref the mem_stream, part_content is NOT available anymore
+      g_object_unref(filtered_mem_stream);
+      g_object_unref(mem_stream);
+
+      // The filters may have grown the content beyond the text, of which only
+      // as much as the budget allows is kept
+      if (c_part->content->len > text->len) {
+        gsize grown = c_part->content->len - text->len;
+        gsize charged = memory_budget_reserve(fdata->budget, grown);
+        if (charged < grown) {
+          gsize cut = html_cut_length((const gchar *) c_part->content->data, text->len + charged);
+          memory_budget_release(fdata->budget, text->len + charged - cut);
+          g_byte_array_set_size(c_part->content, cut);
+          c_part->truncated = TRUE;
+        }
+      } else {
+        memory_budget_release(fdata->budget, text->len - c_part->content->len);
+      }
+      g_byte_array_free(text, TRUE);
+    }
+
+    // Without content, the collected body part is of no use, so we ignore it.
+    if (c_part->content->len == 0) {
+      free_collected_part(c_part);
+      return;
+    }
+
+    // We accept only the first text and first html content, everything
+    // else is considered an alternative body
+    if (is_new_text) {
+      fdata->text_part = c_part;
+    } else if (is_new_html) {
+      fdata->html_part = c_part;
+    } else {
+      g_ptr_array_add(fdata->alternative_bodies, c_part);
+    }
+
+  } else {
+    // Some content may not have disposition defined so we need to determine better what it is
+    gboolean is_inline = (disposition && !g_ascii_strcasecmp(disposition->disposition, GMIME_DISPOSITION_INLINE)) ||
+                         g_mime_part_get_content_id(GMIME_PART(part));
+
+    // Only inline content small enough to be embedded is kept, of everything
+    // else we need nothing but the size. Inlines referenced by URL are read
+    // with get_part when displayed, so they are not kept either.
+    if (is_inline && !fdata->inline_url) {
+      GMimeStream *inline_mem_stream = g_mime_stream_mem_new();
+      g_mime_stream_mem_set_owner(GMIME_STREAM_MEM(inline_mem_stream), FALSE);
+
+      gsize kept = 0;
+      c_part->size = write_decoded_content(wrapper, inline_mem_stream, MAX_CID_SIZE, fdata->budget, &kept);
+      g_mime_stream_flush(inline_mem_stream);
+
+      GByteArray *content = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(inline_mem_stream));
+      g_object_unref(inline_mem_stream);
+
+      // A partial inline is of no use, so we give its share of the budget back
+      if (kept < c_part->size) {
+        c_part->truncated = (c_part->size < MAX_CID_SIZE);
+        memory_budget_release(fdata->budget, kept);
+        g_byte_array_free(content, TRUE);
+      } else {
+        c_part->content = content;
+      }
+      g_ptr_array_add(fdata->inlines, c_part);
+    } else if (is_inline) {
+      // Inlines referenced by URL are not decoded, their size is estimated
+      c_part->size = estimated_decoded_size(wrapper);
+      g_ptr_array_add(fdata->inlines, c_part);
+    } else {
+      // All other disposition should be kept within attachments
+      c_part->size = write_decoded_content(wrapper, NULL, 0, fdata->budget, NULL);
+      g_ptr_array_add(fdata->attachments, c_part);
+    }
+
+  }
+}
+
+
+/*
+ *
+ *
+ */
+static void collector_foreach_callback(GMimeObject *parent, GMimeObject *part, gpointer user_data) {
+  g_return_if_fail(user_data != NULL);
+
+  PartCollectorData *fdata = (PartCollectorData *) user_data;
+
+  if (GMIME_IS_MESSAGE_PART(part)) {
+
+    if (fdata->recursion_depth++ < RECURSION_LIMIT) {
+      GMimeMessage *message = g_mime_message_part_get_message((GMimeMessagePart *) part); // transfer none
+      if (message)
+        g_mime_message_foreach(message, collector_foreach_callback, user_data);
+
+    } else {
+      g_printerr("endless recursion detected: %d\r\n", fdata->recursion_depth);
+      return;
+    }
+
+  } else if (GMIME_IS_MESSAGE_PARTIAL(part)) {
+    // Save into an array ? Todo: Look into the specs
+  } else if (GMIME_IS_MULTIPART(part)) {
+    // Nothing special needed on multipart, let descend further
+  } else if (GMIME_IS_PART(part)) {
+    collect_part(part, fdata, GMIME_IS_MULTIPART(parent));
+    fdata->part_id++;
+  } else {
+    g_assert_not_reached();
+  }
+}
+
+
+static PartCollectorData *collect_parts(GMimeMessage *message, guint content_option, const GmimexOptions *options, MemoryBudget *budget) {
+  PartCollectorData *pc = new_part_collector_data(content_option, options, budget);
+  g_mime_message_foreach(message, collector_foreach_callback, pc);
+  return pc;
+}
+
+
+
+
+/*
+ *
+ *
+ */
+static void extract_part(GMimeObject *part, PartExtractorData *a_data) {
+  GMimeDataWrapper *attachment_wrapper = g_mime_part_get_content_object(GMIME_PART(part));
+  GMimeStream *attachment_mem_stream = g_mime_stream_mem_new();
+  g_mime_stream_mem_set_owner(GMIME_STREAM_MEM(attachment_mem_stream), FALSE);
+  write_decoded_content(attachment_wrapper, attachment_mem_stream, G_MAXSIZE, NULL, NULL);
+  g_mime_stream_flush(attachment_mem_stream);
+  a_data->content = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(attachment_mem_stream));
+  g_object_unref(attachment_mem_stream);
+}
+
+
+/*
+ *
+ *
+ */
+static void part_extractor_foreach_callback(GMimeObject *parent, GMimeObject *part, gpointer user_data) {
+  PartExtractorData *a_data = (PartExtractorData *) user_data;
+
+  if (GMIME_IS_MESSAGE_PART(part)) {
+
+    if (a_data->recursion_depth < RECURSION_LIMIT) {
+      GMimeMessage *message = g_mime_message_part_get_message((GMimeMessagePart *) part); // transfer none
+      if (message)
+        g_mime_message_foreach(message, part_extractor_foreach_callback, a_data);
+
+    } else {
+      g_printerr("endless recursion detected: %d\r\n", a_data->recursion_depth);
+      return;
+    }
+
+  } else if (GMIME_IS_MESSAGE_PARTIAL (part)) {
+    // Save into an array ? Todo: Look into the specs
+  } else if (GMIME_IS_MULTIPART (part)) {
+    // Nothing special needed on multipart, let descend further
+  } else if (GMIME_IS_PART (part)) {
+
+    // We are interested only in the part 0 (counting down by same logic)
+    if (a_data->part_id == 0)
+      a_data->part = part;
+
+    a_data->part_id--;
+
+  } else {
+    g_assert_not_reached();
+  }
+}
+
+
+/*
+ *
+ *
+ */
+static GMimeObject *gmime_message_find_part(GMimeMessage* message, guint part_id) {
+  g_return_val_if_fail(message != NULL, NULL);
+
+  PartExtractorData *a_data = new_part_extractor_data(part_id);
+  g_mime_message_foreach(message, part_extractor_foreach_callback, a_data);
+  GMimeObject *part = a_data->part;
+  free_part_extractor_data(a_data, FALSE);
+
+  if (!part)
+    g_printerr("could not locate partId %d\r\n", part_id);
+
+  return part;
+}
+
+
+/*
+ * Parts by section
+ *
+ * Besides the partId counter, parts are addressed by their IMAP section
+ * ("2.1.3"), which is followed straight down the tree, or by their
+ * Content-ID ("cid:..."), for which the tree is searched without decoding
+ * anything.
+ */
+static GMimeObject *gmime_message_find_section(GMimeMessage *message, const gchar *section) {
+  GMimeObject *current = g_mime_message_get_mime_part(message); // transfer none
+  gboolean message_body = TRUE;
+  const gchar *ptr = section;
+
+  while (current && *ptr) {
+    gchar *end;
+    guint64 index = g_ascii_strtoull(ptr, &end, 10);
+    if (end == ptr || index == 0 || (*end && *end != '.'))
+      return NULL;
+    ptr = *end ? end + 1 : end;
+
+    // The numbers below an embedded message address its body
+    if (GMIME_IS_MESSAGE_PART(current)) {
+      GMimeMessage *embedded = g_mime_message_part_get_message(GMIME_MESSAGE_PART(current)); // transfer none
+      current = embedded ? g_mime_message_get_mime_part(embedded) : NULL;
+      message_body = TRUE;
+      if (!current)
+        return NULL;
+    }
+
+    if (GMIME_IS_MULTIPART(current)) {
+      if (index > (guint64) g_mime_multipart_get_count(GMIME_MULTIPART(current)))
+        return NULL;
+      current = g_mime_multipart_get_part(GMIME_MULTIPART(current), index - 1);
+    } else if (!message_body || index != 1) {
+      // A single part body is part 1 of its message, and has no parts below
+      return NULL;
+    }
+    message_body = FALSE;
+  }
+
+  return current;
+}
+
+
+static GMimeObject *find_content_id(GMimeObject *object, const gchar *content_id, guint depth) {
+  if (GMIME_IS_MULTIPART(object)) {
+    gint count = g_mime_multipart_get_count(GMIME_MULTIPART(object));
+    gint i;
+    for (i = 0; i < count; i++) {
+      GMimeObject *found = find_content_id(g_mime_multipart_get_part(GMIME_MULTIPART(object), i), content_id, depth);
+      if (found)
+        return found;
+    }
+  } else if (GMIME_IS_MESSAGE_PART(object)) {
+    GMimeMessage *embedded = g_mime_message_part_get_message(GMIME_MESSAGE_PART(object)); // transfer none
+    if (embedded && g_mime_message_get_mime_part(embedded) && depth < RECURSION_LIMIT)
+      return find_content_id(g_mime_message_get_mime_part(embedded), content_id, depth + 1);
+  } else if (GMIME_IS_PART(object)) {
+    const gchar *part_content_id = g_mime_part_get_content_id(GMIME_PART(object));
+    if (part_content_id && !g_ascii_strcasecmp(part_content_id, content_id))
+      return object;
+  }
+
+  return NULL;
+}
+
+
+static GMimeObject *gmime_message_find_content_id(GMimeMessage *message, const gchar *cid) {
+  GMimeObject *body = g_mime_message_get_mime_part(message); // transfer none
+  if (!body)
+    return NULL;
+
+  // A cid URL is escaped, and may still have the brackets of the header
+  gchar *content_id = g_uri_unescape_string(cid, NULL);
+  if (!content_id)
+    return NULL;
+  g_strstrip(content_id);
+
+  gchar *start = content_id;
+  gsize length = strlen(start);
+  if (length >= 2 && start[0] == '<' && start[length - 1] == '>') {
+    start[length - 1] = '\0';
+    start++;
+  }
+
+  GMimeObject *found = find_content_id(body, start, 0);
+  g_free(content_id);
+  return found;
+}
+
+
+// Finds the part by section or cid when one is given, by partId otherwise.
+// Only leaf parts have content, so a multipart or message is not found.
+static GMimeObject *gmime_message_locate_part(GMimeMessage *message, guint part_id, const gchar *section) {
+  if (!section)
+    return gmime_message_find_part(message, part_id);
+
+  GMimeObject *part = !g_ascii_strncasecmp(section, "cid:", 4) ?
+                      gmime_message_find_content_id(message, section + 4) :
+                      gmime_message_find_section(message, section);
+
+  if (!part || !GMIME_IS_PART(part)) {
+    g_printerr("could not locate section %s\r\n", section);
+    return NULL;
+  }
+  return part;
+}
+
+
+/*
+ *
+ *
+ */
+static GByteArray *gmime_message_get_part_data(GMimeMessage* message, guint part_id, const gchar *section) {
+  g_return_val_if_fail(message != NULL, NULL);
+
+  GMimeObject *part = gmime_message_locate_part(message, part_id, section);
+  if (!part)
+    return NULL;
+
+  PartExtractorData *a_data = new_part_extractor_data(part_id);
+  extract_part(part, a_data);
+  GByteArray *content = a_data->content;
+  free_part_extractor_data(a_data, FALSE);
+
+  return content;
+}
+
+
+/*
+ * Ranged reads
+ *
+ * To serve a window of the decoded content we avoid decoding everything in
+ * front of it. Base64 is usually written in lines of equal length, so a
+ * decoded offset maps directly onto the encoded line that contains it; we
+ * seek there and decode only from that line on. The lines up to the end of
+ * the window are checked to all be of that layout first, which only scans
+ * them, and any that is not makes us decode the part in sequence instead.
+ * Every other encoding (quoted-printable has no such property) is decoded as
+ * a stream, skipping the leading bytes without keeping them.
+ */
+// Reads the encoded line starting at the current position of the stream; on
+// success line_len is the number of characters before the line ending and
+// eol_len the size of the ending itself (1 for LF, 2 for CRLF).
+static gboolean base64_read_line(GMimeStream *stream, guint *line_len, guint *eol_len) {
+  gchar buffer[BASE64_PROBE_SIZE];
+  ssize_t nread = g_mime_stream_read(stream, buffer, sizeof(buffer));
+  if (nread <= 0)
+    return FALSE;
+
+  gchar *eol = memchr(buffer, '\n', nread);
+  if (!eol)
+    return FALSE;
+
+  *line_len = eol - buffer;
+  *eol_len  = 1;
+  if (*line_len && buffer[*line_len - 1] == '\r') {
+    (*line_len)--;
+    (*eol_len)++;
+  }
+  return TRUE;
+}
+
+
+// Checks that the encoded lines read from the stream, up to about `length`
+// bytes of them or to the end when 0, all have the given layout: line_len
+// base64 characters and the same line ending, only the last line of the
+// content being shorter or padded. Other lines would decode to other offsets
+// than the ones the window was found at.
+static gboolean base64_check_lines(GMimeStream *stream, guint line_len, guint eol_len, guint64 length) {
+  gchar buffer[RANGE_BUFFER_SIZE];
+  guint64 checked = 0;
+  guint chars = 0;
+  gboolean cr = FALSE, padded = FALSE, last = FALSE;
+  ssize_t nread;
+
+  while ((!length || checked < length) && (nread = g_mime_stream_read(stream, buffer, sizeof(buffer))) > 0) {
+    ssize_t i;
+    checked += nread;
+
+    for (i = 0; i < nread; i++) {
+      gchar c = buffer[i];
+
+      if (c == '\n') {
+        if ((last && chars) || chars > line_len || (chars == line_len && (cr ? 2 : 1) != eol_len))
+          return FALSE;
+        // A short or padded line, or a blank one, ends the content
+        last = last || chars < line_len || padded;
+        chars = 0;
+        cr = padded = FALSE;
+      } else if (cr) {
+        return FALSE;
+      } else if (c == '\r') {
+        cr = TRUE;
+      } else if (c == '=') {
+        padded = TRUE;
+        chars++;
+      } else if (padded || !(g_ascii_isalnum(c) || c == '+' || c == '/')) {
+        return FALSE;
+      } else {
+        chars++;
+      }
+    }
+  }
+
+  return !(last && chars) && chars <= line_len;
+}
+
+
+static gboolean base64_seek_window(GMimeStream *encoded, guint64 offset, guint64 length, gint64 *encoded_offset, guint64 *skip) {
+  guint line_len, eol_len;
+
+  g_mime_stream_reset(encoded);
+  gboolean found_line = base64_read_line(encoded, &line_len, &eol_len);
+  g_mime_stream_reset(encoded);
+
+  if (!found_line || !line_len || (line_len % 4))
+    return FALSE;
+
+  guint64 line_decoded_size = line_len / 4 * 3;
+  guint64 line_encoded_size = line_len + eol_len;
+  guint64 line = offset / line_decoded_size;
+
+  if (!line)
+    return FALSE;
+
+  // Make sure the lines in front of the one we jump to and those of the
+  // window all have the same layout, otherwise any of them would shift the
+  // offsets and we have to stream
+  guint64 window_lines = length ? line + (offset % line_decoded_size + length) / line_decoded_size + 2 : 0;
+  GMimeStream *probe = g_mime_stream_substream(encoded, encoded->bound_start, encoded->bound_end);
+  gboolean valid = base64_check_lines(probe, line_len, eol_len, window_lines * line_encoded_size);
+  g_object_unref(probe);
+
+  if (!valid)
+    return FALSE;
+
+  *encoded_offset = line * line_encoded_size;
+  *skip = offset - line * line_decoded_size;
+  return TRUE;
+}
+
+
+static GByteArray *stream_read_window(GMimeStream *stream, guint64 skip, guint64 length) {
+  GByteArray *window = g_byte_array_new();
+  gchar buffer[RANGE_BUFFER_SIZE];
+  ssize_t nread;
+
+  while ((length == 0 || window->len < length) &&
+         (nread = g_mime_stream_read(stream, buffer, sizeof(buffer))) > 0) {
+    guint64 start = 0;
+    if (skip) {
+      start = MIN(skip, (guint64) nread);
+      skip -= start;
+    }
+
+    guint64 available = nread - start;
+    if (length)
+      available = MIN(available, length - window->len);
+
+    if (available)
+      g_byte_array_append(window, (const guint8 *) buffer + start, available);
+  }
+
+  return window;
+}
+
+
+static GByteArray *extract_part_range(GMimeObject *part, guint64 offset, guint64 length) {
+  GMimeDataWrapper *wrapper = g_mime_part_get_content_object(GMIME_PART(part));
+  if (!wrapper)
+    return NULL;
+
+  GMimeStream *encoded = g_mime_data_wrapper_get_stream(wrapper); // transfer none
+  GMimeContentEncoding encoding = g_mime_data_wrapper_get_encoding(wrapper);
+
+  gint64 encoded_offset = 0;
+  guint64 skip = offset;
+
+  if (encoding == GMIME_CONTENT_ENCODING_BASE64 && offset)
+    if (!base64_seek_window(encoded, offset, length, &encoded_offset, &skip)) {
+      encoded_offset = 0;
+      skip = offset;
+    }
+
+  GMimeStream *source = g_mime_stream_substream(encoded, encoded->bound_start + encoded_offset, encoded->bound_end);
+  GMimeStream *decoded = decoded_stream_new(source, encoding);
+  GByteArray *window = stream_read_window(decoded, skip, length);
+
+  g_object_unref(decoded);
+  g_object_unref(source);
+  return window;
+}
+
+
+/*
+ * Decoding into files
+ *
+ * Large attachments are decoded straight into a file with a bounded buffer
+ * instead of being collected in memory. The content goes to a temporary file
+ * next to the destination which is renamed into place once complete, so
+ * readers never see a partially written attachment.
+ */
+static gboolean write_all(gint fd, const gchar *buffer, gsize length) {
+  while (length) {
+    ssize_t written = write(fd, buffer, length);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      return FALSE;
+    }
+    buffer += written;
+    length -= written;
+  }
+  return TRUE;
+}
+
+
+// g_mkstemp creates the file readable by its owner alone, where a file
+// created in place gets the permissions the umask leaves.
+static gint fchmod_as_umask(gint fd) {
+  mode_t mask = umask(0);
+  umask(mask);
+  return fchmod(fd, 0666 & ~mask);
+}
+
+
+static GString *extract_part_to_file(GMimeObject *part, const gchar *dest_path) {
+  GMimeDataWrapper *wrapper = g_mime_part_get_content_object(GMIME_PART(part));
+  if (!wrapper)
+    return NULL;
+
+  gchar *tmp_path = g_strjoin(NULL, dest_path, ".XXXXXX", NULL);
+  gint fd = g_mkstemp(tmp_path);
+  if (fd < 0) {
+    g_printerr("cannot create file '%s': %s\r\n", tmp_path, g_strerror(errno));
+    g_free(tmp_path);
+    return NULL;
+  }
+
+  GMimeStream *encoded = g_mime_data_wrapper_get_stream(wrapper); // transfer none
+  GMimeStream *source  = g_mime_stream_substream(encoded, encoded->bound_start, encoded->bound_end);
+  GMimeStream *decoded = decoded_stream_new(source, g_mime_data_wrapper_get_encoding(wrapper));
+  GChecksum *checksum  = g_checksum_new(G_CHECKSUM_SHA256);
+
+  gchar buffer[RANGE_BUFFER_SIZE];
+  guint64 size = 0;
+  gint error = 0;
+  ssize_t nread;
+
+  if (fchmod_as_umask(fd) != 0)
+    error = errno;
+
+  while (!error && (nread = g_mime_stream_read(decoded, buffer, sizeof(buffer))) > 0) {
+    if (!write_all(fd, buffer, nread))
+      error = errno;
+    g_checksum_update(checksum, (const guchar *) buffer, nread);
+    size += nread;
+  }
+
+  g_object_unref(decoded);
+  g_object_unref(source);
+
+  // The content is on disk before the file appears under its name, and the
+  // error kept is the first one, not what close may set errno to after it
+  if (!error && fsync(fd) != 0)
+    error = errno;
+
+  if (close(fd) != 0 && !error)
+    error = errno;
+
+  if (!error && g_rename(tmp_path, dest_path) != 0)
+    error = errno;
+
+  if (error) {
+    g_printerr("cannot write file '%s': %s\r\n", dest_path, g_strerror(error));
+    g_unlink(tmp_path);
+    g_checksum_free(checksum);
+    g_free(tmp_path);
+    return NULL;
+  }
+
+  JSON_Value *root_value = json_value_init_object();
+  JSON_Object *root_object = json_value_get_object(root_value);
+  json_object_set_string(root_object, "path",   dest_path);
+  json_object_set_number(root_object, "size",   size);
+  json_object_set_string(root_object, "sha256", g_checksum_get_string(checksum));
+
+  gchar *serialized_string = json_serialize_to_string(root_value);
+  json_value_free(root_value);
+  GString *json_string = g_string_new(serialized_string);
+  g_free(serialized_string);
+
+  g_checksum_free(checksum);
+  g_free(tmp_path);
+  return json_string;
+}
+
+
+/*
+ *
+ *
+ */
+static void collect_addresses_into(InternetAddressList *ilist, AddressesList *addr_list, guint size) {
+  g_return_if_fail(ilist != NULL);
+  g_return_if_fail(addr_list != NULL);
+  g_return_if_fail(size != 0);
+
+  guint i;
+  for (i = 0; i < size; i++) {
+    InternetAddress *address = internet_address_list_get_address(ilist, i); // transfer none
+
+    if (INTERNET_ADDRESS_IS_GROUP(address)) {
+      InternetAddressGroup *group = INTERNET_ADDRESS_GROUP(address);
+      InternetAddressList *group_list = internet_address_group_get_members(group); // transer none
+
+      if (group_list) {
+        guint gsize = internet_address_list_length(group_list);
+        if (gsize)
+          collect_addresses_into(group_list, addr_list, gsize);
+      }
+
+    } else if (INTERNET_ADDRESS_IS_MAILBOX(address)) {
+      InternetAddressMailbox *mailbox = INTERNET_ADDRESS_MAILBOX(address);
+      const gchar *name    = internet_address_get_name(address);
+      const gchar *address = internet_address_mailbox_get_addr(mailbox);
+      Address *addr = new_address(address, name);
+      addresses_list_add(addr_list, addr);
+    }
+  }
+}
+
+
+
+static AddressesList *collect_str_addresses(const gchar* addresses_list_str) {
+  g_return_val_if_fail(addresses_list_str != NULL, NULL);
+
+  AddressesList* result = NULL;
+  InternetAddressList *addresses = internet_address_list_parse_string(addresses_list_str); // transfer-FULL
+
+  if (addresses) {
+    guint addresses_length = internet_address_list_length(addresses);
+    if (addresses_length) {
+      result = new_addresses_list();
+      collect_addresses_into(addresses, result, addresses_length);
+    }
+    g_object_unref(addresses);
+  }
+  return result;
+}
+
+
+static AddressesList *collect_addresses(InternetAddressList *list) {
+  g_return_val_if_fail(list != NULL, NULL);
+
+  AddressesList* result = NULL;
+  guint size = internet_address_list_length(list);
+  if (size) {
+    result = new_addresses_list();
+    collect_addresses_into(list, result, size);
+  }
+  return result;
+}
+
+
+static AddressesList *get_from_addresses(GMimeMessage *message) {
+  const gchar *from_str = g_mime_message_get_sender(message); // transfer-none
+  if (from_str)
+    return collect_str_addresses(from_str);
+  return NULL;
+}
+
+
+static AddressesList *get_reply_to_addresses(GMimeMessage *message) {
+  const gchar *reply_to_string = g_mime_message_get_reply_to(message); // transfer-none
+  if (reply_to_string)
+    return collect_str_addresses(reply_to_string);
+  return NULL;
+}
+
+
+static AddressesList *get_to_addresses(GMimeMessage *message) {
+  InternetAddressList *recipients_to = g_mime_message_get_recipients(message, GMIME_RECIPIENT_TYPE_TO); // transfer-none
+  if (recipients_to)
+    return collect_addresses(recipients_to);
+  return NULL;
+}
+
+
+static AddressesList *get_cc_addresses(GMimeMessage *message) {
+  InternetAddressList *recipients_cc = g_mime_message_get_recipients(message, GMIME_RECIPIENT_TYPE_CC); // transfer-none
+  if (recipients_cc)
+    return collect_addresses(recipients_cc);
+  return NULL;
+}
+
+
+static AddressesList *get_bcc_addresses(GMimeMessage *message) {
+  InternetAddressList *recipients_bcc = g_mime_message_get_recipients(message, GMIME_RECIPIENT_TYPE_BCC); // transfer-none
+  if (recipients_bcc)
+    return collect_addresses(recipients_bcc);
+  return NULL;
+}
+
+
+/*
+ * Parse arena
+ *
+ * Gumbo allocates every node, attribute, string and vector of the tree on
+ * its own. We hand it a bump arena instead, through GumboOptions, in which
+ * frees do nothing: the whole tree goes away at once when the arena is
+ * reset after sanitizing. One chunk is kept between parses.
+ *
+ * Large blocks are the buffers of long texts and attributes and of wide
+ * vectors, which Gumbo grows by allocating a larger one and freeing the old.
+ * Those are allocated on their own and freed right away, or each growth of a
+ * long text would stay in the arena until the reset.
+ *
+ * The most the arena holds during a parse is charged to the memory budget
+ * of the request, and released with the reset.
+ */
+#define PARSE_ARENA_CHUNK_SIZE (256 * 1024)
+#define PARSE_ARENA_ALIGNMENT  16
+
+typedef struct ParseArenaChunk {
+  struct ParseArenaChunk *next;
+  gsize                  size;   // of the data
+  gsize                  used;
+} ParseArenaChunk;
+
+typedef struct {
+  ParseArenaChunk *chunks;       // the chunk allocated from first
+  GHashTable      *large;        // blocks allocated on their own, to their size
+  MemoryBudget    *budget;
+  gsize           allocated;     // bytes held for the current parse
+  gsize           charged;       // to the budget, the most held so far
+} ParseArena;
+
+static ParseArena parse_arena = { NULL, NULL, NULL, 0, 0 };
+
+// The data of a chunk follows its header, at an aligned offset
+#define PARSE_ARENA_HEADER_SIZE \
+  ((sizeof(ParseArenaChunk) + PARSE_ARENA_ALIGNMENT - 1) & ~(gsize) (PARSE_ARENA_ALIGNMENT - 1))
+#define PARSE_ARENA_CHUNK_DATA(chunk) ((guint8 *) (chunk) + PARSE_ARENA_HEADER_SIZE)
+
+
+static ParseArenaChunk *new_parse_arena_chunk(gsize size) {
+  ParseArenaChunk *chunk = g_malloc(PARSE_ARENA_HEADER_SIZE + size);
+  chunk->next = NULL;
+  chunk->size = size;
+  chunk->used = 0;
+  return chunk;
+}
+
+
+static void parse_arena_hold(ParseArena *arena, gsize size) {
+  arena->allocated += size;
+  if (arena->allocated > arena->charged)
+    arena->charged += memory_budget_reserve(arena->budget, arena->allocated - arena->charged);
+}
+
+
+static void *parse_arena_allocate(void *userdata, size_t size) {
+  ParseArena *arena = (ParseArena *) userdata;
+  ParseArenaChunk *chunk = arena->chunks;
+
+  size = (size + PARSE_ARENA_ALIGNMENT - 1) & ~(gsize) (PARSE_ARENA_ALIGNMENT - 1);
+
+  if (size > PARSE_ARENA_CHUNK_SIZE / 4) {
+    if (!arena->large)
+      arena->large = g_hash_table_new_full(g_direct_hash, g_direct_equal, g_free, NULL);
+    void *large = g_malloc(size);
+    g_hash_table_insert(arena->large, large, GSIZE_TO_POINTER(size));
+    parse_arena_hold(arena, size);
+    return large;
+  }
+
+  if (!chunk || chunk->size - chunk->used < size) {
+    ParseArenaChunk *fresh = new_parse_arena_chunk(PARSE_ARENA_CHUNK_SIZE);
+    parse_arena_hold(arena, PARSE_ARENA_CHUNK_SIZE);
+    fresh->next = chunk;
+    arena->chunks = chunk = fresh;
+  }
+
+  void *block = PARSE_ARENA_CHUNK_DATA(chunk) + chunk->used;
+  chunk->used += size;
+  return block;
+}
+
+
+static void parse_arena_deallocate(void *userdata, void *ptr) {
+  ParseArena *arena = (ParseArena *) userdata;
+
+  // Anything else is released with the whole arena
+  gpointer size;
+  if (arena->large && g_hash_table_lookup_extended(arena->large, ptr, NULL, &size)) {
+    arena->allocated -= GPOINTER_TO_SIZE(size);
+    g_hash_table_remove(arena->large, ptr);
+  }
+}
+
+
+// Drops everything allocated, keeping one chunk of the usual size.
+static void parse_arena_reset(ParseArena *arena) {
+  ParseArenaChunk *kept = NULL;
+
+  while (arena->chunks) {
+    ParseArenaChunk *chunk = arena->chunks;
+    arena->chunks = chunk->next;
+    if (!kept) {
+      kept = chunk;
+      kept->used = 0;
+      kept->next = NULL;
+    } else {
+      g_free(chunk);
+    }
+  }
+  arena->chunks = kept;
+
+  if (arena->large)
+    g_hash_table_remove_all(arena->large);
+
+  memory_budget_release(arena->budget, arena->charged);
+  arena->budget = NULL;
+  arena->allocated = arena->charged = 0;
+}
+
+
+static GumboOutput *parse_html(ParseArena *arena, const gchar *html, gsize length, MemoryBudget *budget) {
+  GumboOptions options = kGumboDefaultOptions;
+
+  // The chunk kept from the last parse is held again
+  arena->budget = budget;
+  if (arena->chunks)
+    parse_arena_hold(arena, arena->chunks->size);
+
+  options.allocator   = parse_arena_allocate;
+  options.deallocator = parse_arena_deallocate;
+  options.userdata    = arena;
+  // Parse errors are never looked at
+  options.max_errors  = 0;
+
+  return gumbo_parse_with_options(&options, html, length);
+}
+
+
+static MessageBody* get_body(CollectedPart *body_part, gboolean sanitize_body, GPtrArray *inlines, const GmimexOptions *options, MemoryBudget *budget) {
+  g_return_val_if_fail(body_part != NULL, NULL);
+
+  MessageBody *mb = new_message_body();
+
+  // We keep the raw size intentionally
+  mb->size = body_part->size;
+  mb->truncated = body_part->truncated;
+
+  mb->content_type = g_strdup(body_part->content_type);
+
+  const gchar *raw_data = (const gchar*) body_part->content->data;
+  gsize raw_length = body_part->content->len;
+  gboolean limited = FALSE;
+
+  // Past the limit, only the HTML up to its last complete tag within it is read
+  gsize max_bytes = options ? options->max_html_bytes : GMIMEX_DEFAULT_MAX_HTML_BYTES;
+  if (sanitize_body && max_bytes && raw_length > max_bytes) {
+    raw_length = html_cut_length(raw_data, max_bytes);
+    mb->truncated = TRUE;
+  }
+
+  if (sanitize_body && options && !g_strcmp0(options->sanitizer_engine, STREAM_SANITIZER_ENGINE)) {
+    // Sanitized while tokenized, without a parse tree to charge for
+    mb->content = sanitize_stream(raw_data, raw_length, inlines, options, &limited);
+    if (limited)
+      mb->truncated = TRUE;
+
+    gsize kept = memory_budget_reserve(budget, mb->content->len);
+    if (kept < mb->content->len) {
+      truncate_html(mb->content, kept);
+      mb->truncated = TRUE;
+    }
+  } else if (sanitize_body) {
+    // The parse tree takes at least as much as the content it is built from,
+    // so past the budget only the HTML up to its last complete tag within the
+    // remainder is parsed. The arena charges what the tree actually takes.
+    gsize available = memory_budget_reserve(budget, raw_length);
+    memory_budget_release(budget, available);
+    if (available < raw_length) {
+      raw_length = html_cut_length(raw_data, available);
+      mb->truncated = TRUE;
+    }
+
+    // Parse any HTML tags
+    GumboOutput* output = parse_html(&parse_arena, raw_data, raw_length, budget);
+
+    // Remove unallowed HTML tags (like scripts, bad href etc..)
+    GString *sanitized_content = sanitize(output->document, inlines, options, raw_length, &limited);
+    mb->content = sanitized_content;
+    if (limited)
+      mb->truncated = TRUE;
+
+    // The tree lives in the arena, so it needs no gumbo_destroy_output
+    parse_arena_reset(&parse_arena);
+
+    gsize kept = memory_budget_reserve(budget, mb->content->len);
+    if (kept < mb->content->len) {
+      truncate_html(mb->content, kept);
+      mb->truncated = TRUE;
+    }
+  } else {
+    gsize kept = memory_budget_reserve(budget, raw_length);
+    mb->content = g_string_new_len(raw_data, raw_length);
+    if (kept < raw_length) {
+      truncate_utf8(mb->content, kept);
+      mb->truncated = TRUE;
+    }
+  }
+
+  return mb;
+}
+
+
+static gchar *guess_content_type_extension(const gchar *content_type) {
+  g_return_val_if_fail(content_type != NULL, NULL);
 
   gchar *extension = "txt";
   if (!g_ascii_strcasecmp(content_type, "text/plain")) {
@@ -1351,234 +5882,1364 @@ static gchar *guess_content_type_extension(const gchar *content_type) {
   } else if (!g_ascii_strcasecmp(content_type, "image/bmp")) {
     extension = "bmp";
   }
-  return extension;
+  return extension;
+}
+
+
+static gchar *filename_for(CollectedPart *part) {
+  if (part->filename)
+    return g_strdup(part->filename);
+
+  if (part->content_id) {
+    if (gc_contains_c(part->content_id, '.'))
+      return g_strjoin(NULL, "_", part->content_id, NULL);
+    return g_strjoin(NULL, "_", part->content_id, ".", guess_content_type_extension(part->content_type), NULL);
+  }
+  return g_strjoin(NULL, "_unnamed", ".", guess_content_type_extension(part->content_type), NULL);
+}
+
+
+static void add_attachments_from_parts(MessageAttachmentsList *list, GPtrArray *att_parts) {
+  g_return_if_fail((att_parts != NULL) && (list != NULL));
+  g_return_if_fail(att_parts->len > 0);
+
+  guint i;
+  for (i = 0; i < att_parts->len; i++) {
+    CollectedPart *att_part = g_ptr_array_index(att_parts, i);
+    MessageAttachment *attachment = new_message_attachment(att_part->part_id);
+    attachment->content_type = g_strdup(att_part->content_type);
+    attachment->size = att_part->size;
+    attachment->filename = filename_for(att_part);
+    message_attachments_list_add(list, attachment);
+  }
+}
+
+
+
+static MessageAttachmentsList *get_attachments(PartCollectorData *pdata) {
+  g_return_val_if_fail(pdata != NULL, NULL);
+  g_return_val_if_fail((pdata->attachments != NULL) ||
+                       (pdata->inlines != NULL) ||
+                       (pdata->alternative_bodies != NULL), NULL);
+
+  MessageAttachmentsList *att_list = new_message_attachments_list();
+
+  if (pdata->alternative_bodies && pdata->alternative_bodies->len > 0)
+    add_attachments_from_parts(att_list, pdata->alternative_bodies);
+
+  if (pdata->attachments && pdata->attachments->len > 0)
+    add_attachments_from_parts(att_list, pdata->attachments);
+
+  if (pdata->inlines && pdata->inlines->len > 0)
+    add_attachments_from_parts(att_list, pdata->inlines);
+
+  if (att_list->len)
+    return att_list;
+
+  free_message_attachments_list(att_list);
+  return NULL;
+}
+
+
+static MessageData *convert_message(GMimeMessage *message, guint content_option, const GmimexOptions *options, MemoryBudget *budget) {
+  if (!message)
+    return NULL;
+
+  MessageData *md = new_message_data();
+
+  const gchar *message_id = g_mime_message_get_message_id(message);
+  if (message_id)
+    md->message_id = g_strdup(message_id);
+
+  md->from     = get_from_addresses(message);
+  md->reply_to = get_reply_to_addresses(message);
+  md->to       = get_to_addresses(message);
+  md->cc       = get_cc_addresses(message);
+  md->bcc      = get_bcc_addresses(message);
+
+  const gchar *subject = g_mime_message_get_subject(message);
+  if (subject)
+    md->subject = g_strdup(subject);
+
+  md->date = g_mime_message_get_date_as_string(message);
+
+  const gchar *in_reply_to = g_mime_object_get_header(GMIME_OBJECT (message), "In-Reply-To");
+  if (in_reply_to) {
+    gchar *in_reply_to_str = g_mime_utils_header_decode_text(in_reply_to);
+    md->in_reply_to = g_mime_references_decode(in_reply_to_str);
+    g_free(in_reply_to_str);
+  }
+
+  const gchar *references = g_mime_object_get_header(GMIME_OBJECT (message), "References");
+  if (references) {
+    gchar *references_str = g_mime_utils_header_decode_text(references);
+    md->references = g_mime_references_decode(references_str);
+    g_free(references_str);
+  }
+
+  if (content_option) {
+    PartCollectorData *pc = collect_parts(message, content_option, options, budget);
+
+    if (pc->text_part)
+      md->text = get_body(pc->text_part, (content_option != COLLECT_RAW_CONTENT), NULL, options, budget);
+
+    if (pc->html_part)
+      md->html = get_body(pc->html_part, (content_option != COLLECT_RAW_CONTENT), pc->inlines, options, budget);
+
+    md->attachments = get_attachments(pc);
+
+    free_part_collector_data(pc);
+  }
+
+  // Bodies cut short by their own limits leave the budget untouched
+  md->truncated = (budget && budget->exhausted) || (md->html && md->html->truncated) ||
+                  (md->text && md->text->truncated);
+
+  return md;
+}
+
+
+
+static JSON_Value *address_to_json(Address *addr) {
+  if (!addr)
+    return NULL;
+
+  JSON_Value *address_value = json_value_init_object();
+  JSON_Object *address_object = json_value_get_object(address_value);
+
+  json_object_set_string(address_object, "name",    addr->name);
+  json_object_set_string(address_object, "address", addr->address);
+
+  return address_value;
+}
+
+
+static JSON_Value *addresses_list_to_json(AddressesList *addr_list) {
+  if (!addr_list)
+    return NULL;
+
+  JSON_Value *addreses_value = json_value_init_array();
+  JSON_Array *addresses_ary = json_value_get_array(addreses_value);
+
+  guint i;
+  for (i = 0; i < addr_list->len; i++) {
+    Address *addr = addresses_list_get(addr_list, i);
+    JSON_Value *jaddr = address_to_json(addr);
+    json_array_append_value(addresses_ary, jaddr);
+  }
+
+  return addreses_value;
+}
+
+
+static JSON_Value *message_body_to_json(MessageBody *mbody, gboolean is_html, MemoryBudget *budget) {
+  if (!mbody)
+    return NULL;
+
+  // The JSON value keeps a copy of the content
+  gsize kept = memory_budget_reserve(budget, mbody->content->len);
+  if (kept < mbody->content->len) {
+    if (is_html)
+      truncate_html(mbody->content, kept);
+    else
+      truncate_utf8(mbody->content, kept);
+    mbody->truncated = TRUE;
+  }
+
+  JSON_Value *body_value = json_value_init_object();
+  JSON_Object *body_object = json_value_get_object(body_value);
+
+  json_object_set_string(body_object, "type",    mbody->content_type);
+  json_object_set_string(body_object, "content", mbody->content->str);
+  json_object_set_number(body_object, "size",    mbody->size);
+
+  if (mbody->truncated)
+    json_object_set_boolean(body_object, "truncated", TRUE);
+
+  return body_value;
+}
+
+
+
+static JSON_Value *message_attachments_list_to_json(MessageAttachmentsList *matts) {
+  if (!matts)
+    return NULL;
+
+  JSON_Value *attachments_value = json_value_init_array();
+  JSON_Array *attachments_array = json_value_get_array(attachments_value);
+  guint i;
+  for (i = 0; i < matts->len; i++) {
+    MessageAttachment *att = message_attachments_list_get(matts, i);
+    JSON_Value  *attachment_value = json_value_init_object();
+    JSON_Object *attachment_object = json_value_get_object(attachment_value);
+    json_object_set_number(attachment_object, "partId",   att->part_id);
+    json_object_set_string(attachment_object, "type",     att->content_type);
+    json_object_set_string(attachment_object, "filename", att->filename);
+    json_object_set_number(attachment_object, "size",     att->size);
+    json_array_append_value(attachments_array, attachment_value);
+  }
+  return attachments_value;
+}
+
+
+static JSON_Value *references_to_json(GMimeReferences *references) {
+  if (!references)
+    return NULL;
+
+  const char *msgid;
+  const GMimeReferences *cur;
+  JSON_Value *references_value = json_value_init_array();
+  JSON_Array *references_array = json_value_get_array(references_value);
+
+  for (cur = references; cur; cur = g_mime_references_get_next(cur)) {
+    msgid = g_mime_references_get_message_id (cur);
+    json_array_append_string(references_array, msgid);
+  }
+
+  return references_value;
+}
+
+
+/*
+ * Attachment detection
+ *
+ * Whether a message has attachments, and how many, is told from the
+ * Content-Type and Content-Disposition of its parts, so previews can show it
+ * without decoding the attachments. Parts with a Content-ID are part of the
+ * body only when the html refers to them, which is the one content decoded,
+ * and only when such a part is found. Signatures are not attachments to the
+ * reader, and an encrypted body is a single one.
+ */
+typedef struct AttachmentCounter {
+  GMimeObject *body;
+  GString *html;
+} AttachmentCounter;
+
+
+static void collect_html_text(GMimeObject *object, GString *html) {
+  if (GMIME_IS_MULTIPART(object)) {
+    gint count = g_mime_multipart_get_count(GMIME_MULTIPART(object));
+    gint i;
+    for (i = 0; i < count && html->len < ATTACHMENT_HTML_SCAN_SIZE; i++)
+      collect_html_text(g_mime_multipart_get_part(GMIME_MULTIPART(object), i), html);
+    return;
+  }
+
+  if (!GMIME_IS_PART(object) || !g_mime_content_type_is_type(g_mime_object_get_content_type(object), "text", "html"))
+    return;
+
+  GMimeDataWrapper *wrapper = g_mime_part_get_content_object(GMIME_PART(object)); // transfer none
+  if (!wrapper)
+    return;
+
+  GMimeStream *html_stream = g_mime_stream_mem_new();
+  g_mime_stream_mem_set_owner(GMIME_STREAM_MEM(html_stream), FALSE);
+  write_decoded_content(wrapper, html_stream, ATTACHMENT_HTML_SCAN_SIZE - html->len, NULL, NULL);
+
+  GByteArray *content = g_mime_stream_mem_get_byte_array(GMIME_STREAM_MEM(html_stream));
+  g_string_append_len(html, (const gchar *) content->data, content->len);
+  g_byte_array_free(content, TRUE);
+  g_object_unref(html_stream);
+}
+
+
+// Tells whether the html of the message refers to the Content-ID by a cid: URL
+static gboolean content_id_is_referenced(AttachmentCounter *counter, const gchar *content_id) {
+  if (!counter->html) {
+    counter->html = g_string_new(NULL);
+    collect_html_text(counter->body, counter->html);
+  }
+
+  gsize length = strlen(content_id);
+  const gchar *end = counter->html->str + counter->html->len;
+  const gchar *cid = counter->html->str;
+  while ((cid = g_strstr_len(cid, end - cid, "cid:"))) {
+    cid += 4;
+    if ((gsize) (end - cid) >= length && !g_ascii_strncasecmp(cid, content_id, length))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+
+static gboolean part_is_attachment(GMimePart *part, AttachmentCounter *counter) {
+  GMimeObject *object = GMIME_OBJECT(part);
+  GMimeContentDisposition *disposition = g_mime_object_get_content_disposition(object);
+  const gchar *disposition_type = disposition ? g_mime_content_disposition_get_disposition(disposition) : NULL;
+
+  if (disposition_type && !g_ascii_strcasecmp(disposition_type, GMIME_DISPOSITION_ATTACHMENT))
+    return TRUE;
+
+  GMimeContentType *content_type = g_mime_object_get_content_type(object);
+  if (g_mime_content_type_is_type(content_type, "application", "pgp-signature") ||
+      g_mime_content_type_is_type(content_type, "application", "pkcs7-signature") ||
+      g_mime_content_type_is_type(content_type, "application", "x-pkcs7-signature"))
+    return FALSE;
+
+  const gchar *content_id = g_mime_part_get_content_id(part);
+  if (content_id && content_id_is_referenced(counter, content_id))
+    return FALSE;
+
+  if (g_mime_part_get_filename(part))
+    return TRUE;
+
+  gboolean is_inline = disposition_type && !g_ascii_strcasecmp(disposition_type, GMIME_DISPOSITION_INLINE);
+  return !is_inline && !g_mime_content_type_is_type(content_type, "text", "*");
+}
+
+
+static guint count_part_attachments(GMimeObject *object, AttachmentCounter *counter) {
+  // The control part and the encrypted data make up a single body
+  if (GMIME_IS_MULTIPART_ENCRYPTED(object))
+    return 1;
+
+  if (GMIME_IS_MULTIPART(object)) {
+    gint count = g_mime_multipart_get_count(GMIME_MULTIPART(object));
+    guint attachments = 0;
+    gint i;
+    for (i = 0; i < count; i++)
+      attachments += count_part_attachments(g_mime_multipart_get_part(GMIME_MULTIPART(object), i), counter);
+    return attachments;
+  }
+
+  // A forwarded message is one attachment, whatever it contains
+  if (GMIME_IS_MESSAGE_PART(object))
+    return 1;
+
+  if (GMIME_IS_PART(object))
+    return part_is_attachment(GMIME_PART(object), counter) ? 1 : 0;
+
+  return 0;
 }
 
 
-static gchar *filename_for(CollectedPart *part) {
-  if (part->filename)
-    return g_strdup(part->filename);
+static guint count_attachments(GMimeObject *body) {
+  AttachmentCounter counter = { body, NULL };
+  guint attachments = count_part_attachments(body, &counter);
+  if (counter.html)
+    g_string_free(counter.html, TRUE);
+  return attachments;
+}
 
-  if (part->content_id) {
-    if (gc_contains_c(part->content_id, '.'))
-      return g_strjoin(NULL, "_", part->content_id, NULL);
-    return g_strjoin(NULL, "_", part->content_id, ".", guess_content_type_extension(part->content_type), NULL);
+
+// A message parsed from its headers alone has a multipart body without any
+// parts, which needs the whole message to be parsed to tell attachments. That
+// includes alternatives, which may have related parts or mixed ones in them.
+static gboolean message_needs_structure(GMimeMessage *message) {
+  GMimeObject *body = g_mime_message_get_mime_part(message);
+  return body && GMIME_IS_MULTIPART(body) && g_mime_multipart_get_count(GMIME_MULTIPART(body)) == 0;
+}
+
+
+static GString *gmime_message_to_json(GMimeMessage *message, guint content_option, const GmimexOptions *options, MemoryBudget *budget) {
+  MessageData *mdata = convert_message(message, content_option, options, budget);
+
+
+  JSON_Value *root_value = json_value_init_object();
+  JSON_Object *root_object = json_value_get_object(root_value);
+
+  json_object_set_value(root_object,  "from",        addresses_list_to_json(mdata->from));
+  json_object_set_value(root_object,  "to",          addresses_list_to_json(mdata->to));
+  json_object_set_value(root_object,  "replyTo",     addresses_list_to_json(mdata->reply_to));
+  json_object_set_value(root_object,  "cc",          addresses_list_to_json(mdata->cc));
+  json_object_set_value(root_object,  "bcc",         addresses_list_to_json(mdata->bcc));
+  json_object_set_string(root_object, "messageId",   mdata->message_id);
+  json_object_set_string(root_object, "subject",     mdata->subject);
+  json_object_set_string(root_object, "date",        mdata->date);
+
+  json_object_set_value(root_object, "inReplyTo",   references_to_json(mdata->in_reply_to));
+  json_object_set_value(root_object, "references",  references_to_json(mdata->references));
+
+  json_object_set_value(root_object,  "text",        message_body_to_json(mdata->text, FALSE, budget));
+  json_object_set_value(root_object,  "html",        message_body_to_json(mdata->html, TRUE, budget));
+  json_object_set_value(root_object,  "attachments", message_attachments_list_to_json(mdata->attachments));
+
+  GMimeObject *body = g_mime_message_get_mime_part(message);
+  guint attachments_count = body ? count_attachments(body) : 0;
+  json_object_set_boolean(root_object, "hasAttachments",   attachments_count > 0);
+  json_object_set_number(root_object,  "attachmentsCount", attachments_count);
+
+  if (mdata->truncated || (budget && budget->exhausted))
+    json_object_set_boolean(root_object, "truncated", TRUE);
+
+  free_message_data(mdata);
+
+  // The serialized JSON is charged for too, and written once, straight into
+  // the string returned
+  gsize serialized_size = json_serialization_size(root_value);
+  if (memory_budget_reserve(budget, serialized_size) < serialized_size &&
+      !json_object_get_value(root_object, "truncated")) {
+    json_object_set_boolean(root_object, "truncated", TRUE);
+    serialized_size = json_serialization_size(root_value);
   }
-  return g_strjoin(NULL, "_unnamed", ".", guess_content_type_extension(part->content_type), NULL);
+
+  GString *json_string = g_string_sized_new(serialized_size);
+  if (serialized_size && json_serialize_to_buffer(root_value, json_string->str, serialized_size) == JSONSuccess)
+    g_string_set_size(json_string, serialized_size - 1);
+  json_value_free(root_value);
+
+  return json_string;
+}
+
+
+
+/*
+ * Structure
+ *
+ * The MIME tree of a message as IMAP describes it in BODYSTRUCTURE and
+ * ENVELOPE: types, parameters, encodings, encoded sizes and line counts,
+ * with embedded messages described in full. No content is decoded; sizes
+ * and lines are counted over the encoded content. Parts carry their IMAP
+ * section ("1", "2.1", "3.1.2") and the partId get_part uses.
+ */
+typedef struct StructureWalk {
+  guint  part_id;
+  guint  depth;
+  GArray *embedded;  // of EmbeddedCount, the messages described within the one being described
+} StructureWalk;
+
+// The size and lines of an embedded message, counted once for it and its
+// enclosing ones.
+typedef struct EmbeddedCount {
+  GMimeMessagePart *message_part;
+  GMimeMessage     *message;
+  gint64           size;
+  gint64           lines;
+} EmbeddedCount;
+
+
+static JSON_Value *structure_object_to_json(GMimeObject *object, const gchar *section, StructureWalk *walk);
+
+
+static JSON_Value *params_to_json(const GMimeParam *param) {
+  if (!param)
+    return NULL;
+
+  JSON_Value *params_value = json_value_init_object();
+  JSON_Object *params_object = json_value_get_object(params_value);
+
+  for (; param; param = g_mime_param_next(param)) {
+    gchar *name = g_ascii_strdown(g_mime_param_get_name(param), -1);
+    json_object_set_string(params_object, name, g_mime_param_get_value(param));
+    g_free(name);
+  }
+
+  return params_value;
+}
+
+
+static JSON_Value *disposition_to_json(GMimeObject *object) {
+  GMimeContentDisposition *disposition = g_mime_object_get_content_disposition(object);
+  if (!disposition)
+    return NULL;
+
+  JSON_Value *disposition_value = json_value_init_object();
+  JSON_Object *disposition_object = json_value_get_object(disposition_value);
+
+  gchar *type = g_ascii_strdown(g_mime_content_disposition_get_disposition(disposition), -1);
+  json_object_set_string(disposition_object, "type", type);
+  json_object_set_value(disposition_object, "parameters", params_to_json(g_mime_content_disposition_get_params(disposition)));
+  g_free(type);
+
+  return disposition_value;
+}
+
+
+// Converts the addresses to JSON, freeing them.
+static JSON_Value *take_addresses_json(AddressesList *addresses) {
+  if (!addresses)
+    return NULL;
+
+  JSON_Value *addresses_value = addresses_list_to_json(addresses);
+  free_addresses_list(addresses);
+  return addresses_value;
+}
+
+
+static JSON_Value *envelope_to_json(GMimeMessage *message) {
+  JSON_Value *envelope_value = json_value_init_object();
+  JSON_Object *envelope_object = json_value_get_object(envelope_value);
+  GMimeObject *object = GMIME_OBJECT(message);
+
+  gchar *date = g_mime_message_get_date_as_string(message);
+  json_object_set_string(envelope_object, "date", date);
+  g_free(date);
+
+  json_object_set_string(envelope_object, "subject", g_mime_message_get_subject(message));
+  json_object_set_value(envelope_object,  "from",    take_addresses_json(get_from_addresses(message)));
+
+  const gchar *sender = g_mime_object_get_header(object, "Sender");
+  if (sender)
+    json_object_set_value(envelope_object, "sender", take_addresses_json(collect_str_addresses(sender)));
+
+  json_object_set_value(envelope_object, "replyTo", take_addresses_json(get_reply_to_addresses(message)));
+  json_object_set_value(envelope_object, "to",      take_addresses_json(get_to_addresses(message)));
+  json_object_set_value(envelope_object, "cc",      take_addresses_json(get_cc_addresses(message)));
+  json_object_set_value(envelope_object, "bcc",     take_addresses_json(get_bcc_addresses(message)));
+
+  const gchar *in_reply_to = g_mime_object_get_header(object, "In-Reply-To");
+  if (in_reply_to) {
+    GMimeReferences *references = g_mime_references_decode(in_reply_to);
+    json_object_set_value(envelope_object, "inReplyTo", references_to_json(references));
+    g_mime_references_free(references);
+  }
+
+  json_object_set_string(envelope_object, "messageId", g_mime_message_get_message_id(message));
+
+  return envelope_value;
+}
+
+
+// Section of the body of a message (the top level one or an embedded one)
+// whose own section is `prefix`: a multipart body shares it, as its
+// children are numbered directly below it, a single part body is "1" in it.
+static gchar *body_section(const gchar *prefix, GMimeObject *body) {
+  if (GMIME_IS_MULTIPART(body))
+    return g_strdup(prefix);
+  return *prefix ? g_strconcat(prefix, ".1", NULL) : g_strdup("1");
+}
+
+
+static void structure_common_to_json(GMimeObject *object, JSON_Object *json_object) {
+  GMimeContentType *content_type = g_mime_object_get_content_type(object);
+
+  gchar *type = g_ascii_strdown(g_mime_content_type_get_media_type(content_type), -1);
+  gchar *subtype = g_ascii_strdown(g_mime_content_type_get_media_subtype(content_type), -1);
+  json_object_set_string(json_object, "type", type);
+  json_object_set_string(json_object, "subtype", subtype);
+  g_free(type);
+  g_free(subtype);
+
+  json_object_set_value(json_object, "parameters", params_to_json(g_mime_content_type_get_params(content_type)));
+  json_object_set_value(json_object, "disposition", disposition_to_json(object));
+
+  const gchar *language = g_mime_object_get_header(object, "Content-Language");
+  if (language)
+    json_object_set_string(json_object, "language", language);
+
+  const gchar *location = g_mime_object_get_header(object, "Content-Location");
+  if (location)
+    json_object_set_string(json_object, "location", location);
+}
+
+
+static JSON_Value *structure_part_to_json(GMimePart *part, const gchar *section, StructureWalk *walk) {
+  JSON_Value *part_value = json_value_init_object();
+  JSON_Object *part_object = json_value_get_object(part_value);
+  GMimeObject *object = GMIME_OBJECT(part);
+
+  json_object_set_string(part_object, "section", section);
+
+  // Numbered like get_part does, which skips partial messages
+  if (!GMIME_IS_MESSAGE_PARTIAL(part))
+    json_object_set_number(part_object, "partId", walk->part_id++);
+
+  structure_common_to_json(object, part_object);
+
+  json_object_set_string(part_object, "id",          g_mime_part_get_content_id(part));
+  json_object_set_string(part_object, "description", g_mime_part_get_content_description(part));
+  json_object_set_string(part_object, "md5",         g_mime_part_get_content_md5(part));
+
+  const gchar *encoding = g_mime_content_encoding_to_string(g_mime_part_get_content_encoding(part));
+  json_object_set_string(part_object, "encoding", encoding ? encoding : "7bit");
+
+  GMimeDataWrapper *wrapper = g_mime_part_get_content_object(part);
+  if (wrapper) {
+    GMimeStream *encoded = g_mime_data_wrapper_get_stream(wrapper); // transfer none
+    GMimeStream *source  = g_mime_stream_substream(encoded, encoded->bound_start, encoded->bound_end);
+
+    // Lines are only part of the structure of text, which is the only
+    // content we need to read for it
+    if (g_mime_content_type_is_type(g_mime_object_get_content_type(object), "text", "*")) {
+      GMimeStream *counter = g_mime_stream_null_new();
+      g_mime_stream_write_to_stream(source, counter);
+      json_object_set_number(part_object, "size",  GMIME_STREAM_NULL(counter)->written);
+      json_object_set_number(part_object, "lines", GMIME_STREAM_NULL(counter)->newlines);
+      g_object_unref(counter);
+    } else {
+      json_object_set_number(part_object, "size", MAX(g_mime_stream_length(source), 0));
+    }
+
+    g_object_unref(source);
+  }
+
+  return part_value;
+}
+
+
+static JSON_Value *structure_message_part_to_json(GMimeMessagePart *message_part, const gchar *section, StructureWalk *walk) {
+  JSON_Value *part_value = json_value_init_object();
+  JSON_Object *part_object = json_value_get_object(part_value);
+  GMimeMessage *message = g_mime_message_part_get_message(message_part); // transfer none
+
+  json_object_set_string(part_object, "section", section);
+  structure_common_to_json(GMIME_OBJECT(message_part), part_object);
+  json_object_set_string(part_object, "encoding", "7bit");
+
+  if (!message)
+    return part_value;
+
+  json_object_set_value(part_object, "envelope", envelope_to_json(message));
+
+  GMimeObject *body = g_mime_message_get_mime_part(message);
+  guint first_embedded = walk->embedded->len;
+
+  if (body && walk->depth < RECURSION_LIMIT) {
+    walk->depth++;
+    gchar *child_section = body_section(section, body);
+    json_object_set_value(part_object, "body", structure_object_to_json(body, child_section, walk));
+    g_free(child_section);
+    walk->depth--;
+  } else if (body) {
+    g_printerr("endless recursion detected: %d\r\n", walk->depth);
+  }
+
+  // The embedded message is written as it was parsed, only to be counted.
+  // The messages within it, counted already, are left out of the writing
+  // and their counts added, so that each is written once.
+  EmbeddedCount count = { message_part, message, 0, 0 };
+  guint i;
+
+  for (i = first_embedded; i < walk->embedded->len; i++) {
+    EmbeddedCount *within = &g_array_index(walk->embedded, EmbeddedCount, i);
+    count.size += within->size;
+    count.lines += within->lines;
+    g_object_ref(within->message);
+    g_mime_message_part_set_message(within->message_part, NULL);
+  }
+
+  GMimeStream *counter = g_mime_stream_null_new();
+  g_mime_object_write_to_stream(GMIME_OBJECT(message), counter);
+  count.size += GMIME_STREAM_NULL(counter)->written;
+  count.lines += GMIME_STREAM_NULL(counter)->newlines;
+  g_object_unref(counter);
+
+  for (i = first_embedded; i < walk->embedded->len; i++) {
+    EmbeddedCount *within = &g_array_index(walk->embedded, EmbeddedCount, i);
+    g_mime_message_part_set_message(within->message_part, within->message);
+    g_object_unref(within->message);
+  }
+
+  json_object_set_number(part_object, "size",  count.size);
+  json_object_set_number(part_object, "lines", count.lines);
+
+  // It stands for the ones within it in the counts of enclosing messages
+  g_array_set_size(walk->embedded, first_embedded);
+  g_array_append_val(walk->embedded, count);
+
+  return part_value;
+}
+
+
+static JSON_Value *structure_multipart_to_json(GMimeMultipart *multipart, const gchar *section, StructureWalk *walk) {
+  JSON_Value *multipart_value = json_value_init_object();
+  JSON_Object *multipart_object = json_value_get_object(multipart_value);
+
+  // A multipart only has a section of its own when nested in another one
+  if (*section)
+    json_object_set_string(multipart_object, "section", section);
+  structure_common_to_json(GMIME_OBJECT(multipart), multipart_object);
+
+  JSON_Value *parts_value = json_value_init_array();
+  JSON_Array *parts_array = json_value_get_array(parts_value);
+
+  gint count = g_mime_multipart_get_count(multipart);
+  gint i;
+  for (i = 0; i < count; i++) {
+    GMimeObject *child = g_mime_multipart_get_part(multipart, i); // transfer none
+    gchar *child_section = *section ? g_strdup_printf("%s.%d", section, i + 1) : g_strdup_printf("%d", i + 1);
+    json_array_append_value(parts_array, structure_object_to_json(child, child_section, walk));
+    g_free(child_section);
+  }
+
+  json_object_set_value(multipart_object, "parts", parts_value);
+  return multipart_value;
+}
+
+
+static JSON_Value *structure_object_to_json(GMimeObject *object, const gchar *section, StructureWalk *walk) {
+  if (GMIME_IS_MULTIPART(object))
+    return structure_multipart_to_json(GMIME_MULTIPART(object), section, walk);
+  if (GMIME_IS_MESSAGE_PART(object))
+    return structure_message_part_to_json(GMIME_MESSAGE_PART(object), section, walk);
+  if (GMIME_IS_PART(object))
+    return structure_part_to_json(GMIME_PART(object), section, walk);
+  return json_value_init_null();
+}
+
+
+static GString *gmime_message_structure_to_json(GMimeMessage *message) {
+  JSON_Value *root_value = json_value_init_object();
+  JSON_Object *root_object = json_value_get_object(root_value);
+  StructureWalk walk = { 0, 0, g_array_new(FALSE, FALSE, sizeof(EmbeddedCount)) };
+
+  json_object_set_value(root_object, "envelope", envelope_to_json(message));
+
+  GMimeObject *body = g_mime_message_get_mime_part(message);
+  if (body) {
+    gchar *section = body_section("", body);
+    json_object_set_value(root_object, "body", structure_object_to_json(body, section, &walk));
+    g_free(section);
+  }
+  g_array_free(walk.embedded, TRUE);
+
+  gchar *serialized_string = json_serialize_to_string(root_value);
+  json_value_free(root_value);
+
+  GString *json_string = g_string_new(serialized_string);
+  g_free(serialized_string);
+
+  return json_string;
+}
+
+
+
+/*
+ * Batched reads
+ *
+ * Previews of a page of messages need only the header block of every file.
+ * Instead of opening and reading the files one after another, the opens and
+ * reads of a whole batch are handed to the kernel together (through io_uring
+ * when built with it, otherwise as readahead hints followed by pread), so on
+ * a cold cache the reads are served in parallel. Each message is parsed as
+ * soon as its read completes. Files whose headers do not fit into the read
+ * window, or that are compressed, go through the regular path.
+ */
+typedef struct BatchRead BatchRead;
+typedef void (*BatchReadParse)(BatchRead *read);
+
+struct BatchRead {
+  const gchar    *path;
+  gint           fd;
+  gchar          *buffer;
+  gssize         length;    // bytes read, negative on failure
+  BatchReadParse parse;     // turns what was read into json
+  gconstpointer  user_data;
+  GString        *json;     // the result, once parsed
+  gboolean       in_flight; // submitted to io_uring, not completed yet
+};
+
+
+// Length of the header block within what was read, 0 when it is not all
+// there or the file is compressed.
+static gsize batch_read_headers_length(BatchRead *read) {
+  if (read->length <= 0)
+    return 0;
+
+  gboolean compressed = (read->length >= 2 && (guchar) read->buffer[0] == 0x1f && (guchar) read->buffer[1] == 0x8b) ||
+                        (read->length >= 4 && !memcmp(read->buffer, "\x28\xb5\x2f\xfd", 4));
+  if (compressed)
+    return 0;
+
+  return header_block_length((const guint8 *) read->buffer, read->length);
+}
+
+
+static void batch_read_parse_preview(BatchRead *read) {
+  GMimeMessage *message = NULL;
+
+  // Attachments are told from the structure of multipart messages, read from
+  // the window too unless it runs past it
+  gsize headers_length = batch_read_headers_length(read);
+  if (headers_length)
+    message = gmime_message_from_window(read->buffer, read->length, headers_length, read->length < BATCH_READ_SIZE);
+
+  if (!message)
+    message = gmime_message_from_path(read->path, -1, TRUE);
+
+  if (message && message_needs_structure(message)) {
+    g_object_unref(message);
+    message = gmime_message_from_path(read->path, -1, FALSE);
+  }
+
+  if (message) {
+    read->json = gmime_message_to_json(message, 0, NULL, NULL);
+    g_object_unref(message);
+  }
+}
+
+
+#ifdef HAVE_LIBURING
+// Waits for the next completion, through any signal that interrupts it.
+static gboolean batch_read_wait(struct io_uring *ring, struct io_uring_cqe **cqe) {
+  gint result;
+  while ((result = io_uring_wait_cqe(ring, cqe)) == -EINTR)
+    ;
+  return result == 0;
+}
+
+
+// Once waiting has failed, cancels the requests still in flight and reaps
+// them as they end, so that no open or read completes after the batch is
+// freed. Files opened anyway are closed, and reads left without a result go
+// through the regular path.
+static void batch_read_cancel(struct io_uring *ring, BatchRead *reads, guint count, gboolean opening) {
+  struct io_uring_cqe *cqe;
+  guint i, pending = 0;
+
+  for (i = 0; i < count; i++) {
+    if (!reads[i].in_flight)
+      continue;
+    struct io_uring_sqe *sqe = io_uring_get_sqe(ring);
+    io_uring_prep_cancel(sqe, &reads[i], 0);
+    io_uring_sqe_set_data(sqe, NULL);
+    pending += 2;
+  }
+  io_uring_submit(ring);
+
+  for (; pending && batch_read_wait(ring, &cqe); pending--) {
+    BatchRead *read = io_uring_cqe_get_data(cqe);
+    gint result = cqe->res;
+    io_uring_cqe_seen(ring, cqe);
+    if (!read || !read->in_flight)
+      continue;
+
+    read->in_flight = FALSE;
+    if (opening && result >= 0)
+      close(result);
+    else if (!opening)
+      read->parse(read);
+  }
+}
+
+
+static void batch_read_files(BatchRead *reads, guint count) {
+  struct io_uring ring;
+  struct io_uring_cqe *cqe;
+  guint i, pending;
+
+  if (io_uring_queue_init(count, &ring, 0) < 0) {
+    for (i = 0; i < count; i++)
+      reads[i].parse(&reads[i]);
+    return;
+  }
+
+  // Open all the files of the batch at once
+  for (i = 0; i < count; i++) {
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_openat(sqe, AT_FDCWD, reads[i].path, O_RDONLY, 0);
+    io_uring_sqe_set_data(sqe, &reads[i]);
+    reads[i].in_flight = TRUE;
+  }
+  io_uring_submit(&ring);
+
+  for (pending = count; pending; pending--) {
+    if (!batch_read_wait(&ring, &cqe)) {
+      batch_read_cancel(&ring, reads, count, TRUE);
+      break;
+    }
+    BatchRead *read = io_uring_cqe_get_data(cqe);
+    read->fd = cqe->res;
+    read->in_flight = FALSE;
+    io_uring_cqe_seen(&ring, cqe);
+  }
+
+  // Then read their header windows, parsing each one as it arrives
+  pending = 0;
+  for (i = 0; i < count; i++) {
+    if (reads[i].fd < 0) {
+      reads[i].parse(&reads[i]);
+      continue;
+    }
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&ring);
+    io_uring_prep_read(sqe, reads[i].fd, reads[i].buffer, BATCH_READ_SIZE, 0);
+    io_uring_sqe_set_data(sqe, &reads[i]);
+    reads[i].in_flight = TRUE;
+    pending++;
+  }
+  io_uring_submit(&ring);
+
+  for (; pending; pending--) {
+    if (!batch_read_wait(&ring, &cqe)) {
+      batch_read_cancel(&ring, reads, count, FALSE);
+      break;
+    }
+    BatchRead *read = io_uring_cqe_get_data(cqe);
+    read->length = cqe->res;
+    read->in_flight = FALSE;
+    io_uring_cqe_seen(&ring, cqe);
+    read->parse(read);
+  }
+
+  io_uring_queue_exit(&ring);
+}
+#else
+static void batch_read_files(BatchRead *reads, guint count) {
+  guint i;
+
+  // Opening all files first and telling the kernel what we are about to read
+  // lets it queue the reads of the whole batch with the device at once.
+  for (i = 0; i < count; i++) {
+    reads[i].fd = open(reads[i].path, O_RDONLY);
+    if (reads[i].fd >= 0)
+      posix_fadvise(reads[i].fd, 0, BATCH_READ_SIZE, POSIX_FADV_WILLNEED);
+  }
+
+  for (i = 0; i < count; i++) {
+    if (reads[i].fd >= 0)
+      reads[i].length = pread(reads[i].fd, reads[i].buffer, BATCH_READ_SIZE, 0);
+    reads[i].parse(&reads[i]);
+  }
+}
+#endif
+
+
+// Reads the files in batches, returning a JSON array of what `parse` made of
+// each one, with null for those that failed.
+static GString *batch_read_to_json(gchar **paths, guint count, BatchReadParse parse, gconstpointer user_data) {
+  GString *json_list = g_string_new("[");
+  guint start, i;
+
+  for (start = 0; start < count; start += BATCH_QUEUE_DEPTH) {
+    guint batch_count = MIN(BATCH_QUEUE_DEPTH, count - start);
+    BatchRead *reads = g_new0(BatchRead, batch_count);
+    gchar *buffers = g_malloc(batch_count * BATCH_READ_SIZE);
+
+    for (i = 0; i < batch_count; i++) {
+      reads[i].path   = paths[start + i];
+      reads[i].fd     = -1;
+      reads[i].buffer = buffers + i * BATCH_READ_SIZE;
+      reads[i].length = -1;
+      reads[i].parse  = parse;
+      reads[i].user_data = user_data;
+    }
+
+    batch_read_files(reads, batch_count);
+
+    for (i = 0; i < batch_count; i++) {
+      if (start + i)
+        g_string_append_c(json_list, ',');
+
+      if (reads[i].json) {
+        g_string_append_len(json_list, reads[i].json->str, reads[i].json->len);
+        g_string_free(reads[i].json, TRUE);
+      } else {
+        g_string_append(json_list, "null");
+      }
+
+      if (reads[i].fd >= 0)
+        close(reads[i].fd);
+    }
+
+    g_free(buffers);
+    g_free(reads);
+  }
+
+  g_string_append_c(json_list, ']');
+  return json_list;
+}
+
+
+static GString *gmime_previews_to_json(gchar **paths, guint count) {
+  return batch_read_to_json(paths, count, batch_read_parse_preview, NULL);
+}
+
+
+/*
+ * Headers
+ *
+ * Arbitrary headers are served from the header block alone: it is read up
+ * to the empty line that ends it and split into fields by a small tokenizer,
+ * without GMime building a message. Every field comes with its raw value, as
+ * written in the message, and its decoded value.
+ */
+
+// Reads up to the end of the header block, or of the file if it has none.
+static GByteArray *read_header_block_from(FILE *file) {
+  GByteArray *block = g_byte_array_new();
+  gchar buffer[HEADER_READ_SIZE];
+  size_t nread;
+
+  while ((nread = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    if (decompressed_append(block, buffer, nread, TRUE))
+      break;
+
+  return block;
+}
+
+
+static GByteArray *read_header_block(const gchar *path, gint64 message_offset) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    g_printerr("cannot open file '%s': %s\r\n", path, g_strerror(errno));
+    return NULL;
+  }
+
+  GByteArray *block = NULL;
+  if (message_offset >= 0) {
+    if (!fseeko(file, message_offset, SEEK_SET)) {
+      // The From_ line in front of an mbox message is not one of its headers
+      gchar line[MBOX_FROM_LINE_MAX];
+      if (fgets(line, sizeof(line), file) && g_str_has_prefix(line, "From ")) {
+        while (!strchr(line, '\n') && fgets(line, sizeof(line), file));
+      } else {
+        fseeko(file, message_offset, SEEK_SET);
+      }
+      block = read_header_block_from(file);
+    }
+  } else {
+    MessageCompression compression = detect_compression(file);
+    if (compression == MESSAGE_COMPRESSION_NONE) {
+      block = read_header_block_from(file);
+    } else {
+      // The stream owns the file from now on
+      GMimeStream *stream = compressed_file_stream_new(file, compression);
+      file = NULL;
+      if (stream) {
+        gboolean complete;
+        block = inflate_stream_read_window(stream, 1, &complete);
+        g_object_unref(stream);
+      }
+
+      // Decompressing stops past the header block, which is all that is kept
+      gsize headers_length = block ? header_block_length(block->data, block->len) : 0;
+      if (headers_length)
+        g_byte_array_set_size(block, headers_length);
+    }
+  }
+
+  if (file)
+    fclose(file);
+  return block;
 }
 
 
-static void add_attachments_from_parts(MessageAttachmentsList *list, GPtrArray *att_parts) {
-  g_return_if_fail((att_parts != NULL) && (list != NULL));
-  g_return_if_fail(att_parts->len > 0);
+// Returns NULL, meaning all headers, when "all" is among the names.
+static gchar **header_names_wanted(gchar **names) {
+  gchar **name;
+  for (name = names; name && *name; name++)
+    if (!g_ascii_strcasecmp(*name, "all"))
+      return NULL;
+  return names;
+}
 
-  guint i;
-  for (i = 0; i < att_parts->len; i++) {
-    CollectedPart *att_part = g_ptr_array_index(att_parts, i);
-    MessageAttachment *attachment = new_message_attachment(att_part->part_id);
-    attachment->content_type = g_strdup(att_part->content_type);
-    attachment->size = att_part->content->len;
-    attachment->filename = filename_for(att_part);
-    message_attachments_list_add(list, attachment);
-  }
+
+static gboolean header_name_wanted(const gchar *name, gsize length, gchar **names) {
+  if (!names)
+    return TRUE;
+
+  for (; *names; names++)
+    if (strlen(*names) == length && !g_ascii_strncasecmp(*names, name, length))
+      return TRUE;
+  return FALSE;
 }
 
 
+// A copy of the text that is valid UTF-8, as 8 bit headers may be anything.
+static gchar *header_text_utf8(const gchar *text, gsize length) {
+  if (utf8_validate_fast((const guchar *) text, length))
+    return g_strndup(text, length);
 
-static MessageAttachmentsList *get_attachments(PartCollectorData *pdata) {
-  g_return_val_if_fail(pdata != NULL, NULL);
-  g_return_val_if_fail((pdata->attachments != NULL) ||
-                       (pdata->inlines != NULL) ||
-                       (pdata->alternative_bodies != NULL), NULL);
+  GByteArray view = { (guint8 *) text, length };
+  GByteArray *valid = utf8_make_valid(&view);
+  g_byte_array_append(valid, (const guint8 *) "", 1);
+  return (gchar *) g_byte_array_free(valid, FALSE);
+}
 
-  MessageAttachmentsList *att_list = new_message_attachments_list();
 
-  if (pdata->alternative_bodies && pdata->alternative_bodies->len > 0)
-    add_attachments_from_parts(att_list, pdata->alternative_bodies);
+static void append_header_field(JSON_Array *headers_array, const gchar *name, gsize name_length, const gchar *value, gsize value_length) {
+  gchar *name_str = header_text_utf8(name, name_length);
+  gchar *raw = header_text_utf8(value, value_length);
+
+  // Unfold before decoding, the line breaks are not part of the value
+  gchar *unfolded = g_strdup(raw);
+  gchar *src, *dst;
+  for (src = dst = unfolded; *src; src++)
+    if (*src != '\r' && *src != '\n')
+      *dst++ = *src;
+  *dst = '\0';
+  gchar *decoded = g_mime_utils_header_decode_text(unfolded);
+
+  JSON_Value *field_value = json_value_init_object();
+  JSON_Object *field_object = json_value_get_object(field_value);
+  json_object_set_string(field_object, "name",  name_str);
+  json_object_set_string(field_object, "raw",   raw);
+  json_object_set_string(field_object, "value", decoded);
+  json_array_append_value(headers_array, field_value);
+
+  g_free(decoded);
+  g_free(unfolded);
+  g_free(raw);
+  g_free(name_str);
+}
 
-  if (pdata->attachments && pdata->attachments->len > 0)
-    add_attachments_from_parts(att_list, pdata->attachments);
 
-  if (pdata->inlines && pdata->inlines->len > 0)
-    add_attachments_from_parts(att_list, pdata->inlines);
+/*
+ * Splits the header block into fields, a field being a "Name: value" line
+ * with the lines starting with whitespace that follow it, and adds those
+ * wanted to the array in the order of the message. Lines without a colon
+ * are skipped.
+ */
+static void tokenize_header_block(const gchar *data, gsize length, gchar **names, JSON_Array *headers_array) {
+  const gchar *ptr = data;
+  const gchar *end = data + length;
+
+  while (ptr < end) {
+    // An empty line ends the block
+    if (*ptr == '\n' || (*ptr == '\r' && ptr + 1 < end && ptr[1] == '\n'))
+      break;
+
+    const gchar *field_end = memchr(ptr, '\n', end - ptr);
+    if (!field_end)
+      field_end = end;
+    while (field_end + 1 < end && (field_end[1] == ' ' || field_end[1] == '\t')) {
+      const gchar *line_end = memchr(field_end + 1, '\n', end - field_end - 1);
+      field_end = line_end ? line_end : end;
+    }
 
-  if (att_list->len)
-    return att_list;
+    const gchar *colon = memchr(ptr, ':', field_end - ptr);
+    if (colon) {
+      const gchar *name_end = colon;
+      while (name_end > ptr && (name_end[-1] == ' ' || name_end[-1] == '\t'))
+        name_end--;
+
+      const gchar *value = colon + 1;
+      const gchar *value_end = field_end;
+      while (value < value_end && (*value == ' ' || *value == '\t'))
+        value++;
+      if (value_end > value && value_end[-1] == '\r')
+        value_end--;
+
+      if (name_end > ptr && header_name_wanted(ptr, name_end - ptr, names))
+        append_header_field(headers_array, ptr, name_end - ptr, value, value_end - value);
+    }
 
-  free_message_attachments_list(att_list);
-  return NULL;
+    ptr = (field_end < end) ? field_end + 1 : end;
+  }
 }
 
 
-static MessageData *convert_message(GMimeMessage *message, guint content_option) {
-  if (!message)
-    return NULL;
+static GString *header_block_to_json(const gchar *data, gsize length, gchar **names) {
+  JSON_Value *root_value = json_value_init_object();
+  JSON_Object *root_object = json_value_get_object(root_value);
+  JSON_Value *headers_value = json_value_init_array();
 
-  MessageData *md = new_message_data();
+  tokenize_header_block(data, length, names, json_value_get_array(headers_value));
+  json_object_set_value(root_object, "headers", headers_value);
 
-  const gchar *message_id = g_mime_message_get_message_id(message);
-  if (message_id)
-    md->message_id = g_strdup(message_id);
+  gchar *serialized_string = json_serialize_to_string(root_value);
+  json_value_free(root_value);
 
-  md->from     = get_from_addresses(message);
-  md->reply_to = get_reply_to_addresses(message);
-  md->to       = get_to_addresses(message);
-  md->cc       = get_cc_addresses(message);
-  md->bcc      = get_bcc_addresses(message);
+  GString *json_string = g_string_new(serialized_string);
+  g_free(serialized_string);
 
-  const gchar *subject = g_mime_message_get_subject(message);
-  if (subject)
-    md->subject = g_strdup(subject);
+  return json_string;
+}
 
-  md->date = g_mime_message_get_date_as_string(message);
 
-  const gchar *in_reply_to = g_mime_object_get_header(GMIME_OBJECT (message), "In-Reply-To");
-  if (in_reply_to) {
-    gchar *in_reply_to_str = g_mime_utils_header_decode_text(in_reply_to);
-    md->in_reply_to = g_mime_references_decode(in_reply_to_str);
-    g_free(in_reply_to_str);
+static void batch_read_parse_headers(BatchRead *read) {
+  gsize headers_length = batch_read_headers_length(read);
+  if (headers_length) {
+    read->json = header_block_to_json(read->buffer, headers_length, (gchar **) read->user_data);
+    return;
   }
 
-  const gchar *references = g_mime_object_get_header(GMIME_OBJECT (message), "References");
-  if (references) {
-    gchar *references_str = g_mime_utils_header_decode_text(references);
-    md->references = g_mime_references_decode(references_str);
-    g_free(references_str);
+  GByteArray *block = read_header_block(read->path, -1);
+  if (block) {
+    read->json = header_block_to_json((const gchar *) block->data, block->len, (gchar **) read->user_data);
+    g_byte_array_free(block, TRUE);
   }
+}
 
-  if (content_option) {
-    PartCollectorData *pc = collect_parts(message, content_option);
 
-    if (pc->text_part)
-      md->text = get_body(pc->text_part, (content_option != COLLECT_RAW_CONTENT), NULL);
 
-    if (pc->html_part)
-      md->html = get_body(pc->html_part, (content_option != COLLECT_RAW_CONTENT), pc->inlines);
+/*
+ *
+ *
+ */
+GString *gmimex_get_json(gchar *path, gint64 message_offset, guint content_option, const GmimexOptions *options) {
+  if (options && options->sanitizer_policy && !find_sanitizer_policy(options->sanitizer_policy)) {
+    g_printerr("Unknown sanitizer policy: %s\r\n", options->sanitizer_policy);
+    return NULL;
+  }
+  if (options && options->sanitizer_engine && g_strcmp0(options->sanitizer_engine, STREAM_SANITIZER_ENGINE) &&
+      g_strcmp0(options->sanitizer_engine, TREE_SANITIZER_ENGINE)) {
+    g_printerr("Unknown sanitizer engine: %s\r\n", options->sanitizer_engine);
+    return NULL;
+  }
 
-    md->attachments = get_attachments(pc);
+  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
 
-    free_part_collector_data(pc);
+  // Previews only need the headers, which spares decompressing a whole message,
+  // unless it is a multipart one whose attachments are past the first window
+  GMimeMessage *message = gmime_message_from_path(path, message_offset, (content_option == 0));
+  if (message && message_needs_structure(message)) {
+    g_object_unref(message);
+    message = gmime_message_from_path(path, message_offset, FALSE);
   }
+  if (!message)
+    return NULL;
 
-  return md;
+  MemoryBudget *budget = new_memory_budget(options ? options->memory_budget : 0);
+  GString *json_message = gmime_message_to_json(message, content_option, options, budget);
+  free_memory_budget(budget);
+  g_object_unref(message);
+
+  g_mime_shutdown();
+  return json_message;
 }
 
 
+/*
+ *
+ *
+ */
+GByteArray *gmimex_get_part(gchar *path, gint64 message_offset, guint part_id, const gchar *section) {
+  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
 
-static JSON_Value *address_to_json(Address *addr) {
-  if (!addr)
+  GMimeMessage *message = gmime_message_from_path(path, message_offset, FALSE);
+  if (!message)
     return NULL;
 
-  JSON_Value *address_value = json_value_init_object();
-  JSON_Object *address_object = json_value_get_object(address_value);
-
-  json_object_set_string(address_object, "name",    addr->name);
-  json_object_set_string(address_object, "address", addr->address);
+  GByteArray *attachment = gmime_message_get_part_data(message, part_id, section);
+  g_object_unref(message);
 
-  return address_value;
+  g_mime_shutdown();
+  return attachment;
 }
 
 
-static JSON_Value *addresses_list_to_json(AddressesList *addr_list) {
-  if (!addr_list)
-    return NULL;
+/*
+ *
+ *
+ */
+GByteArray *gmimex_get_part_range(gchar *path, gint64 message_offset, guint part_id, const gchar *section, guint64 offset, guint64 length) {
+  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
 
-  JSON_Value *addreses_value = json_value_init_array();
-  JSON_Array *addresses_ary = json_value_get_array(addreses_value);
+  GMimeMessage *message = gmime_message_from_path(path, message_offset, FALSE);
+  if (!message)
+    return NULL;
 
-  guint i;
-  for (i = 0; i < addr_list->len; i++) {
-    Address *addr = addresses_list_get(addr_list, i);
-    JSON_Value *jaddr = address_to_json(addr);
-    json_array_append_value(addresses_ary, jaddr);
-  }
+  GByteArray *range = NULL;
+  GMimeObject *part = gmime_message_locate_part(message, part_id, section);
+  if (part)
+    range = extract_part_range(part, offset, length);
+  g_object_unref(message);
 
-  return addreses_value;
+  g_mime_shutdown();
+  return range;
 }
 
 
-static JSON_Value *message_body_to_json(MessageBody *mbody) {
-  if (!mbody)
-    return NULL;
+/*
+ *
+ *
+ */
+GString *gmimex_get_part_to_file(gchar *path, gint64 message_offset, guint part_id, const gchar *section, gchar *dest_path) {
+  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
 
-  JSON_Value *body_value = json_value_init_object();
-  JSON_Object *body_object = json_value_get_object(body_value);
+  GMimeMessage *message = gmime_message_from_path(path, message_offset, FALSE);
+  if (!message)
+    return NULL;
 
-  json_object_set_string(body_object, "type",    mbody->content_type);
-  json_object_set_string(body_object, "content", mbody->content->str);
-  json_object_set_number(body_object, "size",    mbody->size);
+  GString *json_result = NULL;
+  GMimeObject *part = gmime_message_locate_part(message, part_id, section);
+  if (part)
+    json_result = extract_part_to_file(part, dest_path);
+  g_object_unref(message);
 
-  return body_value;
+  g_mime_shutdown();
+  return json_result;
 }
 
 
+/*
+ *
+ *
+ */
+GString *gmimex_get_structure(gchar *path, gint64 message_offset) {
+  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
 
-static JSON_Value *message_attachments_list_to_json(MessageAttachmentsList *matts) {
-  if (!matts)
+  GMimeMessage *message = gmime_message_from_path(path, message_offset, FALSE);
+  if (!message)
     return NULL;
 
-  JSON_Value *attachments_value = json_value_init_array();
-  JSON_Array *attachments_array = json_value_get_array(attachments_value);
-  guint i;
-  for (i = 0; i < matts->len; i++) {
-    MessageAttachment *att = message_attachments_list_get(matts, i);
-    JSON_Value  *attachment_value = json_value_init_object();
-    JSON_Object *attachment_object = json_value_get_object(attachment_value);
-    json_object_set_number(attachment_object, "partId",   att->part_id);
-    json_object_set_string(attachment_object, "type",     att->content_type);
-    json_object_set_string(attachment_object, "filename", att->filename);
-    json_object_set_number(attachment_object, "size",     att->size);
-    json_array_append_value(attachments_array, attachment_value);
-  }
-  return attachments_value;
+  GString *json_structure = gmime_message_structure_to_json(message);
+  g_object_unref(message);
+
+  g_mime_shutdown();
+  return json_structure;
 }
 
 
-static JSON_Value *references_to_json(GMimeReferences *references) {
-  if (!references)
+/*
+ *
+ *
+ */
+GString *gmimex_get_headers(gchar *path, gint64 message_offset, gchar **names) {
+  GByteArray *block = read_header_block(path, message_offset);
+  if (!block)
     return NULL;
 
-  const char *msgid;
-  const GMimeReferences *cur;
-  JSON_Value *references_value = json_value_init_array();
-  JSON_Array *references_array = json_value_get_array(references_value);
+  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
+  GString *json_headers = header_block_to_json((const gchar *) block->data, block->len, header_names_wanted(names));
+  g_mime_shutdown();
 
-  for (cur = references; cur; cur = g_mime_references_get_next(cur)) {
-    msgid = g_mime_references_get_message_id (cur);
-    json_array_append_string(references_array, msgid);
-  }
+  g_byte_array_free(block, TRUE);
+  return json_headers;
+}
 
-  return references_value;
+
+/*
+ *
+ *
+ */
+GString *gmimex_get_headers_list(gchar **paths, guint count, gchar **names) {
+  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
+  GString *json_list = batch_read_to_json(paths, count, batch_read_parse_headers, header_names_wanted(names));
+  g_mime_shutdown();
+  return json_list;
 }
 
 
-static GString *gmime_message_to_json(GMimeMessage *message, guint content_option) {
-  MessageData *mdata = convert_message(message, content_option);
+/*
+ *
+ *
+ */
+GString *gmimex_build_mbox_index(gchar *path, gchar *index_path) {
+  FILE *mbox = fopen(path, "r");
+  if (!mbox) {
+    g_printerr("cannot open file '%s': %s\r\n", path, g_strerror(errno));
+    return NULL;
+  }
 
+  gchar *tmp_path = g_strjoin(NULL, index_path, ".XXXXXX", NULL);
+  gint fd = g_mkstemp(tmp_path);
+  FILE *index = (fd < 0) ? NULL : fdopen(fd, "w");
+  if (!index) {
+    g_printerr("cannot create file '%s': %s\r\n", tmp_path, g_strerror(errno));
+    if (fd >= 0)
+      close(fd);
+    fclose(mbox);
+    g_free(tmp_path);
+    return NULL;
+  }
 
-  JSON_Value *root_value = json_value_init_object();
-  JSON_Object *root_object = json_value_get_object(root_value);
+  guint count = 0;
+  gboolean built = build_mbox_index(mbox, index, &count);
+  fclose(mbox);
 
-  json_object_set_value(root_object,  "from",        addresses_list_to_json(mdata->from));
-  json_object_set_value(root_object,  "to",          addresses_list_to_json(mdata->to));
-  json_object_set_value(root_object,  "replyTo",     addresses_list_to_json(mdata->reply_to));
-  json_object_set_value(root_object,  "cc",          addresses_list_to_json(mdata->cc));
-  json_object_set_value(root_object,  "bcc",         addresses_list_to_json(mdata->bcc));
-  json_object_set_string(root_object, "messageId",   mdata->message_id);
-  json_object_set_string(root_object, "subject",     mdata->subject);
-  json_object_set_string(root_object, "date",        mdata->date);
+  if (fclose(index) != 0)
+    built = FALSE;
 
-  json_object_set_value(root_object, "inReplyTo",   references_to_json(mdata->in_reply_to));
-  json_object_set_value(root_object, "references",  references_to_json(mdata->references));
+  if (built && g_rename(tmp_path, index_path) != 0)
+    built = FALSE;
 
-  json_object_set_value(root_object,  "text",        message_body_to_json(mdata->text));
-  json_object_set_value(root_object,  "html",        message_body_to_json(mdata->html));
-  json_object_set_value(root_object,  "attachments", message_attachments_list_to_json(mdata->attachments));
+  if (!built) {
+    g_printerr("cannot write file '%s': %s\r\n", index_path, g_strerror(errno));
+    g_unlink(tmp_path);
+    g_free(tmp_path);
+    return NULL;
+  }
+  g_free(tmp_path);
+
+  JSON_Value *root_value = json_value_init_object();
+  JSON_Object *root_object = json_value_get_object(root_value);
+  json_object_set_string(root_object, "index", index_path);
+  json_object_set_number(root_object, "count", count);
 
-  free_message_data(mdata);
   gchar *serialized_string = json_serialize_to_string(root_value);
   json_value_free(root_value);
-
   GString *json_string = g_string_new(serialized_string);
   g_free(serialized_string);
 
@@ -1586,40 +7247,44 @@ static GString *gmime_message_to_json(GMimeMessage *message, guint content_optio
 }
 
 
-
 /*
  *
  *
  */
-GString *gmimex_get_json(gchar *path, guint content_option) {
+GString *gmimex_get_preview_json_list(gchar **paths, guint count) {
   g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
-
-  GMimeMessage *message = gmime_message_from_path(path);
-  if (!message)
-    return NULL;
-
-  GString *json_message = gmime_message_to_json(message, content_option);
-  g_object_unref(message);
-
+  GString *json_list = gmime_previews_to_json(paths, count);
   g_mime_shutdown();
-  return json_message;
+  return json_list;
 }
 
 
 /*
- *
- *
+ * Loads the sanitizer policies of the key file in place of the current ones,
+ * returning the names of the policies now available.
  */
-GByteArray *gmimex_get_part(gchar *path, guint part_id) {
-  g_mime_init(GMIME_ENABLE_RFC2047_WORKAROUNDS);
-
-  GMimeMessage *message = gmime_message_from_path(path);
-  if (!message)
+GString *gmimex_load_sanitizer_policies(gchar *path) {
+  if (!load_sanitizer_policies(path))
     return NULL;
 
-  GByteArray *attachment = gmime_message_get_part_data(message, part_id);
-  g_object_unref(message);
+  JSON_Value *root_value = json_value_init_object();
+  JSON_Object *root_object = json_value_get_object(root_value);
+  JSON_Value *names_value = json_value_init_array();
+  JSON_Array *names_array = json_value_get_array(names_value);
 
-  g_mime_shutdown();
-  return attachment;
+  GList *names = g_hash_table_get_keys(sanitizer_policies);
+  names = g_list_sort(names, (GCompareFunc) g_strcmp0);
+  GList *name;
+  for (name = names; name; name = name->next)
+    json_array_append_string(names_array, name->data);
+  g_list_free(names);
+
+  json_object_set_value(root_object, "policies", names_value);
+
+  gchar *serialized_string = json_serialize_to_string(root_value);
+  json_value_free(root_value);
+  GString *json_string = g_string_new(serialized_string);
+  g_free(serialized_string);
+
+  return json_string;
 }
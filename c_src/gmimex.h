@@ -1,2 +1,37 @@
-GString *gmimex_get_json(gchar *path, guint content_option);
-GByteArray* gmimex_get_part(gchar *path, guint part_id);
+/*
+ * GmimexOptions
+ *
+ * Per request settings given by the caller.
+ */
+#define GMIMEX_DEFAULT_MEMORY_BUDGET (128 * 1024 * 1024)
+#define GMIMEX_DEFAULT_MAX_DEPTH     512
+#define GMIMEX_DEFAULT_MAX_HTML_BYTES  (4 * 1024 * 1024)
+#define GMIMEX_DEFAULT_MAX_HTML_NODES  200000
+#define GMIMEX_DEFAULT_MAX_HTML_OUTPUT (32 * 1024 * 1024)
+
+typedef struct GmimexOptions {
+  gsize       memory_budget;  // bytes a request may materialize, 0 for no limit
+  const gchar *inline_url;    // template of the URL of inline parts, in which
+                              // "{partId}" is replaced, NULL to embed them
+  const gchar *sanitizer_policy;  // name of the sanitizer policy, NULL for the default
+  const gchar *sanitizer_engine;  // "stream" to sanitize HTML while tokenizing it, without
+                                  // a parse tree, NULL or "tree" to sanitize its parse tree
+  guint       max_depth;      // of the HTML elements written, deeper ones are flattened
+                              // into their text, 0 for no limit
+  gsize       max_html_bytes;   // of a body read before sanitizing it, 0 for no limit
+  gsize       max_html_nodes;   // of a body sanitized before closing it, 0 for no limit
+  gsize       max_html_output;  // bytes of a sanitized body before closing it, 0 for no limit
+  gboolean    minify;           // collapse the whitespace of sanitized bodies outside preformatted
+                                // elements, and leave out redundant quotes and empty attributes
+} GmimexOptions;
+
+GString *gmimex_get_json(gchar *path, gint64 message_offset, guint content_option, const GmimexOptions *options);
+GByteArray* gmimex_get_part(gchar *path, gint64 message_offset, guint part_id, const gchar *section);
+GByteArray* gmimex_get_part_range(gchar *path, gint64 message_offset, guint part_id, const gchar *section, guint64 offset, guint64 length);
+GString *gmimex_get_part_to_file(gchar *path, gint64 message_offset, guint part_id, const gchar *section, gchar *dest_path);
+GString *gmimex_get_structure(gchar *path, gint64 message_offset);
+GString *gmimex_get_headers(gchar *path, gint64 message_offset, gchar **names);
+GString *gmimex_get_headers_list(gchar **paths, guint count, gchar **names);
+GString *gmimex_build_mbox_index(gchar *path, gchar *index_path);
+GString *gmimex_get_preview_json_list(gchar **paths, guint count);
+GString *gmimex_load_sanitizer_policies(gchar *path);
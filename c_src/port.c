@@ -8,6 +8,23 @@
 #define JSON_PREPARED_MESSAGE_CONTENT 1
 #define JSON_RAW_MESSAGE_CONTENT 2
 
+/*
+ * Borrows the strings of a JSON array into a NULL terminated vector, which
+ * is freed with g_free. Without an array, returns NULL.
+ */
+static gchar **json_array_to_strv(JSON_Array *array) {
+	if (!array)
+		return NULL;
+
+	guint count = json_array_get_count(array);
+	gchar **strv = g_new0(gchar *, count + 1);
+	guint i;
+	for (i = 0; i < count; i++)
+		strv[i] = (gchar *)json_array_get_string(array, i);
+	return strv;
+}
+
+
 int main(void) {
     int bytes_read;
     gchar buffer[MAX_BUFFER_SIZE];
@@ -16,6 +33,9 @@ int main(void) {
     gchar *json_str;
     gchar *func_name;
     gchar *path;
+    gint64 message_offset;
+    const gchar *section;
+    GmimexOptions options;
 
     while((bytes_read = read_msg(buffer)) > 0) {
     	json_str = g_strndup((const gchar *)buffer, bytes_read);
@@ -23,19 +43,51 @@ int main(void) {
     	root_object = json_value_get_object(root_value);
     	func_name = (gchar *)json_object_get_string(root_object, "exec");
     	path = (gchar *)json_object_get_string(root_object, "path");
+    	// Messages within an mbox are addressed by the offset of their From_ line
+    	message_offset = json_object_get_value(root_object, "messageOffset") ?
+    	                 (gint64)json_object_get_number(root_object, "messageOffset") : -1;
+    	// Parts are addressed by IMAP section or cid when given, else by partId
+    	section = json_object_get_string(root_object, "section");
+    	options.memory_budget = json_object_get_value(root_object, "memoryBudget") ?
+    	                        (gsize)json_object_get_number(root_object, "memoryBudget") : GMIMEX_DEFAULT_MEMORY_BUDGET;
+    	// Inline parts are referenced by this URL template instead of embedded
+    	options.inline_url = json_object_get_string(root_object, "inlineUrl");
+    	options.sanitizer_policy = json_object_get_string(root_object, "sanitizerPolicy");
+    	options.sanitizer_engine = json_object_get_string(root_object, "sanitizerEngine");
+    	options.max_depth = json_object_get_value(root_object, "maxDepth") ?
+    	                    (guint)json_object_get_number(root_object, "maxDepth") : GMIMEX_DEFAULT_MAX_DEPTH;
+    	// Bodies past these limits are cut short at an element boundary and flagged as truncated
+    	options.max_html_bytes = json_object_get_value(root_object, "maxHtmlBytes") ?
+    	                         (gsize)json_object_get_number(root_object, "maxHtmlBytes") : GMIMEX_DEFAULT_MAX_HTML_BYTES;
+    	options.max_html_nodes = json_object_get_value(root_object, "maxHtmlNodes") ?
+    	                         (gsize)json_object_get_number(root_object, "maxHtmlNodes") : GMIMEX_DEFAULT_MAX_HTML_NODES;
+    	options.max_html_output = json_object_get_value(root_object, "maxHtmlOutput") ?
+    	                          (gsize)json_object_get_number(root_object, "maxHtmlOutput") : GMIMEX_DEFAULT_MAX_HTML_OUTPUT;
+    	options.minify = json_object_get_boolean(root_object, "minify") == 1;
 			GString *json_message = NULL;
 
     	if (!g_ascii_strcasecmp(func_name, "get_preview_json")) {
-				json_message = gmimex_get_json(path, JSON_NO_MESSAGE_CONTENT);
+				json_message = gmimex_get_json(path, message_offset, JSON_NO_MESSAGE_CONTENT, &options);
   			if (!json_message) {
   				send_err();
   			} else {
 					send_msg((gchar *)json_message->str, json_message->len);
 			  	g_string_free(json_message, TRUE);
 			  }
+    	} else if (!g_ascii_strcasecmp(func_name, "get_preview_json_list")) {
+    		JSON_Array *paths_array = json_object_get_array(root_object, "paths");
+    		guint paths_count = json_array_get_count(paths_array);
+    		gchar **paths = g_new0(gchar *, paths_count + 1);
+    		guint i;
+    		for (i = 0; i < paths_count; i++)
+    			paths[i] = (gchar *)json_array_get_string(paths_array, i);
+				json_message = gmimex_get_preview_json_list(paths, paths_count);
+				g_free(paths);
+				send_msg((gchar *)json_message->str, json_message->len);
+				g_string_free(json_message, TRUE);
     	} else if (!g_ascii_strcasecmp(func_name, "get_json")) {
   			gboolean raw = json_object_get_boolean(root_object, "raw");
-  			json_message = gmimex_get_json(path, (raw ? JSON_RAW_MESSAGE_CONTENT : JSON_PREPARED_MESSAGE_CONTENT));
+  			json_message = gmimex_get_json(path, message_offset, (raw ? JSON_RAW_MESSAGE_CONTENT : JSON_PREPARED_MESSAGE_CONTENT), &options);
   			if (!json_message) {
   				send_err();
   			} else {
@@ -44,13 +96,79 @@ int main(void) {
 			  }
     	} else if (!g_ascii_strcasecmp(func_name, "get_part")) {
     		int part_id = json_object_get_number(root_object, "partId");
-			  GByteArray *part_content = gmimex_get_part(path, part_id);
+			  GByteArray *part_content = gmimex_get_part(path, message_offset, part_id, section);
 			  if (!part_content) {
 			  	send_err();
 			  } else {
     			send_msg((gchar *)part_content->data, part_content->len);
     			g_byte_array_free(part_content, TRUE);
     		}
+    	} else if (!g_ascii_strcasecmp(func_name, "get_part_range")) {
+    		int part_id = json_object_get_number(root_object, "partId");
+    		guint64 offset = json_object_get_number(root_object, "offset");
+    		guint64 length = json_object_get_number(root_object, "length");
+			  GByteArray *part_range = gmimex_get_part_range(path, message_offset, part_id, section, offset, length);
+			  if (!part_range) {
+			  	send_err();
+			  } else {
+    			send_msg((gchar *)part_range->data, part_range->len);
+    			g_byte_array_free(part_range, TRUE);
+    		}
+    	} else if (!g_ascii_strcasecmp(func_name, "get_part_to_file")) {
+    		int part_id = json_object_get_number(root_object, "partId");
+    		gchar *destination = (gchar *)json_object_get_string(root_object, "destination");
+  			json_message = destination ? gmimex_get_part_to_file(path, message_offset, part_id, section, destination) : NULL;
+  			if (!json_message) {
+  				send_err();
+  			} else {
+					send_msg((gchar *)json_message->str, json_message->len);
+			  	g_string_free(json_message, TRUE);
+			  }
+    	} else if (!g_ascii_strcasecmp(func_name, "get_structure")) {
+  			json_message = gmimex_get_structure(path, message_offset);
+  			if (!json_message) {
+  				send_err();
+  			} else {
+					send_msg((gchar *)json_message->str, json_message->len);
+			  	g_string_free(json_message, TRUE);
+			  }
+    	} else if (!g_ascii_strcasecmp(func_name, "get_headers")) {
+    		// Without names, or with "all" among them, all headers are returned
+    		gchar **names = json_array_to_strv(json_object_get_array(root_object, "names"));
+  			json_message = gmimex_get_headers(path, message_offset, names);
+  			g_free(names);
+  			if (!json_message) {
+  				send_err();
+  			} else {
+					send_msg((gchar *)json_message->str, json_message->len);
+			  	g_string_free(json_message, TRUE);
+			  }
+    	} else if (!g_ascii_strcasecmp(func_name, "get_headers_list")) {
+    		JSON_Array *paths_array = json_object_get_array(root_object, "paths");
+    		gchar **paths = json_array_to_strv(paths_array);
+    		gchar **names = json_array_to_strv(json_object_get_array(root_object, "names"));
+				json_message = gmimex_get_headers_list(paths, json_array_get_count(paths_array), names);
+				g_free(names);
+				g_free(paths);
+				send_msg((gchar *)json_message->str, json_message->len);
+				g_string_free(json_message, TRUE);
+    	} else if (!g_ascii_strcasecmp(func_name, "load_sanitizer_policies")) {
+  			json_message = gmimex_load_sanitizer_policies(path);
+  			if (!json_message) {
+  				send_err();
+  			} else {
+					send_msg((gchar *)json_message->str, json_message->len);
+			  	g_string_free(json_message, TRUE);
+			  }
+    	} else if (!g_ascii_strcasecmp(func_name, "build_mbox_index")) {
+    		gchar *index_path = (gchar *)json_object_get_string(root_object, "indexPath");
+  			json_message = index_path ? gmimex_build_mbox_index(path, index_path) : NULL;
+  			if (!json_message) {
+  				send_err();
+  			} else {
+					send_msg((gchar *)json_message->str, json_message->len);
+			  	g_string_free(json_message, TRUE);
+			  }
     	}
     	json_value_free(root_value);
     	g_free(json_str);
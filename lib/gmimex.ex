@@ -1,8 +1,19 @@
 defmodule Gmimex do
 
-  @get_json_defaults [raw: false, content: false ]
+  # Options of get_json, detailed in the README:
+  # memory_budget: bytes the port may materialize for a message
+  # inline_url: URL template for cid: references instead of embedded images
+  # sanitizer_policy: a policy of the configured sanitizer_policies file
+  # sanitizer_engine: :tree (default) or :stream
+  # max_depth: nesting of html elements written (512, 0 for no limit)
+  # max_html_bytes, max_html_nodes, max_html_output: html read, sanitized, written
+  # minify: collapse whitespace and drop redundant quotes and empty attributes
+  @get_json_defaults [raw: false, content: false, memory_budget: nil, inline_url: nil, message_key: nil,
+                      sanitizer_policy: nil, sanitizer_engine: nil, max_depth: nil,
+                      max_html_bytes: nil, max_html_nodes: nil, max_html_output: nil, minify: nil]
   @flags_default_opts [value: true]
   @move_message_default_opts [folder: "."]
+  @preview_batch_size 100
 
 
   def get_json(path, opts \\ [])
@@ -11,42 +22,106 @@ defmodule Gmimex do
     {:ok, do_get_json(path, opts)}
   end
 
+  def get_json({mbox_path, offset} = address, opts) when is_binary(mbox_path) and is_integer(offset) do
+    {:ok, do_get_json(address, opts)}
+  end
+
   def get_json(paths, opts) when is_list(paths) do
-    {:ok, paths |> Enum.map(fn(x) ->
+    opts = Keyword.merge(@get_json_defaults, opts)
+    email_paths = paths |> Enum.map(fn(x) ->
       {:ok, email_path} = find_email_path(x)
-      do_get_json(email_path, opts) end)}
+      email_path end)
+    if opts[:content] || opts[:raw] do
+      {:ok, email_paths |> Enum.map(&(do_get_json(&1, opts)))}
+    else
+      {:ok, do_get_preview_json_list(email_paths)}
+    end
   end
 
 
   defp do_get_json(path, opts) do
     opts = Keyword.merge(@get_json_defaults, opts)
-    unless File.exists?(path), do: raise "Email path: #{path} not found"
+    file_path = address_path(path)
+    unless File.exists?(file_path), do: raise "Email path: #{file_path} not found"
     {:ok, server} = GmimexServer.start_link
     {:ok, json_bin} = case opts[:content] do
       false -> GmimexServer.get_preview_json(server, path)
-      true  -> GmimexServer.get_json(server, path, opts[:raw])
+      true  -> GmimexServer.get_json(server, path, opts[:raw],
+                                     memory_budget: opts[:memory_budget],
+                                     inline_url: inline_url(opts[:inline_url], path, opts[:message_key]),
+                                     sanitizer_policy: opts[:sanitizer_policy],
+                                     sanitizer_engine: opts[:sanitizer_engine],
+                                     max_depth: opts[:max_depth],
+                                     max_html_bytes: opts[:max_html_bytes],
+                                     max_html_nodes: opts[:max_html_nodes],
+                                     max_html_output: opts[:max_html_output],
+                                     minify: opts[:minify])
     end
     GmimexServer.stop(server)
     if opts[:raw] do
       json_bin
     else
       {:ok, data} = Poison.Parser.parse(json_bin)
-      flags = get_flags(path)
-      if opts[:content] && data["attachments"] != [], do:
-        flags = flags ++ [:attachments]
-      data
-        |> Map.put("filename", Path.basename(path))
-        |> Map.put("path",     path)
-        |> Map.put("flags",    flags)
+      put_file_info(data, path)
     end
   end
 
 
+  # The previews of all messages are read by the port in batches, which
+  # are kept small enough to fit the port's request buffer.
+  defp do_get_preview_json_list(paths) do
+    {:ok, server} = GmimexServer.start_link
+    data_list = paths
+      |> Enum.chunk(@preview_batch_size, @preview_batch_size, [])
+      |> Enum.flat_map(fn(batch) ->
+        {:ok, json_bin} = GmimexServer.get_preview_json_list(server, batch)
+        {:ok, batch_data} = Poison.Parser.parse(json_bin)
+        batch_data
+      end)
+    GmimexServer.stop(server)
+    Enum.zip(data_list, paths)
+      |> Enum.map(fn({data, path}) ->
+        unless data, do: raise "Email path: #{path} could not be read"
+        put_file_info(data, path)
+      end)
+  end
+
+
+  defp put_file_info(data, path) do
+    file_path = address_path(path)
+    flags = get_flags(path)
+    if data["hasAttachments"], do:
+      flags = flags ++ [:attachments]
+    data
+      |> Map.put("filename", Path.basename(file_path))
+      |> Map.put("path",     file_path)
+      |> Map.put("flags",    flags)
+  end
+
+
+  defp address_path({mbox_path, _offset}), do: mbox_path
+  defp address_path(path), do: path
+
+
+  defp inline_url(nil, _path, _message_key), do: nil
+  defp inline_url(template, path, message_key) do
+    String.replace(template, "{key}", URI.encode(message_key || default_message_key(path), &URI.char_unreserved?/1))
+  end
+
+  defp default_message_key({mbox_path, offset}), do: "#{Path.basename(mbox_path)}:#{offset}"
+  defp default_message_key(path), do: Path.basename(path)
+
+
   def get_json_list(email_list, opts \\ []) do
     email_list |> Enum.map(fn(x) -> {:ok, email} = get_json(x, opts); email end)
   end
 
 
+  @doc """
+  Returns the decoded content of a part. The part is given by its `partId`,
+  or as a string by its IMAP section (`"2.1.3"`) or Content-ID
+  (`"cid:image001@example.com"`), which are looked up directly.
+  """
   def get_part(path, part_id) do
     {:ok, server} = GmimexServer.start_link
     {:ok, data} = GmimexServer.get_part(server, path, part_id)
@@ -55,6 +130,105 @@ defmodule Gmimex do
   end
 
 
+  @doc """
+  Returns `length` bytes of the decoded part, starting at the decoded
+  `offset`. A length of 0 reads until the end of the part.
+  """
+  def get_part_range(path, part_id, offset, length \\ 0) do
+    {:ok, server} = GmimexServer.start_link
+    {:ok, data} = GmimexServer.get_part_range(server, path, part_id, offset, length)
+    GmimexServer.stop(server)
+    data
+  end
+
+
+  @doc """
+  Decodes a part straight into the file at `destination`, without passing
+  its content through the BEAM. Returns the size and SHA-256 of the file.
+  """
+  def get_part_to_file(path, part_id, destination) do
+    {:ok, server} = GmimexServer.start_link
+    {:ok, json_bin} = GmimexServer.get_part_to_file(server, path, part_id, destination)
+    GmimexServer.stop(server)
+    {:ok, data} = Poison.Parser.parse(json_bin)
+    data
+  end
+
+
+  @doc """
+  Returns the given headers (by default all of them) in the order of the
+  message, each with its `name`, `raw` value and decoded `value`. Only the
+  header block of the file is read. Given a list of paths, the files are
+  read in batches and a list of results is returned, with nil for those
+  that could not be read.
+  """
+  def get_headers(path, names \\ ["all"])
+
+  def get_headers(paths, names) when is_list(paths) do
+    {:ok, server} = GmimexServer.start_link
+    headers_list = paths
+      |> Enum.chunk(@preview_batch_size, @preview_batch_size, [])
+      |> Enum.flat_map(fn(batch) ->
+        {:ok, json_bin} = GmimexServer.get_headers_list(server, batch, names)
+        {:ok, batch_data} = Poison.Parser.parse(json_bin)
+        Enum.map(batch_data, &(&1 && &1["headers"]))
+      end)
+    GmimexServer.stop(server)
+    {:ok, headers_list}
+  end
+
+  def get_headers(path, names) do
+    {:ok, server} = GmimexServer.start_link
+    {:ok, json_bin} = GmimexServer.get_headers(server, path, names)
+    GmimexServer.stop(server)
+    {:ok, data} = Poison.Parser.parse(json_bin)
+    {:ok, data["headers"]}
+  end
+
+
+  @doc """
+  Returns the MIME tree of the message the way IMAP describes it in
+  BODYSTRUCTURE and ENVELOPE, without decoding any content. Every part has
+  its IMAP `section` and the `partId` to use with `get_part/2`.
+  """
+  def get_structure(path) do
+    {:ok, server} = GmimexServer.start_link
+    {:ok, json_bin} = GmimexServer.get_structure(server, path)
+    GmimexServer.stop(server)
+    Poison.Parser.parse(json_bin)
+  end
+
+
+  @doc """
+  Builds an index of the messages within an mbox file in a single pass, and
+  writes it to `index_path` (by default next to the mbox). Each message can
+  then be read with `get_json({mbox_path, offset})` and `get_part/2` without
+  splitting the mbox.
+  """
+  def build_mbox_index(mbox_path, index_path \\ nil) do
+    index_path = index_path || "#{mbox_path}.idx"
+    {:ok, server} = GmimexServer.start_link
+    {:ok, json_bin} = GmimexServer.build_mbox_index(server, mbox_path, index_path)
+    GmimexServer.stop(server)
+    {:ok, data} = Poison.Parser.parse(json_bin)
+    {:ok, data}
+  end
+
+
+  @doc """
+  Reads an index written by `build_mbox_index/2`, returning the offset and
+  length of every message, with the From_ line that starts it.
+  """
+  def read_mbox_index(index_path) do
+    index_path
+      |> File.stream!
+      |> Enum.map(fn(line) ->
+        [offset, length, from] = line |> String.rstrip(?\n) |> String.split("\t", parts: 3)
+        %{offset: String.to_integer(offset), length: String.to_integer(length), from: from}
+      end)
+  end
+
+
   @doc """
   Read the emails within a folder.
   Maildir_path is the root directory of the mailbox (without ending in cur,new).
@@ -65,8 +239,9 @@ defmodule Gmimex do
     move_new_to_cur(maildir_path, opts)
     cur_path = Path.join(maildir_path, "cur")
     cur_email_names = files_ordered_by_time_desc(cur_path)
-    emails = Enum.map(cur_email_names, fn(x) ->
-      {:ok, email} = get_json(Path.join(cur_path, x), content: false);email end)
+    {:ok, emails} = cur_email_names
+      |> Enum.map(&(Path.join(cur_path, &1)))
+      |> get_json(content: false)
     sorted_emails = Enum.sort(emails, &(&1["sortId"] > &2["sortId"]))
 
     if from_idx > (len = Enum.count(sorted_emails)), do: from_idx = len
@@ -320,6 +495,9 @@ defmodule Gmimex do
   end
 
 
+  # mbox keeps the flags within the Status headers, not in the filename
+  defp get_flags({_mbox_path, _offset}), do: []
+
   defp get_flags(path) do
     flags = Path.basename(path) |> String.split(":2,") |> List.last
     Enum.reduce(to_char_list(flags), [], fn(x, acc) ->
@@ -13,14 +13,47 @@ defmodule GmimexServer do
     GenServer.call(server, {:get_preview_json, path})
   end
 
-  def get_json(server, path, keep_raw) do
-    GenServer.call(server, {:get_json, path, keep_raw})
+  def get_preview_json_list(server, paths) do
+    GenServer.call(server, {:get_preview_json_list, paths})
+  end
+
+  def get_json(server, path, keep_raw, options \\ []) do
+    GenServer.call(server, {:get_json, path, keep_raw, options})
   end
 
   def get_part(server, path, part_id) do
     GenServer.call(server, {:get_part, path, part_id})
   end
 
+  def get_part_range(server, path, part_id, offset, length) do
+    GenServer.call(server, {:get_part_range, path, part_id, offset, length})
+  end
+
+  def get_part_to_file(server, path, part_id, destination) do
+    GenServer.call(server, {:get_part_to_file, path, part_id, destination})
+  end
+
+  def get_structure(server, path) do
+    GenServer.call(server, {:get_structure, path})
+  end
+
+  def get_headers(server, path, names) do
+    GenServer.call(server, {:get_headers, path, names})
+  end
+
+  def get_headers_list(server, paths, names) do
+    GenServer.call(server, {:get_headers_list, paths, names})
+  end
+
+  def build_mbox_index(server, path, index_path) do
+    GenServer.call(server, {:build_mbox_index, path, index_path})
+  end
+
+  # Swaps the sanitizer policies of the running port for those of the file
+  def load_sanitizer_policies(server, path) do
+    GenServer.call(server, {:load_sanitizer_policies, path})
+  end
+
 
   def init(_) do
     {:ok, %{port: start_port, next_id: 1, awaiting: %{}}}
@@ -45,8 +78,17 @@ defmodule GmimexServer do
   def handle_info(_, state), do: {:noreply, state}
 
 
+  # The port reads the sanitizer policies file configured as
+  # `config :gmimex, sanitizer_policies: path` when it starts
   defp start_port do
-    Port.open({:spawn, :filename.join(:code.priv_dir(:gmimex), 'port')}, [:binary, {:packet, 4}])
+    Port.open({:spawn, :filename.join(:code.priv_dir(:gmimex), 'port')}, [:binary, {:packet, 4}, {:env, port_env}])
+  end
+
+  defp port_env do
+    case Application.get_env(:gmimex, :sanitizer_policies) do
+      nil  -> []
+      path -> [{'GMIMEX_SANITIZER_POLICIES', to_char_list(path)}]
+    end
   end
 
 
@@ -67,14 +109,64 @@ defmodule GmimexServer do
   end
 
   def encode({:get_part, path, part_id}) do
-    "{ \"exec\": \"get_part\", \"path\": \"#{path}\", \"partId\": #{part_id} }" |> to_char_list
+    "{ \"exec\": \"get_part\", #{address(path)}, #{part(part_id)} }" |> to_char_list
+  end
+
+  def encode({:get_part_range, path, part_id, offset, length}) do
+    "{ \"exec\": \"get_part_range\", #{address(path)}, #{part(part_id)}, \"offset\": #{offset}, \"length\": #{length} }" |> to_char_list
+  end
+
+  def encode({:get_part_to_file, path, part_id, destination}) do
+    "{ \"exec\": \"get_part_to_file\", #{address(path)}, #{part(part_id)}, \"destination\": \"#{destination}\" }" |> to_char_list
   end
 
+  def encode({:get_structure, path}), do:
+    "{ \"exec\": \"get_structure\", #{address(path)} }" |> to_char_list
+
+  def encode({:get_headers, path, names}), do:
+    "{ \"exec\": \"get_headers\", #{address(path)}, \"names\": #{Poison.encode!(names)} }" |> to_char_list
+
+  def encode({:get_headers_list, paths, names}), do:
+    %{exec: "get_headers_list", paths: paths, names: names} |> Poison.encode! |> to_char_list
+
   def encode({:get_preview_json, path}), do:
-    "{ \"exec\": \"get_preview_json\", \"path\": \"#{path}\" }" |> to_char_list
+    "{ \"exec\": \"get_preview_json\", #{address(path)} }" |> to_char_list
+
+  def encode({:get_preview_json_list, paths}), do:
+    %{exec: "get_preview_json_list", paths: paths} |> Poison.encode! |> to_char_list
+
+  def encode({:get_json, path, keep_raw, options}), do:
+    "{ \"exec\": \"get_json\", #{address(path)}, \"raw\": #{keep_raw}#{json_options(options)} }" |> to_char_list
+
+  def encode({:load_sanitizer_policies, path}), do:
+    "{ \"exec\": \"load_sanitizer_policies\", \"path\": \"#{path}\" }" |> to_char_list
+
+  def encode({:build_mbox_index, path, index_path}), do:
+    "{ \"exec\": \"build_mbox_index\", \"path\": \"#{path}\", \"indexPath\": \"#{index_path}\" }" |> to_char_list
+
+  # Request options are sent under their name in the port, unless nil
+  @json_options [memory_budget: "memoryBudget", inline_url: "inlineUrl", sanitizer_policy: "sanitizerPolicy",
+                 sanitizer_engine: "sanitizerEngine", max_depth: "maxDepth", max_html_bytes: "maxHtmlBytes",
+                 max_html_nodes: "maxHtmlNodes", max_html_output: "maxHtmlOutput", minify: "minify"]
+
+  defp json_options(options) do
+    for {key, name} <- @json_options, options[key] != nil, into: "", do:
+      ", \"#{name}\": #{Poison.encode!(options[key])}"
+  end
+
+  # A message is either a maildir file or a {mbox, offset} pair
+  defp address({mbox_path, offset}), do:
+    "\"path\": \"#{mbox_path}\", \"messageOffset\": #{offset}"
+
+  defp address(path), do:
+    "\"path\": \"#{path}\""
+
+  # A part is either a partId or an IMAP section ("2.1") or "cid:..." string
+  defp part(part_id) when is_integer(part_id), do:
+    "\"partId\": #{part_id}"
 
-  def encode({:get_json, path, keep_raw}), do:
-    "{ \"exec\": \"get_json\", \"path\": \"#{path}\", \"raw\": #{keep_raw} }" |> to_char_list
+  defp part(section) when is_binary(section), do:
+    "\"section\": #{Poison.encode!(section)}"
 
   def decode( <<101, 114, 114, _message :: binary>>), do:
     :error
@@ -136,6 +136,580 @@ defmodule GmimexTest do
   end
 
 
+  test "get_part decodes base64 like the reference decoder" do
+    path = Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    [_, image_part | _] = path |> File.read! |> String.split("--Apple-Mail-4CE51B22-BB3B-4241-AFDD-4498BB92E189")
+    [_, encoded] = String.split(image_part, ~r/\r?\n\r?\n/, parts: 2)
+    assert Gmimex.get_part(path, 1) == Base.decode64!(String.replace(encoded, ~r/\s/, ""))
+  end
+
+
+  test "get_part_range matches the same window of the full part" do
+    path = Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    part = Gmimex.get_part(path, 1)
+    assert Gmimex.get_part_range(path, 1, 0, 100) == binary_part(part, 0, 100)
+    assert Gmimex.get_part_range(path, 1, 123_457, 4321) == binary_part(part, 123_457, 4321)
+    assert Gmimex.get_part_range(path, 1, byte_size(part) - 10) == binary_part(part, byte_size(part) - 10, 10)
+  end
+
+
+  test "get_part_range decodes base64 of irregular lines in sequence" do
+    on_exit(&GmimexTest.Helpers.restore_from_backup/0)
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    # Two encodings joined, the padding of the first within a line of the usual length
+    encoded = Base.encode64(:binary.copy(<<1, 2, 3, 4>>, 250)) <> Base.encode64(:binary.copy(<<5, 6, 7>>, 2000))
+    lines = for <<line::binary-size(76) <- encoded>>, do: line
+    body = Enum.join(lines, "\r\n") <> "\r\n" <> binary_part(encoded, length(lines) * 76, rem(byte_size(encoded), 76))
+    File.write!(path, "From: test@test.com\r\nContent-Type: multipart/mixed; boundary=\"b\"\r\n\r\n" <>
+                      "--b\r\nContent-Type: text/plain\r\n\r\nbody\r\n" <>
+                      "--b\r\nContent-Type: application/octet-stream\r\nContent-Transfer-Encoding: base64\r\n\r\n" <>
+                      body <> "\r\n--b--\r\n")
+    part = Gmimex.get_part(path, 1)
+    assert Gmimex.get_part_range(path, 1, 3000, 100) == binary_part(part, 3000, 100)
+    assert Gmimex.get_part_range(path, 1, 500, 100) == binary_part(part, 500, 100)
+  end
+
+
+  test "parts of a gzip compressed email are inflated when read" do
+    path = Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    compressed_path = Path.expand("test/data/test.com/aaa/cur/1443716368_1.10854.brumbrum,U=606,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    File.write!(compressed_path, :zlib.gzip(File.read!(path)))
+    part = Gmimex.get_part(path, 1)
+    assert Gmimex.get_part(compressed_path, 1) == part
+    assert Gmimex.get_part_range(compressed_path, 1, 123_457, 4321) == binary_part(part, 123_457, 4321)
+    {:ok, json} = Gmimex.get_json(path, content: true)
+    {:ok, compressed_json} = Gmimex.get_json(compressed_path, content: true)
+    assert compressed_json["text"] == json["text"]
+    assert compressed_json["attachments"] == json["attachments"]
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "get_part_to_file writes the decoded part" do
+    path = Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    destination = Path.expand("test/data/IMG_3969.JPG")
+    part = Gmimex.get_part(path, 1)
+    result = Gmimex.get_part_to_file(path, 1, destination)
+    assert File.read!(destination) == part
+    assert result["size"] == byte_size(part)
+    assert result["sha256"] == :crypto.hash(:sha256, part) |> Base.encode16(case: :lower)
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "get_part_to_file creates the file with the permissions of the umask" do
+    on_exit(&GmimexTest.Helpers.restore_from_backup/0)
+    path = Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    destination = Path.expand("test/data/IMG_3969.JPG")
+    created = Path.expand("test/data/created")
+    File.write!(created, "")
+    Gmimex.get_part_to_file(path, 1, destination)
+    assert File.stat!(destination).mode == File.stat!(created).mode
+  end
+
+
+  test "json of gzip compressed email" do
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_0.10854.brumbrum,U=605,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,FRS")
+    compressed_path = Path.expand("test/data/test.com/aaa/cur/1443716368_1.10854.brumbrum,U=606,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    File.write!(compressed_path, :zlib.gzip(File.read!(path)))
+    {:ok, preview} = Gmimex.get_json(compressed_path)
+    {:ok, json} = Gmimex.get_json(compressed_path, content: true)
+    assert preview["subject"] == "PETITS PRIX : 2 millions de billets a prix Prem's avec TGV et Intercites !"
+    assert json["subject"] == preview["subject"]
+    assert json["html"]["size"] > 0
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "mbox index and messages by offset" do
+    messages = [
+      Path.expand("test/data/test.com/aaa/cur/1443716368_0.10854.brumbrum,U=605,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,FRS"),
+      Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    ]
+    mbox_path = Path.expand("test/data/test.com/archive.mbox")
+    mbox = Enum.map(messages, &("From test@test.com Thu Sep 24 13:55:49 2015\n" <> File.read!(&1) <> "\n"))
+    # A From_ line only starts a message after an empty line
+    quoted = "From test@test.com Thu Sep 24 13:55:49 2015\nFrom: test@test.com\nSubject: Quoted\n\n" <>
+             "first line\nFrom here on, the same message\n"
+    File.write!(mbox_path, Enum.join(mbox) <> quoted)
+
+    {:ok, %{"count" => 3, "index" => index_path}} = Gmimex.build_mbox_index(mbox_path)
+    [first, second, third] = Gmimex.read_mbox_index(index_path)
+    assert first.offset == 0
+    assert second.offset == first.length
+    assert first.from == "test@test.com Thu Sep 24 13:55:49 2015"
+
+    {:ok, json} = Gmimex.get_json({mbox_path, first.offset})
+    assert json["subject"] == "PETITS PRIX : 2 millions de billets a prix Prem's avec TGV et Intercites !"
+    {:ok, json} = Gmimex.get_json({mbox_path, second.offset})
+    assert json["subject"] == "Atrachment"
+    assert Gmimex.get_part({mbox_path, second.offset}, 1) == Gmimex.get_part(Enum.at(messages, 1), 1)
+    {:ok, json} = Gmimex.get_json({mbox_path, third.offset}, content: true)
+    assert json["text"]["content"] =~ "From here on, the same message"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json content within a memory budget is truncated" do
+    path = Path.expand("test/data/test.com/aaa/new/1444073250_1.24235.brumbrum,U=1098,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    {:ok, full} = Gmimex.get_json(path, content: true)
+    {:ok, json} = Gmimex.get_json(path, content: true, memory_budget: 10_000)
+    refute full["truncated"]
+    assert json["truncated"]
+    assert json["html"]["truncated"]
+    assert String.length(json["html"]["content"]) < String.length(full["html"]["content"])
+  end
+
+
+  test "json html past the memory budget keeps the part within it" do
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    # Mostly scripts, so that the body fits the budget but its parse tree doesn't
+    html = String.duplicate("<p>paragraph</p><script>" <> String.duplicate("x", 200) <> "</script>", 400)
+    File.write!(path, "From: test@test.com\r\nSubject: Budget\r\nContent-Type: text/html\r\n\r\n" <> html)
+    {:ok, json} = Gmimex.get_json(path, content: true, memory_budget: 130_000)
+    assert json["html"]["truncated"]
+    assert json["html"]["content"] =~ "<p>paragraph</p>"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json serialized past the memory budget is flagged truncated" do
+    on_exit(&GmimexTest.Helpers.restore_from_backup/0)
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    # The part, the body and its JSON copy fit, the serialized JSON doesn't
+    text = String.duplicate("x", 50_000)
+    File.write!(path, "From: test@test.com\r\nSubject: Budget\r\nContent-Type: text/plain\r\n\r\n" <> text)
+    {:ok, json} = Gmimex.get_json(path, content: true, raw: true, memory_budget: 175_000)
+    assert json["truncated"]
+    assert json["text"]["content"] =~ text
+    {:ok, json} = Gmimex.get_json(path, content: true, raw: true, memory_budget: 250_000)
+    refute json["truncated"]
+  end
+
+
+  test "json text in iso-8859-1 is converted to utf-8" do
+    path = Path.expand("test/data/test.com/aaa/new/1447089870_2.27636.brumbrum,U=1634,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    {:ok, json} = Gmimex.get_json(path, content: true, raw: true)
+    assert json["text"]["content"] =~ "Bossero (S\u00e4nger)"
+    assert String.valid?(json["text"]["content"])
+  end
+
+
+  test "json text in 8bit utf-8 is validated as read" do
+    on_exit(&GmimexTest.Helpers.restore_from_backup/0)
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    # Past 16 bytes, so that the vectorised validator reads whole blocks
+    text = String.duplicate("h\u00e9llo w\u00f6rld \u2713 \u{1F600} ", 8)
+    headers = "From: test@test.com\r\nSubject: Utf8\r\nContent-Type: text/plain; charset=utf-8\r\n" <>
+              "Content-Transfer-Encoding: 8bit\r\n\r\n"
+    File.write!(path, headers <> text)
+    {:ok, json} = Gmimex.get_json(path, content: true)
+    assert json["text"]["content"] =~ String.trim(text)
+    File.write!(path, headers <> text <> <<0xc3, 0x28>> <> text)
+    {:ok, json} = Gmimex.get_json(path, content: true)
+    assert json["text"]["content"] =~ "\u{1F600} \uFFFD(h\u00e9llo"
+    assert String.valid?(json["text"]["content"])
+  end
+
+
+  test "get_structure describes the mime tree without content" do
+    path = Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    {:ok, structure} = Gmimex.get_structure(path)
+    assert structure["envelope"]["subject"] == "Atrachment"
+    assert hd(structure["envelope"]["from"])["address"] == "ojos@gmx.ch"
+
+    body = structure["body"]
+    assert body["type"] == "multipart"
+    assert body["subtype"] == "mixed"
+    assert Enum.map(body["parts"], &(&1["section"])) == ["1", "2", "3"]
+
+    [_, image, _] = body["parts"]
+    assert image["partId"] == 1
+    assert image["type"] == "image"
+    assert image["encoding"] == "base64"
+    assert image["disposition"]["parameters"]["filename"] == "IMG_3969.JPG"
+    assert image["size"] > byte_size(Gmimex.get_part(path, 1))
+  end
+
+
+  test "get_structure counts embedded messages once for each enclosing one" do
+    on_exit(&GmimexTest.Helpers.restore_from_backup/0)
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    inner = "From: b@test.com\nSubject: Inner\nContent-Type: text/plain\n\ninner text\n"
+    middle = "From: c@test.com\nSubject: Middle\nContent-Type: message/rfc822\n\n" <> inner
+    File.write!(path, "From: a@test.com\nSubject: Outer\nContent-Type: multipart/mixed; boundary=\"b\"\n\n" <>
+                      "--b\nContent-Type: text/plain\n\nouter text\n--b\nContent-Type: message/rfc822\n\n" <>
+                      middle <> "\n--b--\n")
+    {:ok, structure} = Gmimex.get_structure(path)
+    [_, middle_part] = structure["body"]["parts"]
+    inner_part = middle_part["body"]
+    assert middle_part["envelope"]["subject"] == "Middle"
+    assert inner_part["envelope"]["subject"] == "Inner"
+    # The middle message adds its From, Subject and Content-Type lines and
+    # the empty line ending them
+    assert middle_part["size"] - inner_part["size"] == byte_size(middle) - byte_size(inner)
+    assert middle_part["lines"] - inner_part["lines"] == 4
+  end
+
+
+  test "get_part by imap section and by cid" do
+    path = Path.expand("test/data/test.com/aaa/new/1444073250_1.24235.brumbrum,U=1098,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    image = Gmimex.get_part(path, 3)
+    assert Gmimex.get_part(path, "1.4") == image
+    assert Gmimex.get_part(path, "cid:cxslkcjwqr") == image
+    assert Gmimex.get_part_range(path, "cid:cxslkcjwqr", 10, 20) == binary_part(image, 10, 20)
+  end
+
+
+  test "get_headers returns raw and decoded values in message order" do
+    path = Path.expand("test/data/test.com/aaa/new/1447089870_2.27636.brumbrum,U=1634,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    {:ok, headers} = Gmimex.get_headers(path, ["Received", "authentication-results"])
+    assert Enum.map(headers, &(&1["name"])) == ["Received", "Authentication-Results", "Received", "Received", "Received", "Received"]
+    assert Enum.at(headers, 1)["value"] == "aspmx1.migadu.com; dmarc=none header.from=elsocial.ch"
+    assert hd(headers)["raw"] =~ "\n"
+    refute hd(headers)["value"] =~ "\n"
+
+    {:ok, all} = Gmimex.get_headers(path)
+    assert Enum.find(all, &(&1["name"] == "Subject"))["value"] == "Theater Asi Es & Livemusik/Technikkurs/Vorschau Dezember"
+
+    {:ok, [batch_headers, nil]} = Gmimex.get_headers([path, path <> ".missing"], ["Received", "authentication-results"])
+    assert batch_headers == headers
+  end
+
+
+  test "previews flag attachments from the mime structure" do
+    attachment_path = Path.expand("test/data/test.com/aaa/new/1447153030_0.18069.brumbrum,U=38500,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    inline_path = Path.expand("test/data/test.com/aaa/new/1444073250_1.24235.brumbrum,U=1098,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+
+    {:ok, json} = Gmimex.get_json(attachment_path)
+    assert json["hasAttachments"]
+    assert json["attachmentsCount"] == 1
+    assert Enum.any?(json["flags"], &(&1 == :attachments))
+
+    {:ok, [batch_json, inline_json]} = Gmimex.get_json([attachment_path, inline_path])
+    assert batch_json["attachmentsCount"] == 1
+    refute inline_json["hasAttachments"]
+  end
+
+
+  test "previews read the mime structure from the window read" do
+    on_exit(&GmimexTest.Helpers.restore_from_backup/0)
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    compressed_path = Path.expand("test/data/test.com/aaa/cur/1443716368_1.10854.brumbrum,U=606,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    # The structure ends within the window, the epilogue runs past it
+    message = "From: test@test.com\r\nSubject: Window\r\nContent-Type: multipart/mixed; boundary=\"b\"\r\n\r\n" <>
+              "--b\r\nContent-Type: text/plain\r\n\r\nbody\r\n" <>
+              "--b\r\nContent-Type: application/pdf\r\nContent-Disposition: attachment; filename=\"a.pdf\"\r\n\r\npdf\r\n" <>
+              "--b--\r\n" <> String.duplicate("epilogue\r\n", 10_000)
+    File.write!(path, message)
+    File.write!(compressed_path, :zlib.gzip(message))
+
+    {:ok, [json, compressed_json]} = Gmimex.get_json([path, compressed_path])
+    assert json["attachmentsCount"] == 1
+    assert compressed_json["attachmentsCount"] == 1
+    {:ok, compressed_json} = Gmimex.get_json(compressed_path)
+    assert compressed_json["attachmentsCount"] == 1
+  end
+
+
+  test "previews count unreferenced, encrypted and alternative attachments" do
+    on_exit(&GmimexTest.Helpers.restore_from_backup/0)
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    attachments_count = fn message ->
+      File.write!(path, message)
+      {:ok, json} = Gmimex.get_json(path)
+      {:ok, [batch_json]} = Gmimex.get_json([path])
+      assert batch_json["attachmentsCount"] == json["attachmentsCount"]
+      json["attachmentsCount"]
+    end
+
+    # Only the image the html refers to is part of the body
+    related = "From: test@test.com\r\nContent-Type: multipart/related; boundary=\"b\"\r\n\r\n" <>
+              "--b\r\nContent-Type: text/html\r\n\r\n<img src=\"cid:used@test\">\r\n" <>
+              "--b\r\nContent-Type: image/png\r\nContent-ID: <used@test>\r\n\r\npng\r\n" <>
+              "--b\r\nContent-Type: image/png\r\nContent-ID: <unused@test>\r\n\r\npng\r\n--b--\r\n"
+    assert attachments_count.(related) == 1
+
+    encrypted = "From: test@test.com\r\nContent-Type: multipart/encrypted; protocol=\"application/pgp-encrypted\"; boundary=\"b\"\r\n\r\n" <>
+                "--b\r\nContent-Type: application/pgp-encrypted\r\n\r\nVersion: 1\r\n" <>
+                "--b\r\nContent-Type: application/octet-stream\r\n\r\n-----BEGIN PGP MESSAGE-----\r\n--b--\r\n"
+    assert attachments_count.(encrypted) == 1
+
+    alternative = "From: test@test.com\r\nContent-Type: multipart/alternative; boundary=\"a\"\r\n\r\n" <>
+                  "--a\r\nContent-Type: text/plain\r\n\r\nbody\r\n" <>
+                  "--a\r\nContent-Type: multipart/mixed; boundary=\"b\"\r\n\r\n" <>
+                  "--b\r\nContent-Type: text/html\r\n\r\n<p>body</p>\r\n" <>
+                  "--b\r\nContent-Type: application/pdf; name=\"a.pdf\"\r\n\r\npdf\r\n--b--\r\n--a--\r\n"
+    assert attachments_count.(alternative) == 1
+  end
+
+
+  test "json html references inline images by url" do
+    path = Path.expand("test/data/test.com/aaa/new/1444073250_1.24235.brumbrum,U=1098,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    {:ok, embedded} = Gmimex.get_json(path, content: true)
+    {:ok, json} = Gmimex.get_json(path, content: true, inline_url: "/messages/{key}/parts/{partId}", message_key: "flyer")
+    assert embedded["html"]["content"] =~ "data:image/"
+    assert json["html"]["content"] =~ "data-proxy-src=\"/messages/flyer/parts/3\""
+    refute json["html"]["content"] =~ "data:image/"
+    assert byte_size(json["html"]["content"]) < byte_size(embedded["html"]["content"])
+    {:ok, json} = Gmimex.get_json(path, content: true, inline_url: "/messages/{key}/parts/{partId}", message_key: "a b+c")
+    assert json["html"]["content"] =~ "data-proxy-src=\"/messages/a%20b%2Bc/parts/3\""
+  end
+
+
+  test "json html sanitized with a configured policy" do
+    path = Path.expand("test/data/test.com/aaa/new/1444073250_1.24235.brumbrum,U=1098,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    policies_path = Path.expand("test/data/sanitizer_policies.conf")
+    File.write!(policies_path, "[text]\npermitted_tags=p;br;b;i;u\npermitted_attributes=\n")
+    Application.put_env(:gmimex, :sanitizer_policies, policies_path)
+    {:ok, json} = Gmimex.get_json(path, content: true, sanitizer_policy: "text")
+    {:ok, default} = Gmimex.get_json(path, content: true)
+    Application.delete_env(:gmimex, :sanitizer_policies)
+    File.rm!(policies_path)
+
+    assert default["html"]["content"] =~ "<img"
+    refute json["html"]["content"] =~ "<img"
+    refute json["html"]["content"] =~ "<table"
+    assert_raise MatchError, fn -> Gmimex.get_json(path, content: true, sanitizer_policy: "missing") end
+  end
+
+
+  # Sanitizes the html as the body of a test message and returns the json
+  # of the body. Both engines run and must agree, unless sanitizer_engine
+  # picks one. Restore from backup after.
+  defp sanitized_json(html, opts \\ []) do
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    File.write!(path, "From: test@test.com\r\nSubject: Html\r\nContent-Type: text/html; charset=utf-8\r\n\r\n" <> html)
+    if opts[:sanitizer_engine] do
+      {:ok, json} = Gmimex.get_json(path, [content: true] ++ opts)
+      json["html"]
+    else
+      {:ok, tree} = Gmimex.get_json(path, [content: true] ++ opts)
+      {:ok, stream} = Gmimex.get_json(path, [content: true, sanitizer_engine: :stream] ++ opts)
+      assert stream["html"] == tree["html"]
+      tree["html"]
+    end
+  end
+
+  defp sanitized_html(html, opts \\ []), do: sanitized_json(html, opts)["content"]
+
+
+  test "json html sanitized escapes the text and attributes of pre" do
+    content = sanitized_html("<pre dir=\"&quot; onmouseover=alert(1) x=&quot;\">&lt;img src=x onerror=alert(1)&gt;</pre>")
+    assert content =~ "<pre dir=\"&quot; onmouseover=alert(1) x=&quot;\">&lt;img src=x onerror=alert(1)&gt;</pre>"
+    refute content =~ "<img"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html sanitized while tokenized implies end tags" do
+    assert sanitized_html("<p>one<p>two<ul><li>a<li>b</ul><dl><dt>t<dd>d</dl>") =~
+      "<p>one</p><p>two</p><ul><li>a</li><li>b</li></ul><dl><dt>t</dt><dd>d</dd></dl>"
+    assert sanitized_html("<select><option>a<option>b<optgroup><option>c</select>") =~
+      "<select><option>a</option><option>b</option><optgroup><option>c</option></optgroup></select>"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html sanitized while tokenized adopts misnested formatting" do
+    assert sanitized_html("<b>bold<p>para</b>after</p>") =~ "<b>bold</b><p><b>para</b>after</p>"
+    assert sanitized_html("<a href=\"http://a\">one<a href=\"http://b\">two</a>") =~
+      "<a href=\"http://a\">one</a><a href=\"http://b\">two</a>"
+    # Only the three innermost formatting elements are reopened around the block
+    assert sanitized_html("<a href=\"http://a\"><b><i><u><s><p>x</a>y") =~
+      "<a href=\"http://a\"><b><i><u><s></s></u></i></b></a><i><u><s><p><a href=\"http://a\">x</a>y</p></s></u></i>"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html sanitized while tokenized fosters content out of tables" do
+    assert sanitized_html("<table>x<tr><td>cell</td></tr>y</table>") =~
+      "xy<table><tbody><tr><td>cell</td></tr></tbody></table>"
+    assert sanitized_html("<table><tr><td><table>a<tr><td>b</td></tr></table></td></tr>c</table>") =~
+      "c<table><tbody><tr><td>a<table><tbody><tr><td>b</td></tr></tbody></table></td></tr></tbody></table>"
+    assert sanitized_html("<table><tr><td>a</td></tr><div>moved<table>in</table></div>y</table>") =~
+      "<div>moved</div><table><tbody><tr><td>a</td></tr></tbody></table>in<table></table>y"
+    assert sanitized_html("<table>" <> String.duplicate("x<tr>", 20_000) <> "</table>") =~
+      String.duplicate("x", 20_000) <> "<table>"
+    assert sanitized_html("<table><tr><td>a</td></tr><b><ul>x</b>y</table>z") =~
+      "<b></b><ul><b>x</b>y</ul><table><tbody><tr><td>a</td></tr></tbody></table>z"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html sanitized while tokenized reads raw text, comments and references" do
+    content = sanitized_html("<textarea><b>not bold</b></textarea><script>alert(1)</script><title>t</title>")
+    assert content =~ "<textarea>&lt;b&gt;not bold&lt;/b&gt;</textarea>"
+    refute content =~ "alert"
+    content = sanitized_html("<!-- x --!><p>shown</p><!-- hidden <p>no</p> -->")
+    assert content =~ "<p>shown</p>"
+    refute content =~ "hidden"
+    assert sanitized_html("&check; &colon;&NewLine;&notit; &amp &copy=1 &NotEqualTilde;") =~
+      "✓ :\n¬it; &amp; ©=1 ≂̸"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html sanitized while tokenized matches the parse tree" do
+    path = Path.expand("test/data/test.com/aaa/new/1444073250_1.24235.brumbrum,U=1098,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    {:ok, tree} = Gmimex.get_json(path, content: true)
+    {:ok, stream} = Gmimex.get_json(path, content: true, sanitizer_engine: :stream)
+    assert stream["html"] == tree["html"]
+    assert_raise MatchError, fn -> Gmimex.get_json(path, content: true, sanitizer_engine: :dom) end
+  end
+
+
+  test "json html nested beyond the max depth is flattened" do
+    html = String.duplicate("<div><font>", 5_000) <> "deep" <> String.duplicate("</font></div>", 5_000)
+    assert sanitized_html(html, sanitizer_engine: :tree) =~ "deep"
+    shallow = sanitized_html(html, max_depth: 8)
+    # html and body, then three of the div and font pairs
+    assert length(String.split(shallow, "<div")) == 4
+    assert shallow =~ "deep"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html past its limits is truncated at an element boundary" do
+    path = Path.expand("test/data/test.com/aaa/new/1444073250_1.24235.brumbrum,U=1098,FMD5=7e33429f656f1e6e9d79b29c3f82c57e")
+    {:ok, full} = Gmimex.get_json(path, content: true)
+    refute full["html"]["truncated"]
+    for limit <- [[max_html_bytes: 2_000], [max_html_nodes: 40], [max_html_output: 2_000]],
+        engine <- [:tree, :stream] do
+      {:ok, json} = Gmimex.get_json(path, [content: true, sanitizer_engine: engine] ++ limit)
+      assert json["truncated"]
+      assert json["html"]["truncated"]
+      assert json["html"]["size"] == full["html"]["size"]
+      assert String.length(json["html"]["content"]) < String.length(full["html"]["content"])
+      assert String.ends_with?(json["html"]["content"], "</body>\n</html>\n")
+    end
+  end
+
+
+  test "json html past its byte limit is cut at the end of a tag" do
+    # The cut falls right after "a>", which ends no tag within the textarea
+    content = sanitized_html("<p>one</p><textarea>a>b</textarea><p>two</p>", max_html_bytes: 23)
+    assert content =~ "<p>one</p>"
+    refute content =~ "a&gt;"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html moved out of tables counts towards the output limit" do
+    html = "<table>" <> String.duplicate("text<b>bold</b>", 20_000) <> "</table>"
+    json = sanitized_json(html, sanitizer_engine: :stream, max_html_output: 2_000)
+    assert json["truncated"]
+    assert byte_size(json["content"]) < 4_000
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html split around a block many times stays fast and within the output limit" do
+    formatting = Enum.map_join(1..10_000, &"<b id=#{&1}>")
+    html = formatting <> "<div>" <> String.duplicate("x", 3_000_000) <> String.duplicate("</b>", 10_000)
+    {time, json} = :timer.tc(fn -> sanitized_json(html, sanitizer_engine: :stream) end)
+    refute json["truncated"]
+    assert time < 1_500_000
+    html = formatting <> "<div>" <> String.duplicate("</b>", 10_000) <> String.duplicate("y<br>", 100_000)
+    json = sanitized_json(html, sanitizer_engine: :stream, max_html_output: 50_000)
+    assert json["truncated"]
+    assert byte_size(json["content"]) < 100_000
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html sanitized quotes attribute values which need it once decoded" do
+    html = "<div align=x&#32;onmouseover=alert(1) dir='a&quot;b'>text</div>"
+    assert sanitized_html(html) =~ "<div align=\"x onmouseover=alert(1)\" dir=\"a&quot;b\">text</div>"
+    assert sanitized_html(html, minify: true) =~ "<div align=\"x onmouseover=alert(1)\" dir=\"a&quot;b\">text</div>"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html style drops expression()" do
+    content = sanitized_html("<p style=\"color:red;width:expression(alert(1));height:EXPRESSION (alert(2))\">x</p>")
+    assert content =~ "<p style=\"color:red\">x</p>"
+    refute content =~ ~r/expression/i
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html style drops script urls" do
+    html = "<p style=\"color:red;background:url(javascript:alert(1));list-style:url('VBScript:alert(2)');" <>
+           "cursor:livescript:alert(3)\">x</p>"
+    content = sanitized_html(html)
+    assert content =~ "<p style=\"color:red\">x</p>"
+    refute content =~ ~r/script/i
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html style drops properties running code" do
+    html = "<p style=\"behavior:url(a.htc);-moz-binding:url(http://a/b.xml#x);-MS-Behavior:url(c.htc);color:blue\">x</p>"
+    assert sanitized_html(html) =~ "<p style=\"color:blue\">x</p>"
+    assert sanitized_html("<p style=\"behavior:url(a.htc)\">x</p>") =~ "<p>x</p>"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html style drops escapes and comments hiding keywords" do
+    html = "<p style=\"width:expr\\65ssion(alert(1));height:expr/**/ession(alert(2));" <>
+           "background:url(java\\73 cript:alert(3));color:red\">x</p>"
+    content = sanitized_html(html)
+    assert content =~ "<p style=\"color:red\">x</p>"
+    refute content =~ "alert"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html style keeps urls of permitted protocols only" do
+    html = "<p style=\"background:url(&quot;http://example.com/a.png&quot;);color:red\">x</p>" <>
+           "<p style=\"background:url(foo:bar);color:red\">y</p>" <>
+           "<p style=\"background:url(http://example.com/a b.png)\">z</p>"
+    content = sanitized_html(html)
+    assert content =~ "<p data-proxy-style=\"background:url(http://example.com/a.png);color:red\">x</p>"
+    assert content =~ "<p style=\"color:red\">y</p>"
+    assert content =~ "<p>z</p>"
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html style resolves cid urls of inline parts" do
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    File.write!(path, "From: test@test.com\r\nSubject: Inline\r\nContent-Type: multipart/related; boundary=\"b\"\r\n\r\n" <>
+                      "--b\r\nContent-Type: text/html\r\n\r\n" <>
+                      "<div style=\"background:url(cid:image)\">x</div><div style=\"background:url(cid:missing)\">y</div>\r\n" <>
+                      "--b\r\nContent-Type: image/png\r\nContent-ID: <image>\r\nContent-Transfer-Encoding: base64\r\n\r\ncG5n\r\n" <>
+                      "--b--\r\n")
+    for engine <- [nil, :stream] do
+      {:ok, json} = Gmimex.get_json(path, content: true, sanitizer_engine: engine)
+      assert json["html"]["content"] =~ "<div data-proxy-style=\"background:url(data:image/png;base64,cG5n)\">x</div>"
+      assert json["html"]["content"] =~ "background:url(data:image/gif;base64,"
+      {:ok, json} = Gmimex.get_json(path, content: true, sanitizer_engine: engine,
+                                    inline_url: "/messages/{key}/parts/{partId}", message_key: "inline")
+      assert json["html"]["content"] =~ "<div data-proxy-style=\"background:url(/messages/inline/parts/1)\">x</div>"
+    end
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
+  test "json html minified keeps its text and preformatted whitespace" do
+    path = Path.expand("test/data/test.com/aaa/cur/1443716368_2.10854.brumbrum,U=607,FMD5=7e33429f656f1e6e9d79b29c3f82c57e:2,S")
+    html = "<div  width=\"\"  align=\"center\">  one \n\n  two <img src=\"http://a/b.png\"></div><pre>  kept \n  as is </pre><textarea> and \n  here</textarea>"
+    File.write!(path, "From: test@test.com\r\nSubject: Minify\r\nContent-Type: text/html; charset=utf-8\r\n\r\n" <> html)
+    {:ok, json} = Gmimex.get_json(path, content: true)
+    {:ok, minified} = Gmimex.get_json(path, content: true, minify: true)
+    {:ok, stream} = Gmimex.get_json(path, content: true, minify: true, sanitizer_engine: :stream)
+    content = minified["html"]["content"]
+    assert String.length(content) < String.length(json["html"]["content"])
+    assert content =~ "<div align=center> one two <img data-proxy-src=http://a/b.png></div>"
+    assert content =~ "<pre>  kept \n  as is </pre>"
+    assert content =~ "<textarea> and \n  here</textarea>"
+    assert stream["html"] == minified["html"]
+    GmimexTest.Helpers.restore_from_backup
+  end
+
+
   test "read folder and count the number of emails" do
     path = Path.expand(Path.expand("test/data/test.com/aaa"))
     sorted_emails = Gmimex.read_folder(path)